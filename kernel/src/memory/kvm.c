@@ -4,7 +4,6 @@
 #include <string.h>
 
 static PDE kpdir[NR_PDE] align_to_page;						// kernel page directory
-static PTE kptable[PHY_MEM / PAGE_SIZE] align_to_page;		// kernel page tables
 
 PDE* get_kpdir() { return kpdir; }
 
@@ -12,48 +11,25 @@ PDE* get_kpdir() { return kpdir; }
 void init_page(void) {
 	CR0 cr0;
 	CR3 cr3;
+	CR4 cr4;
 	PDE *pdir = (PDE *)va_to_pa(kpdir);
-	PTE *ptable = (PTE *)va_to_pa(kptable);
 	uint32_t pdir_idx;
 
 	/* make all PDEs invalid */
 	memset(pdir, 0, NR_PDE * sizeof(PDE));
 
-	/* fill PDEs */
+	/* Map physical memory with 4MB pages, so that no page tables are
+	 * needed and the whole mapping takes few TLB entries.
+	 */
 	for (pdir_idx = 0; pdir_idx < PHY_MEM / PT_SIZE; pdir_idx ++) {
-		pdir[pdir_idx].val = make_pde(ptable);
-		pdir[pdir_idx + KOFFSET / PT_SIZE].val = make_pde(ptable);
-
-		ptable += NR_PTE;
+		pdir[pdir_idx].val = make_large_pde(pdir_idx * PT_SIZE);
+		pdir[pdir_idx + KOFFSET / PT_SIZE].val = make_large_pde(pdir_idx * PT_SIZE);
 	}
 
-	/* fill PTEs */
-
-	/* We use inline assembly here to fill PTEs for efficiency.
-	 * If you do not understand it, refer to the C code below.
-	 */
-
-	asm volatile ("std;\
-	 1: stosl;\
-		subl %0, %%eax;\
-		jge 1b;\
-		cld" : :
-		"i"(PAGE_SIZE), "a"((PHY_MEM - PAGE_SIZE) | 0x7), "D"(ptable - 1));
-
-
-	/*
-		===== referenced code for the inline assembly above =====
-
-		uint32_t pframe_addr = PHY_MEM - PAGE_SIZE;
-		ptable --;
-
-		// fill PTEs reversely
-		for (; pframe_addr >= 0; pframe_addr -= PAGE_SIZE) {
-			ptable->val = make_pte(pframe_addr);
-			ptable --;
-		}
-	*/
-
+	/* enable 4MB pages */
+	cr4.val = read_cr4();
+	cr4.page_size_ext = 1;
+	write_cr4(cr4.val);
 
 	/* make CR3 to be the entry of page directory */
 	cr3.val = 0;
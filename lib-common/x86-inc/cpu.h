@@ -34,4 +34,20 @@ typedef union CR3 {
 	uint32_t val;
 } CR3;
 
+/* the Control Register 4 */
+typedef union CR4 {
+	struct {
+		uint32_t virtual_8086_ext    : 1;
+		uint32_t protected_virtual   : 1;
+		uint32_t time_stamp_disable  : 1;
+		uint32_t debug_ext           : 1;
+		uint32_t page_size_ext       : 1;
+		uint32_t phys_addr_ext       : 1;
+		uint32_t machine_check       : 1;
+		uint32_t page_global_enable  : 1;
+		uint32_t pad0                : 24;
+	};
+	uint32_t val;
+} CR4;
+
 #endif
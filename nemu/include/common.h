@@ -6,8 +6,11 @@
 /* You will define this macro in PA4 */
 //#define HAS_DEVICE
 
+/* `make NEMU_MODE=release' builds without instruction tracing */
+#ifndef NEMU_RELEASE
 #define DEBUG
 #define LOG_FILE
+#endif
 
 #include "debug.h"
 #include "macro.h"
@@ -0,0 +1,41 @@
+#ifndef __BLOCK_H__
+#define __BLOCK_H__
+
+#include "common.h"
+#include "cpu/decode/decode-cache.h"
+
+/* A translated block is a run of straight-line guest instructions, kept
+ * as pre-decoded handler calls. Blocks are recorded while the interpreter
+ * executes, end at the first control transfer or uncacheable instruction,
+ * and remember their most recent successors so that hot loops can run
+ * from block to block without a table lookup.
+ */
+
+#define TB_BIT 9
+#define TB_NUM (1 << TB_BIT)
+#define TB_MAX_INSTR 32
+#define TB_NR_SUCC 2
+
+typedef struct TB {
+	swaddr_t eip;
+	uint32_t gen;
+	int nr_instr;
+	struct TB *succ[TB_NR_SUCC];
+
+	/* compiled code, see cpu/jit.h */
+	uint32_t exec_count;
+	bool jit_failed;
+	uint32_t jit_epoch;
+	void *jit_code;
+	void *jit_body;
+
+	DC_entry instr[TB_MAX_INSTR];
+} TB;
+
+void init_block();
+
+uint32_t block_exec(uint32_t, void (*) (swaddr_t, int));
+uint32_t block_abort();
+void block_record(swaddr_t, int);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef __DECODE_CACHE_H__
+#define __DECODE_CACHE_H__
+
+#include "common.h"
+#include "cpu/decode/operand.h"
+
+/* A direct-mapped cache of decoded instructions, keyed by guest EIP.
+ * An entry remembers the execute function chosen by the opcode table,
+ * the instruction length and the operands produced by the decoder, so
+ * that a hit can skip instruction fetch and decode entirely. Operand
+ * values are re-read from registers and memory before each replay.
+ */
+
+#define DECODE_CACHE_BIT 12
+#define DECODE_CACHE_SIZE (1 << DECODE_CACHE_BIT)
+
+/* An instruction is at most 15 bytes long. */
+#define INSTR_MAX_LEN 16
+
+/* The bytes of the instruction being decoded at `eip', kept by
+ * instr_fetch() as the decoder reads them, so that the trace does not
+ * fetch them again through the MMU and the caches.
+ */
+typedef struct {
+	swaddr_t eip;
+	uint8_t bytes[INSTR_MAX_LEN];
+} Instr_bytes;
+
+extern Instr_bytes instr_bytes;
+
+typedef struct {
+	swaddr_t eip;
+	uint32_t gen;
+	int len;
+	void (*execute) (Operands *);
+	/* address recipe of the ModR/M memory operand */
+	int8_t base_reg, index_reg;
+	uint8_t scale;
+	int32_t disp;
+	Operands ops;
+	uint8_t bytes[INSTR_MAX_LEN];
+#ifdef DEBUG
+	char text[NR_OP][OP_STR_SIZE];
+#endif
+} DC_entry;
+
+void init_decode_cache();
+void flush_decode_cache();
+
+uint32_t decode_cache_generation();
+const bool* decode_cache_code_page();
+DC_entry* decode_cache_lookup(swaddr_t);
+int decode_cache_replay(DC_entry *);
+int decode_cache_exec(swaddr_t);
+const uint8_t* decode_cache_bytes();
+void decode_cache_record(Operands *, void (*) (Operands *));
+void decode_cache_note_addr(int, int, int, int32_t);
+void decode_cache_forbid();
+void decode_cache_check_write(hwaddr_t, size_t);
+
+#endif
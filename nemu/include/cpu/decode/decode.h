@@ -29,6 +29,8 @@ make_helper(decode_si2rm_w);
 make_helper(decode_si2rm_l);
 make_helper(decode_si_rm2r_w);
 make_helper(decode_si_rm2r_l);
+make_helper(decode_cl_rm2r_w);
+make_helper(decode_cl_rm2r_l);
 make_helper(decode_i_rm2r_w);
 make_helper(decode_i_rm2r_l);
 make_helper(decode_r2rm_b);
@@ -28,8 +28,23 @@ typedef union {
 	uint8_t val;
 } SIB;
 
-int load_addr(swaddr_t, ModR_M *, Operand *);
-int read_ModR_M(swaddr_t, Operand *, Operand *);
+/* The ModR/M byte of the instruction being decoded with the SIB byte
+ * and displacement which follow it, parsed once by parse_ModR_M().
+ */
+typedef struct {
+	swaddr_t eip;		/* of the ModR/M byte, 0 if none is parsed */
+	ModR_M m;
+	int base_reg, index_reg, scale;
+	int32_t disp;
+	int disp_size;
+	int len;			/* of the ModR/M byte, SIB byte and displacement */
+} ModR_M_format;
+
+extern ModR_M_format modrm_format;
+
+int parse_ModR_M(swaddr_t);
+int load_addr(swaddr_t, ModR_M *, Operands *, Operand *);
+int read_ModR_M(swaddr_t, Operands *, Operand *, Operand *);
 
 #define MODRM_ASM_BUF_SIZE 32
 extern char ModR_M_asm[];
@@ -6,8 +6,8 @@ enum { OP_TYPE_REG, OP_TYPE_MEM, OP_TYPE_IMM };
 #define OP_STR_SIZE 40
 
 typedef struct {
-	uint32_t type;
-	size_t size;
+	uint8_t type;
+	uint8_t size;
 	union {
 		uint32_t reg;
 		swaddr_t addr;
@@ -15,13 +15,32 @@ typedef struct {
 		int32_t simm;
 	};
 	uint32_t val;
-	char str[OP_STR_SIZE];
 } Operand;
 
+enum { OP_SRC, OP_DEST, OP_SRC2, NR_OP };
+
+/* A decoded instruction. The decoder fills it in, and the executor
+ * gets it as an argument, so it can be kept and executed again.
+ */
 typedef struct {
-	uint32_t opcode;
+	uint16_t opcode;
+	/* the reg field of ModR/M, for the opcodes of a group */
+	uint8_t group_idx;
 	bool is_operand_size_16;
-	Operand src, dest, src2;
+	union {
+		struct { Operand src, dest, src2; };
+		Operand op[NR_OP];
+	};
 } Operands;
 
+#ifdef DEBUG
+/* The text of the operands of the instruction being decoded, kept out
+ * of `Operands' since only the debug log prints it.
+ */
+extern char operand_text[NR_OP][OP_STR_SIZE];
+#endif
+
+/* the text of the operand `x' of `ops' */
+#define OP_STR(x) (operand_text[(x) - ops->op])
+
 #endif
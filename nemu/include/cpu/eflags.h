@@ -2,7 +2,42 @@
 #define __EFLAGS_H__
 
 #include "common.h"
+#include "cpu/reg.h"
 
-void update_eflags_pf_zf_sf(uint32_t);
+/* CF, PF, AF, ZF, SF and OF are evaluated lazily. A flag-setting instruction
+ * only records its operation, operand size, operands and result in
+ * `cpu.lf'. The flags are computed from them when an instruction or the
+ * monitor reads them. While `cpu.lf.op' is LF_NONE, `cpu.eflags' holds
+ * the flags themselves.
+ */
+
+enum { LF_NONE, LF_ADD, LF_ADC, LF_SUB, LF_SBB, LF_LOGIC, LF_INC, LF_DEC, LF_SHL, LF_SHR, LF_SAR, LF_MUL };
+
+uint32_t eflags_CF();
+uint32_t eflags_PF();
+uint32_t eflags_AF();
+uint32_t eflags_ZF();
+uint32_t eflags_SF();
+uint32_t eflags_OF();
+
+/* Whether the condition `cc' of jcc, setcc and cmovcc, the low 4 bits
+ * of their opcodes, holds.
+ */
+bool eflags_cond(int cc);
+
+/* Write the lazy flags back to `cpu.eflags'. */
+void eflags_sync();
+
+static inline void set_lazy_flags(int op, int size, uint32_t dest, uint32_t src, uint32_t result) {
+	if((op == LF_INC || op == LF_DEC) && cpu.lf.op != LF_NONE) {
+		/* inc and dec leave CF alone */
+		cpu.eflags.CF = eflags_CF();
+	}
+	cpu.lf.op = op;
+	cpu.lf.size = size;
+	cpu.lf.dest = dest;
+	cpu.lf.src = src;
+	cpu.lf.result = result;
+}
 
 #endif
@@ -6,14 +6,14 @@
 
 #define make_helper_v(name) \
 	make_helper(concat(name, _v)) { \
-		return (ops_decoded.is_operand_size_16 ? concat(name, _w) : concat(name, _l)) (eip); \
+		return (ops->is_operand_size_16 ? concat(name, _w) : concat(name, _l)) (eip, ops); \
 	}
 
 #define do_execute concat4(do_, instr, _, SUFFIX)
 
 #define make_instr_helper(type) \
 	make_helper(concat5(instr, _, type, _, SUFFIX)) { \
-		return idex(eip, concat4(decode_, type, _, SUFFIX), do_execute); \
+		return idex(eip, ops, concat4(decode_, type, _, SUFFIX), do_execute); \
 	}
 
 extern char assembly[];
@@ -24,12 +24,12 @@ extern char assembly[];
 #endif
 
 #define print_asm_template1() \
-	print_asm(str(instr) str(SUFFIX) " %s", op_src->str)
+	print_asm(str(instr) str(SUFFIX) " %s", OP_STR(op_src))
 
 #define print_asm_template2() \
-	print_asm(str(instr) str(SUFFIX) " %s,%s", op_src->str, op_dest->str)
+	print_asm(str(instr) str(SUFFIX) " %s,%s", OP_STR(op_src), OP_STR(op_dest))
 
 #define print_asm_template3() \
-	print_asm(str(instr) str(SUFFIX) " %s,%s,%s", op_src->str, op_src2->str, op_dest->str)
+	print_asm(str(instr) str(SUFFIX) " %s,%s,%s", OP_STR(op_src), OP_STR(op_src2), OP_STR(op_dest))
 
 #endif
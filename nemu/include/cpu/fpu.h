@@ -0,0 +1,63 @@
+#ifndef __FPU_H__
+#define __FPU_H__
+
+#include "common.h"
+#include "cpu/reg.h"
+
+/* The x87 FPU. The registers are host `long double's, which are the same
+ * 80-bit format on an x86 host, and the arithmetic runs on the host FPU
+ * under the control word of the guest. See cpu/fpu.c.
+ */
+
+/* status word */
+#define FPU_IE 0x0001	/* invalid operation */
+#define FPU_DE 0x0002	/* denormal operand */
+#define FPU_ZE 0x0004	/* divide by zero */
+#define FPU_OE 0x0008	/* overflow */
+#define FPU_UE 0x0010	/* underflow */
+#define FPU_PE 0x0020	/* precision */
+#define FPU_SF 0x0040	/* stack fault */
+#define FPU_ES 0x0080	/* an unmasked exception is pending */
+#define FPU_C0 0x0100
+#define FPU_C1 0x0200
+#define FPU_C2 0x0400
+#define FPU_C3 0x4000
+#define FPU_B  0x8000
+#define FPU_CC (FPU_C0 | FPU_C1 | FPU_C2 | FPU_C3)
+#define FPU_EXCEPTIONS 0x3f
+
+#define FPU_TAG_EMPTY 3
+
+/* the physical register which is ST(i) */
+#define fpu_phys(i) ((cpu.fpu.top + (i)) & 0x7)
+#define fpu_empty(i) (((cpu.fpu.tw >> (fpu_phys(i) * 2)) & 0x3) == FPU_TAG_EMPTY)
+
+static inline void fpu_set_tag(int i, int tag) {
+  int shift = fpu_phys(i) * 2;
+  cpu.fpu.tw = (cpu.fpu.tw & ~(0x3 << shift)) | (tag << shift);
+}
+
+/* the status word with TOP and the summary bits */
+static inline uint16_t fpu_status() {
+  uint16_t sw = cpu.fpu.sw & ~(FPU_ES | FPU_B | 0x3800);
+  if(sw & ~cpu.fpu.cw & FPU_EXCEPTIONS) { sw |= FPU_ES | FPU_B; }
+  return sw | (cpu.fpu.top << 11);
+}
+
+/* Run the host FPU under the control word of the guest, and add the
+ * exceptions it raises until fpu_host_end() to the status word.
+ */
+void fpu_host_begin();
+void fpu_host_end();
+
+/* convert between a register and the 80-bit memory format */
+long double fpu_load80(const uint8_t *);
+void fpu_store80(uint8_t *, long double);
+
+/* the tag word as fnstenv stores it, with the class of every register */
+uint16_t fpu_tag_word();
+
+void fpu_init();
+void info_fpu();
+
+#endif
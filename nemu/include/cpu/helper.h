@@ -4,28 +4,40 @@
 #include "nemu.h"
 #include "cpu/decode/operand.h"
 #include "cpu/eflags.h" 
+#include "cpu/decode/decode-cache.h"
 
-/* All function defined with 'make_helper' return the length of the operation. */
-#define make_helper(name) int name(swaddr_t eip)
+/* All function defined with 'make_helper' return the length of the operation.
+ * `ops' is the decoded instruction they fill in.
+ */
+#define make_helper(name) int name(swaddr_t eip, Operands *ops)
 
+/* Bytes inside the instruction window are read in place; the others,
+ * such as the tail of an instruction which crosses a page, are fetched
+ * through the MMU. Either way they are copied into `instr_bytes'.
+ */
 static inline uint32_t instr_fetch(swaddr_t addr, size_t len) {
-	return swaddr_read(addr, len);
+	uint32_t val;
+	uint32_t off = addr - instr_window.eip;
+	if(off < instr_window.len && len <= instr_window.len - off) { val = host_read((void *)(instr_window.host + off), len); }
+	else { val = swaddr_fetch(addr, len); }
+
+	off = addr - instr_bytes.eip;
+	if(off < INSTR_MAX_LEN && len <= INSTR_MAX_LEN - off) { memcpy(instr_bytes.bytes + off, &val, len); }
+	return val;
 }
 
 /* Instruction Decode and Execute */
-static inline int idex(swaddr_t eip, int (*decode)(swaddr_t), void (*execute) (void)) {
+static inline int idex(swaddr_t eip, Operands *ops, int (*decode)(swaddr_t, Operands *), void (*execute) (Operands *)) {
 	/* eip is pointing to the opcode */
-	int len = decode(eip + 1);
-	execute();
+	int len = decode(eip + 1, ops);
+	decode_cache_record(ops, execute);
+	execute(ops);
 	return len + 1;	// "1" for opcode
 }
 
-/* shared by all helper function */
-extern Operands ops_decoded;
-
-#define op_src (&ops_decoded.src)
-#define op_src2 (&ops_decoded.src2)
-#define op_dest (&ops_decoded.dest)
+#define op_src (&ops->src)
+#define op_src2 (&ops->src2)
+#define op_dest (&ops->dest)
 
 
 #endif
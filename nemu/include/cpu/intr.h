@@ -0,0 +1,19 @@
+#ifndef __INTR_H__
+#define __INTR_H__
+
+#include "common.h"
+
+/* Enter the handler of interrupt or exception `NO' through the IDT. The
+ * handler returns to `cpu.eip', so an instruction which raises a trap
+ * such as `int' moves it past itself first. It does not return, but
+ * goes back to cpu_exec() like a page fault.
+ */
+void raise_intr(uint8_t NO);
+
+/* The same for an exception which pushes an error code, such as #PF. A
+ * fault leaves the state as it was before the faulting instruction, so
+ * that the handler can return to it.
+ */
+void raise_intr_error(uint8_t NO, uint32_t error_code);
+
+#endif
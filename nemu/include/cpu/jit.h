@@ -0,0 +1,30 @@
+#ifndef __JIT_H__
+#define __JIT_H__
+
+#include "common.h"
+#include "cpu/block.h"
+
+/* Translated blocks which have run JIT_THRESHOLD times are compiled into
+ * x86-64 code. Guest GPRs live in host registers inside the generated
+ * code, and guest EFLAGS are kept in the host flags until a helper call,
+ * a branch or the block exit needs them in `cpu.eflags'. Instructions
+ * the code generator does not know are executed by calling back into
+ * the decode cache. Once a block has left for another compiled block,
+ * that exit jumps to it directly; chained blocks return to cpu_exec()
+ * after at most JIT_CHAIN_MAX instructions.
+ */
+
+#define JIT_THRESHOLD 16
+#define JIT_CODE_SIZE (16 * 1024 * 1024)
+#define JIT_CHAIN_MAX 65536
+
+typedef int (*jit_fun)(void);
+
+void init_jit();
+bool jit_compile(TB *);
+uint32_t jit_exec(TB *, uint32_t);
+uint32_t jit_abort();
+
+extern bool jit_check;
+
+#endif
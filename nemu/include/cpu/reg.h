@@ -24,6 +24,18 @@ typedef struct {
   uint32_t limit, base;
 } Segment_Reg;
 
+/* the x87 FPU, see cpu/fpu.h */
+typedef struct {
+  long double st[8];  /* ST(i) is st[(top + i) & 7] */
+  uint16_t cw;
+  uint16_t sw;        /* without TOP, ES and B */
+  uint16_t tw;        /* only tells the empty registers */
+  uint8_t top;
+  /* the last non-control instruction, for fnstenv */
+  uint16_t fop;
+  uint32_t fip, fdp;
+} FPU_state;
+
 typedef struct {
   union {
     union {
@@ -65,11 +77,22 @@ typedef struct {
     uint32_t val;
   } eflags;
 
+  /* the last flag-setting operation, see cpu/eflags.h */
+  struct {
+    uint32_t op, size;
+    uint32_t dest, src, result;
+  } lf;
+
   struct GDTR {
     uint32_t base;
     uint16_t limit;
   } gdtr;
 
+  struct IDTR {
+    uint32_t base;
+    uint16_t limit;
+  } idtr;
+
   CR0 cr0;
 
   union {
@@ -82,6 +105,14 @@ typedef struct {
   };
 
   CR3 cr3;
+  /* the linear address of the last page fault */
+  uint32_t cr2;
+  CR4 cr4;
+
+  /* an external interrupt is pending, see device/i8259.c */
+  bool INTR;
+
+  FPU_state fpu;
 } CPU_state;
 
 typedef struct{
@@ -113,10 +144,12 @@ typedef struct{
 
 Sreg_Descriptor *sreg_desc;
 
+/* Load the hidden part of a segment register from its selector. */
 void sreg_load(uint8_t);
 
 extern CPU_state cpu;
 
+/* the segment of data accesses, DS unless a prefix overrides it */
 uint8_t current_sreg;
 
 typedef struct{
@@ -128,7 +161,8 @@ typedef struct{
       uint32_t       :2;
       uint32_t a     :1;
       uint32_t d     :1;
-      uint32_t       :2;
+      uint32_t ps    :1;
+      uint32_t g     :1;
       uint32_t avail :3;
       uint32_t addr  :20;
     };
@@ -7,6 +7,7 @@ typedef void(*mmio_callback_t)(hwaddr_t, size_t, bool);
 
 void* add_mmio_map(hwaddr_t, size_t, mmio_callback_t);
 int is_mmio(hwaddr_t);
+bool is_mmio_page(hwaddr_t);
 
 uint32_t mmio_read(hwaddr_t, size_t, int);
 void mmio_write(hwaddr_t, size_t, uint32_t, int);
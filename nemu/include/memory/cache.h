@@ -2,51 +2,56 @@
 #define __CACHE_H__
 
 #include "common.h"
-
-#define CACHE_BLOCK_BIT 6
-#define CACHE_L1_WAY_BIT 3
-#define CACHE_L1_SET_BIT 7
-#define CACHE_L2_WAY_BIT 4
-#define CACHE_L2_SET_BIT 12
-#define CACHE_L2_CAP (4 * 1024 * 1024)
-#define CACHE_L1_CAP (64 * 1024)
-
-#define CACHE_BLOCK_SIZE (1 << CACHE_BLOCK_BIT)
-#define CACHE_L1_WAY_NUM (1 << CACHE_L1_WAY_BIT)
-#define CACHE_L1_SET_NUM (1 << CACHE_L1_SET_BIT)
-
-#define CACHE_L2_WAY_NUM (1 << CACHE_L2_WAY_BIT)
-#define CACHE_L2_SET_NUM (1 << CACHE_L2_SET_BIT)
-
-typedef struct{
-    uint8_t data[CACHE_BLOCK_SIZE];
-    uint32_t tag;
-    bool validVal;
-} L1;
-
-L1 cache_L1[CACHE_L1_SET_NUM * CACHE_L1_WAY_NUM];
-
-void init_cache();
-
-int read_cache_L1(hwaddr_t);
-
-void write_cache_L1(hwaddr_t, size_t, uint32_t);
-
-
-typedef struct{
-    uint8_t data[CACHE_BLOCK_SIZE];
-    uint32_t tag;
-    bool validVal;
-    bool dirtyVal;
-} L2;
-
-L2 cache_L2[CACHE_L2_SET_NUM * CACHE_L2_WAY_NUM];
-
+#include "memory/replace.h"
+
+/* Two levels of cache, described at runtime by `--cache=LEVEL:KEY=VAL,...'
+ * with LEVEL l1 or l2 and the keys size, ways, line, write (wb or wt)
+ * and repl. Both levels use the same line size.
+ *
+ * Stores allocate in L1. A write-back level marks the line dirty; a
+ * write-through level also writes the bytes into the next level if it
+ * holds the line, or to DRAM. L2 either includes every line of L1 or,
+ * when exclusive, only holds lines evicted from L1, selected with `--l2'.
+ */
+
+enum { LEVEL_L1, LEVEL_L2, NR_CACHE_LEVEL };
+enum { CACHE_WB, CACHE_WT };
+enum { CACHE_INCLUSIVE, CACHE_EXCLUSIVE };
+
+extern int cache_L2_mode;
+
+typedef struct {
+  uint32_t size, nr_way, line_size;
+  int write;
+} Cache_config;
+
+extern Cache_config cache_config[NR_CACHE_LEVEL];
+
+/* no address has this tag, since a line holds at least a DRAM burst */
+#define CACHE_TAG_INVALID 0xffffffffu
+
+/* A level lives in one cache-line-aligned arena: the data of all lines,
+ * then the tags and then the dirty flags, each indexed by
+ * `set * nr_way + way'. A lookup only scans the tags of a set.
+ */
+typedef struct {
+  int level;
+  uint32_t nr_set, nr_way, line_size;
+  int way_bit, set_bit, line_bit;
+  int write;
+  uint8_t *data;
+  uint32_t *tag;
+  uint8_t *dirty;
+  void *arena;
+  Repl repl;
+} Cache;
+
+extern Cache caches[NR_CACHE_LEVEL];
+
+bool cache_parse(const char *);
 void init_cache();
+void flush_cache();
 
-int read_cache_L1(hwaddr_t);
-int read_cache_L2(hwaddr_t);
-
-void write_cache_L1(hwaddr_t, size_t, uint32_t);
-void write_cache_L2(hwaddr_t, size_t, uint32_t);
+uint32_t read_cache(hwaddr_t, size_t);
+void write_cache(hwaddr_t, size_t, uint32_t);
 #endif
@@ -0,0 +1,30 @@
+#ifndef __DIRTY_H__
+#define __DIRTY_H__
+
+#include "common.h"
+
+/* One bit per page of guest physical memory, set when the page is
+ * written. hwaddr_write(), the DRAM model, DMA and program loading mark
+ * the pages they store to. A soft-TLB entry which allows writes marks
+ * its page when it is filled, so its stores need no marking, and
+ * collecting the set drops such entries.
+ */
+
+extern uint64_t *dirty_bitmap;
+
+void init_dirty();
+uint32_t dirty_collect(const uint32_t **);
+
+static inline void dirty_mark_page(uint32_t page) {
+	dirty_bitmap[page >> 6] |= 1ull << (page & 63);
+}
+
+/* mark the pages of `len' bytes at `addr' */
+static inline void dirty_mark(hwaddr_t addr, size_t len) {
+	uint32_t page;
+	for(page = addr >> 12; page <= (addr + len - 1) >> 12; page ++) {
+		dirty_mark_page(page);
+	}
+}
+
+#endif
@@ -3,9 +3,18 @@
 
 #include "common.h"
 
-#define HW_MEM_SIZE (128 * 1024 * 1024)
+/* Guest physical memory is `hw_mem_size' bytes at `hw_mem', see
+ * init_hw_mem(). The size is set with `--mem-size' and is fixed for
+ * the whole run.
+ */
+#define HW_MEM_SIZE hw_mem_size
+#define HW_MEM_SIZE_MAX 0xc0000000u
 
 extern uint8_t *hw_mem;
+extern uint32_t hw_mem_size;
+extern char *hw_mem_file;
+
+void init_hw_mem();
 
 /* convert the hardware address in the test program to virtual address in NEMU */
 #define hwa_to_va(p) ((void *)(hw_mem + (unsigned)p))
@@ -17,6 +26,76 @@ extern uint8_t *hw_mem;
 	hwa_to_va(addr); \
 })
 
+/* Load or store 1, 2 or 4 bytes through a host pointer. The host is
+ * little-endian and allows unaligned accesses, like the guest.
+ */
+static inline uint32_t host_read(void *p, size_t len) {
+  switch (len) {
+    case 1: return *(uint8_t *)p;
+    case 2: return *(uint16_t *)p;
+    default: return *(uint32_t *)p;
+  }
+}
+
+static inline void host_write(void *p, size_t len, uint32_t data) {
+  switch (len) {
+    case 1: *(uint8_t *)p = data; break;
+    case 2: *(uint16_t *)p = data; break;
+    default: *(uint32_t *)p = data; break;
+  }
+}
+
+/* How physical memory is modeled. MEM_FAST loads and stores `hw_mem'
+ * directly. MEM_CACHE routes every physical access through the L1/L2
+ * cache and DRAM row-buffer models, for timing studies. It is chosen
+ * with `--mem' and fixed for the whole run.
+ */
+enum { MEM_FAST, MEM_CACHE };
+extern int mem_model;
+
+/* The soft-TLB caches linear-to-host translations of whole pages, with
+ * separate tags for reads, writes and instruction fetches. It has to be
+ * flushed whenever CR0 or CR3 changes and when MMIO space is mapped.
+ */
+#define SOFT_TLB_BIT 8
+#define SOFT_TLB_SIZE (1 << SOFT_TLB_BIT)
+
+/* A tag is the linear address of a page, so that an access which stays
+ * inside the page hits with one compare of the address of its last byte.
+ * `addend' turns a linear address into a host pointer. An entry holds a
+ * single page, which is also in the TLB model when paging is on. The JIT
+ * inlines the hit path, see cpu/jit.c.
+ */
+typedef struct {
+  lnaddr_t tag_read, tag_write, tag_fetch;
+  lnaddr_t page;
+  uintptr_t addend;
+  /* the entry of the page in the TLB model, -1 without paging */
+  int tlb_index;
+} Soft_TLB;
+
+extern Soft_TLB soft_tlb[SOFT_TLB_SIZE];
+
+void soft_tlb_flush();
+void soft_tlb_invalidate(lnaddr_t);
+
+/* Up to 16 bytes of code starting at `eip', read in place from the host
+ * page, so that decoding an instruction translates its address once.
+ * It never crosses a page; `len' is 0 when there is no window, as with
+ * the cache model or code outside RAM. See instr_fetch().
+ */
+#define INSTR_WINDOW_SIZE 16
+
+typedef struct {
+  swaddr_t eip;
+  uint32_t len;
+  const uint8_t *host;
+} Instr_window;
+
+extern Instr_window instr_window;
+
+void instr_window_fetch(swaddr_t);
+uint32_t swaddr_fetch(swaddr_t, size_t);
 uint32_t swaddr_read(swaddr_t, size_t);
 uint32_t lnaddr_read(lnaddr_t, size_t);
 uint32_t hwaddr_read(hwaddr_t, size_t);
@@ -24,4 +103,11 @@ void swaddr_write(swaddr_t, size_t, uint32_t);
 void lnaddr_write(lnaddr_t, size_t, uint32_t);
 void hwaddr_write(hwaddr_t, size_t, uint32_t);
 
+/* A host pointer to `len' bytes of RAM at `addr', which must not cross
+ * a page, for the bulk accesses of string instructions. It is NULL with
+ * the cache model and for MMIO pages, which are accessed one element
+ * at a time.
+ */
+void* swaddr_host(swaddr_t, size_t, bool);
+
 #endif
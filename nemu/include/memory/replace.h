@@ -0,0 +1,62 @@
+#ifndef __REPLACE_H__
+#define __REPLACE_H__
+
+#include "common.h"
+#include "monitor/checkpoint.h"
+
+/* Replacement policies for the set-associative structures of the memory
+ * model. Each structure owns a `Repl' which keeps the per-set state of
+ * its policy. The caller reports hits with repl_touch() and fills with
+ * repl_fill(), and asks repl_victim() for a way when a set is full.
+ * The random policy is a xorshift generator seeded with `repl_seed', so
+ * runs are repeatable.
+ */
+
+enum { REPL_PLRU, REPL_LRU, REPL_SRRIP, REPL_RANDOM, NR_REPL_POLICY };
+
+/* the structures whose policy can be chosen with `--repl' */
+enum { REPL_L1, REPL_L2, REPL_TLB, NR_REPL_STRUCT };
+
+#define SRRIP_MAX 3
+
+typedef struct {
+	int policy;
+	int nr_set, nr_way, way_bit;
+	/* PLRU: tree bits in the first word of the set;
+	 * LRU: time of last use of each way, which is 64 bits wide so that
+	 * the clock does not wrap; SRRIP: RRPV of each way */
+	uint64_t *state;
+	uint64_t clock;
+	uint64_t rand;
+} Repl;
+
+extern int repl_policy[NR_REPL_STRUCT];
+extern uint64_t repl_seed;
+extern const char *repl_name[NR_REPL_POLICY];
+
+void repl_init(Repl *, int policy, int nr_set, int nr_way);
+int repl_victim(Repl *, int set);
+void repl_fill(Repl *, int set, int way);
+bool repl_parse(const char *);
+void repl_ckpt(Ckpt *, Repl *);
+
+static inline void repl_touch(Repl *r, int set, int way) {
+	uint64_t *s = r->state + set * r->nr_way;
+	int node, l;
+	switch(r->policy) {
+		case REPL_PLRU:
+			for(node = 1, l = r->way_bit - 1; l >= 0; l --) {
+				int bit = (way >> l) & 1;
+				/* point the node to the other half */
+				if(bit) { s[0] &= ~(1ull << node); }
+				else { s[0] |= 1ull << node; }
+				node = (node << 1) | bit;
+			}
+			break;
+		case REPL_LRU: s[way] = ++ r->clock; break;
+		case REPL_SRRIP: s[way] = 0; break;
+		default: break;
+	}
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include "common.h"
+#include "monitor/timing.h"
+
+/* Statistics of the cache and TLB models, split by instruction fetch
+ * and data access. Every miss is also attributed to `cpu.eip', and
+ * through the symbol table to a guest function. `info cache' prints
+ * them; with `--stats=FILE' they are written to FILE at exit.
+ * Accesses made while `timing_mute' is set are not counted.
+ */
+
+enum { S_L1, S_L2, S_TLB, NR_S_LEVEL };
+enum { ACC_DATA, ACC_FETCH, NR_ACC };
+
+typedef struct {
+	uint64_t hit, miss, evict, writeback;
+} Mem_stat;
+
+extern Mem_stat mem_stat[NR_S_LEVEL][NR_ACC];
+/* the kind of the memory access in progress */
+extern int access_kind;
+extern const char *stats_file;
+
+static inline void stat_hit(int level) {
+	if(timing_mute == 0) { mem_stat[level][access_kind].hit ++; }
+}
+
+static inline void stat_evict(int level, bool dirty) {
+	if(timing_mute == 0) {
+		mem_stat[level][access_kind].evict ++;
+		if(dirty) { mem_stat[level][access_kind].writeback ++; }
+	}
+}
+
+void stat_miss(int level);
+
+void init_stats();
+void info_cache();
+
+#endif
@@ -3,17 +3,57 @@
 
 #include "common.h"
 
-#define TLB_SIZE 64
+/* A set-associative TLB indexed by the low bits of the linear page
+ * number, with the replacement policy chosen by `--repl=tlb=...'.
+ * Entries for global pages survive tlb_flush_nonglobal() while CR4.PGE
+ * is set, which is what a CR3 write does. 4MB pages have a small fully
+ * associative TLB of their own, whose entries follow the 4KB ones in
+ * `tlb'.
+ */
+
+#define TLB_WAY_BIT 2
+#define TLB_SET_BIT 6
+#define TLB_WAY_NUM (1 << TLB_WAY_BIT)
+#define TLB_SET_NUM (1 << TLB_SET_BIT)
+#define TLB_SIZE (TLB_WAY_NUM * TLB_SET_NUM)
+#define TLB_LARGE_NUM 8
 
 typedef struct{
     bool valid_value;
+    bool global;
+    /* a write through the entry needs no walk to set the dirty bit */
+    bool dirty;
+    /* the tag is bits 31..22 of the address for 4MB pages */
     uint32_t tag, page_num;
 } TLB;
 
-TLB tlb[TLB_SIZE];
+TLB tlb[TLB_SIZE + TLB_LARGE_NUM];
+
+static inline bool tlb_is_large(int index) {
+  return index >= TLB_SIZE;
+}
+
+static inline uint32_t tlb_translate(int index, uint32_t lnaddr) {
+  uint32_t offset_mask = (tlb_is_large(index) ? 0x3fffff : 0xfff);
+  return (tlb[index].page_num << 12) | (lnaddr & offset_mask);
+}
+
+/* The page-walk cache holds page directory entries which point to page
+ * tables, so that a TLB miss near a recently walked page reads only its
+ * PTE. It is direct-mapped by the directory index and flushed with the
+ * TLB, as a real CPU's paging-structure cache is.
+ */
+#define PWC_BIT 4
+#define PWC_NUM (1 << PWC_BIT)
 
 void init_tlb();
+void tlb_flush();
+void tlb_flush_nonglobal();
 int read_tlb(uint32_t addr);
-void write_tlb(uint32_t lnaddr, uint32_t hwaddr);
+void touch_tlb(int index);
+int write_tlb(uint32_t lnaddr, uint32_t hwaddr, bool global, bool large, bool dirty);
+bool read_pwc(uint32_t dir, uint32_t *pde);
+void write_pwc(uint32_t dir, uint32_t pde);
+void info_tlb();
 
 #endif
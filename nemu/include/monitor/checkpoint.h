@@ -0,0 +1,41 @@
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "common.h"
+
+/* A checkpoint holds the machine state and the guest pages written since
+ * its parent, the checkpoint saved or loaded before it. Loading one maps
+ * the pages of its chain of parents copy-on-write from their files, so
+ * many NEMU processes can fan out from the same checkpoint cheaply.
+ *
+ * Each module keeps its own state and serializes it in a `*_ckpt()'
+ * function, which ckpt_data() makes work for both saving and loading.
+ * The state is stored in named sections, and a section which the
+ * loading NEMU has no use for (such as the caches with `--mem=fast')
+ * is skipped.
+ */
+
+typedef struct {
+	FILE *fp;
+	bool load;
+	/* the file offset of the length of the open section */
+	long section;
+} Ckpt;
+
+void ckpt_data(Ckpt *, void *, size_t);
+void ckpt_check(Ckpt *, uint32_t, const char *);
+
+bool checkpoint_save(const char *);
+bool checkpoint_load(const char *);
+
+/* the checkpoint given with `--load', loaded by restart() */
+extern char *load_file;
+
+/* The checkpoint given with `--save-at-entry', saved by cpu_exec() when
+ * EIP first reaches the entry of the program. With the kernel, that is
+ * where its loader() returns, so runs can skip booting it with `--load'.
+ */
+extern char *entry_file;
+void checkpoint_entry();
+
+#endif
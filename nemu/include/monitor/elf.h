@@ -13,5 +13,12 @@ void getFrame();
 
 int getVariable(char*, bool*); 
 
+int nr_symbol();
+const char *symbol_name(int);
+int find_function(swaddr_t, swaddr_t *, swaddr_t *);
+
+/* the entry point of the program */
+extern swaddr_t elf_entry;
+
 
 #endif
\ No newline at end of file
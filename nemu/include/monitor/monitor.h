@@ -4,4 +4,7 @@
 enum { STOP, RUNNING, END };
 extern int nemu_state;
 
+enum { ENGINE_INTERP, ENGINE_BLOCK, ENGINE_JIT };
+extern int exec_engine;
+
 #endif
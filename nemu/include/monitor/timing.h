@@ -0,0 +1,46 @@
+#ifndef __TIMING_H__
+#define __TIMING_H__
+
+#include "common.h"
+
+/* A cycle-approximate timing model on top of the cache, DRAM and TLB
+ * models of `--mem=cache'. With `--timing', every instruction costs
+ * LAT_INSTR cycles plus the latencies of the events raised by its
+ * instruction fetch and data accesses. Latencies are changed with
+ * `--lat=NAME=CYCLES'. `info timing' shows the CPI of each instruction
+ * class, the AMAT breakdown and the cycles spent in each function.
+ */
+
+enum { LAT_INSTR, LAT_L1, LAT_L2, LAT_ROW_HIT, LAT_ROW_MISS, LAT_TLB_MISS, LAT_WALK, NR_LAT };
+
+/* A row-buffer event is one DRAM burst, a walk event one page table
+ * entry read by the page walker.
+ */
+enum { T_L1_HIT, T_L1_MISS, T_L2_HIT, T_L2_MISS, T_ROW_HIT, T_ROW_MISS, T_TLB_MISS, T_WALK, NR_T_EVENT };
+
+extern bool timing_on;
+/* neither timing events nor memory statistics are counted while this
+ * is non-zero */
+extern int timing_mute;
+extern uint32_t timing_lat[NR_LAT];
+extern const int timing_event_lat[NR_T_EVENT];
+extern uint64_t timing_count[NR_T_EVENT];
+/* cycles of the events since the last instruction was accounted */
+extern uint64_t timing_pending;
+
+static inline void timing_event(int ev) {
+	if(timing_on && timing_mute == 0) {
+		timing_count[ev] ++;
+		timing_pending += timing_lat[timing_event_lat[ev]];
+	}
+}
+
+void init_timing();
+bool timing_parse(const char *);
+void timing_instr(swaddr_t, int);
+void info_timing();
+
+/* in memory/memory.c */
+void timing_fetch(swaddr_t, int);
+
+#endif
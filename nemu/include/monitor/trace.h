@@ -0,0 +1,53 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "common.h"
+
+/* With `--trace', the EIP and length of recently executed instructions
+ * are kept in a ring buffer. It costs two stores per instruction and is
+ * only written out, in the format of the DEBUG log, when the program
+ * traps or NEMU crashes.
+ */
+
+#define TRACE_RING_BIT 16
+#define TRACE_RING_SIZE (1 << TRACE_RING_BIT)
+
+/* With `--trace-file=FILE', every executed instruction is appended to
+ * FILE in the binary format below, which `nemu-trace FILE' prints as
+ * text. Records are collected in a TRACE_BUF_SIZE buffer and written
+ * with a single write(2) each time it fills up.
+ *
+ *   header:  TRACE_MAGIC, uint32_t flags
+ *   record:  uint8_t tag           instruction length in TRACE_TAG_LEN,
+ *                                  TRACE_TAG_EIP if the EIP follows
+ *            uint32_t eip          only if the instruction does not
+ *                                  follow the previous one
+ *            uint8_t bytes[len]
+ *            char asm[]            with TRACE_F_ASM: the assembly of the
+ *                                  DEBUG log, terminated by '\0'
+ *            uint8_t mask          with TRACE_F_REGS: GPRs changed by
+ *            uint32_t val[]        the instruction and their new values
+ *
+ * Only the DEBUG build has the assembly, which the execute helpers
+ * print as they run.
+ */
+
+#define TRACE_MAGIC "NEMUTRC1"
+#define TRACE_MAGIC_LEN 8
+#define TRACE_F_REGS 0x1
+#define TRACE_F_ASM 0x2
+#define TRACE_ASM_MAX 80
+#define TRACE_TAG_LEN 0x1f
+#define TRACE_TAG_EIP 0x20
+#define TRACE_REC_MAX (1 + 4 + TRACE_TAG_LEN + TRACE_ASM_MAX + 1 + 8 * 4)
+#define TRACE_BUF_SIZE (1 << 20)
+
+extern bool trace_on;
+extern bool trace_regs;
+extern const char *trace_file;
+
+void init_trace();
+void trace_record(swaddr_t, int);
+void trace_dump();
+
+#endif
@@ -24,5 +24,7 @@ void info_wp();
 
 bool check_wp();
 
+bool has_wp();
+
 #endif
 
@@ -0,0 +1,159 @@
+#include "cpu/helper.h"
+#include "cpu/block.h"
+#include "cpu/jit.h"
+#include "monitor/monitor.h"
+
+static TB tb_table[TB_NUM];
+
+/* the block executed last, whose successor list gets updated */
+static TB *last_tb = NULL;
+
+/* the block under construction */
+static TB rec;
+static bool recording = false;
+static swaddr_t rec_next;
+
+/* the block being run and how many of its instructions have finished,
+ * for an exception which leaves it through longjmp()
+ */
+static bool in_block = false, in_jit = false;
+static uint32_t nr_done;
+
+void init_block() {
+	int i;
+	for(i = 0; i < TB_NUM; i ++) {
+		tb_table[i].gen = 0;
+	}
+	last_tb = NULL;
+	recording = false;
+	in_block = false;
+}
+
+static inline bool tb_valid(TB *tb, swaddr_t eip) {
+	return tb->eip == eip && tb->gen == decode_cache_generation();
+}
+
+static TB* find_block(swaddr_t eip) {
+	int i;
+	if(last_tb != NULL) {
+		for(i = 0; i < TB_NR_SUCC; i ++) {
+			TB *s = last_tb->succ[i];
+			if(s != NULL && tb_valid(s, eip)) { return s; }
+		}
+	}
+
+	TB *tb = &tb_table[eip & (TB_NUM - 1)];
+	if(!tb_valid(tb, eip)) { return NULL; }
+
+	/* chain it to its predecessor */
+	if(last_tb != NULL) {
+		last_tb->succ[1] = last_tb->succ[0];
+		last_tb->succ[0] = tb;
+	}
+	return tb;
+}
+
+/* Run the block starting at `cpu.eip' if there is one which fits into
+ * `budget' instructions. Return the number of instructions executed,
+ * or 0 if the caller should interpret the next instruction.
+ */
+uint32_t block_exec(uint32_t budget, void (*trace) (swaddr_t, int)) {
+	TB *tb = find_block(cpu.eip);
+	if(tb == NULL || tb->nr_instr > budget) {
+		last_tb = NULL;
+		return 0;
+	}
+
+	if(exec_engine == ENGINE_JIT && trace == NULL && !tb->jit_failed) {
+		if(tb->jit_code == NULL && ++ tb->exec_count >= JIT_THRESHOLD) {
+			tb->jit_failed = !jit_compile(tb);
+		}
+		if(tb->jit_code != NULL) {
+			in_block = in_jit = true;
+			uint32_t nr = jit_exec(tb, budget);
+			in_block = false;
+			if(nr > 0) {
+				last_tb = (nr == tb->nr_instr ? tb : NULL);
+				return nr;
+			}
+			/* the code buffer has been recycled */
+			tb->jit_code = NULL;
+			tb->exec_count = 0;
+		}
+	}
+
+	uint32_t gen = tb->gen;
+	in_block = true;
+	in_jit = false;
+	int i;
+	for(i = 0; i < tb->nr_instr; i ++) {
+		DC_entry *e = &tb->instr[i];
+		/* leave the block when a branch in it is taken */
+		if(cpu.eip != e->eip) { break; }
+
+		nr_done = i;
+		int len = decode_cache_replay(e);
+		cpu.eip += len;
+		if(trace != NULL) { trace(e->eip, len); }
+
+		/* a store has overwritten cached code */
+		if(decode_cache_generation() != gen) { i ++; break; }
+	}
+	in_block = false;
+
+	last_tb = (i == tb->nr_instr ? tb : NULL);
+	return i;
+}
+
+/* Called after an exception has left the block engine through
+ * longjmp(). Return the number of instructions finished before the one
+ * which raised it, or 0 if no block was running.
+ */
+uint32_t block_abort() {
+	if(!in_block) { return 0; }
+	in_block = false;
+	last_tb = NULL;
+	return (in_jit ? jit_abort() : nr_done);
+}
+
+static void finish_record() {
+	recording = false;
+	if(rec.nr_instr == 0 || rec.gen != decode_cache_generation()) { return; }
+
+	TB *tb = &tb_table[rec.eip & (TB_NUM - 1)];
+	memcpy(tb, &rec, sizeof(TB) - sizeof(rec.instr) + rec.nr_instr * sizeof(DC_entry));
+	tb->succ[0] = tb->succ[1] = NULL;
+	tb->exec_count = 0;
+	tb->jit_failed = false;
+	tb->jit_code = NULL;
+}
+
+/* Called after the interpreter has executed the instruction at `eip'
+ * with length `len'. Extend the block under construction with it.
+ */
+void block_record(swaddr_t eip, int len) {
+	if(recording && eip != rec_next) { finish_record(); }
+
+	DC_entry *e = decode_cache_lookup(eip);
+	if(!recording) {
+		if(e == NULL) { return; }
+		recording = true;
+		rec.eip = eip;
+		rec.gen = decode_cache_generation();
+		rec.nr_instr = 0;
+	}
+
+	if(e == NULL) {
+		/* uncacheable instructions are left to the interpreter */
+		finish_record();
+		return;
+	}
+
+	rec.instr[rec.nr_instr ++] = *e;
+	rec_next = eip + len;
+
+	if(cpu.eip != rec_next || rec.nr_instr == TB_MAX_INSTR) {
+		/* control transfer */
+		finish_record();
+	}
+}
@@ -0,0 +1,209 @@
+#include "cpu/helper.h"
+#include "cpu/decode/decode-cache.h"
+#include <stdlib.h>
+
+#define NR_PAGE (HW_MEM_SIZE >> 12)
+
+make_helper(exec);
+lnaddr_t seg_translate(swaddr_t, size_t, uint8_t);
+hwaddr_t page_translate(lnaddr_t, bool);
+
+static DC_entry dc[DECODE_CACHE_SIZE];
+
+Instr_bytes instr_bytes;
+
+/* the bytes of the instruction executed last */
+static const uint8_t *last_bytes = instr_bytes.bytes;
+
+/* An entry is valid only if it carries the current generation,
+ * so flushing the whole cache is a single increment.
+ */
+static uint32_t gen = 1;
+
+/* One bit per byte of physical memory which holds a cached instruction.
+ * `code_page' lets a store skip the bitmap when its page holds no code.
+ * Both are sized by the guest memory.
+ */
+static uint8_t *code_bitmap = NULL;
+static bool *code_page = NULL;
+
+/* the entry under construction while an instruction is decoded */
+static DC_entry fill;
+static bool filling = false;
+static int fill_count;
+static bool fill_forbid;
+
+void init_decode_cache() {
+	free(code_bitmap);
+	free(code_page);
+	/* the zeroed pages from calloc() stay untouched until code is cached */
+	code_bitmap = calloc(HW_MEM_SIZE >> 3, 1);
+	code_page = calloc(NR_PAGE, sizeof(bool));
+	Assert(code_bitmap && code_page, "Can not allocate the code bitmap");
+	gen ++;
+}
+
+void flush_decode_cache() {
+	int i;
+	for(i = 0; i < NR_PAGE; i ++) {
+		if(code_page[i]) {
+			memset(code_bitmap + (i << 9), 0, 1 << 9);
+			code_page[i] = false;
+		}
+	}
+	gen ++;
+}
+
+static void mark_code(hwaddr_t addr, size_t len) {
+	for(; len > 0; addr ++, len --) {
+		if(addr >= HW_MEM_SIZE) { return; }
+		code_bitmap[addr >> 3] |= 1 << (addr & 0x7);
+		code_page[addr >> 12] = true;
+	}
+}
+
+/* Called on every store to physical memory. Overwriting the bytes of
+ * a cached instruction invalidates the cache.
+ */
+void decode_cache_check_write(hwaddr_t addr, size_t len) {
+	if(addr >= HW_MEM_SIZE || !code_page[addr >> 12]) {
+		if(addr + len - 1 >= HW_MEM_SIZE || !code_page[(addr + len - 1) >> 12]) { return; }
+	}
+
+	for(; len > 0; addr ++, len --) {
+		if(addr < HW_MEM_SIZE && (code_bitmap[addr >> 3] & (1 << (addr & 0x7)))) {
+			flush_decode_cache();
+			return;
+		}
+	}
+}
+
+/* Called by idex() between decode and execute. */
+void decode_cache_record(Operands *ops, void (*execute) (Operands *)) {
+	if(filling) {
+		fill_count ++;
+		fill.execute = execute;
+		fill.ops = *ops;
+#ifdef DEBUG
+		memcpy(fill.text, operand_text, sizeof(fill.text));
+#endif
+	}
+}
+
+/* Called by load_addr() with the components of the effective address. */
+void decode_cache_note_addr(int base_reg, int index_reg, int scale, int32_t disp) {
+	fill.base_reg = base_reg;
+	fill.index_reg = index_reg;
+	fill.scale = scale;
+	fill.disp = disp;
+}
+
+/* Instructions which do not decode once and execute once (such as
+ * `rep') must not be replayed from the cache.
+ */
+void decode_cache_forbid() {
+	fill_forbid = true;
+}
+
+static void refresh_operand(DC_entry *e, Operand *op) {
+	switch(op->type) {
+		case OP_TYPE_REG:
+			switch(op->size) {
+				case 1: op->val = reg_b(op->reg); break;
+				case 2: op->val = reg_w(op->reg); break;
+				default: op->val = reg_l(op->reg); break;
+			}
+			break;
+		case OP_TYPE_MEM:
+			op->addr = e->disp;
+			if(e->base_reg != -1) { op->addr += reg_l(e->base_reg); }
+			if(e->index_reg != -1) { op->addr += reg_l(e->index_reg) << e->scale; }
+			/* the address of lea is not read */
+			if(op->size != 0) { op->val = swaddr_read(op->addr, op->size); }
+			break;
+		default: break;
+	}
+}
+
+static void install(swaddr_t eip, int len) {
+	DC_entry *e = &dc[eip & (DECODE_CACHE_SIZE - 1)];
+	*e = fill;
+	e->eip = eip;
+	e->len = len;
+	e->gen = gen;
+	memcpy(e->bytes, instr_bytes.bytes, len);
+
+	lnaddr_t start = seg_translate(eip, len, R_CS);
+	lnaddr_t end = start + len - 1;
+	if((start >> 12) == (end >> 12)) {
+		mark_code(page_translate(start, false), len);
+	}
+	else {
+		size_t len1 = 0x1000 - (start & 0xfff);
+		mark_code(page_translate(start, false), len1);
+		mark_code(page_translate(end & ~0xfff, false), len - len1);
+	}
+}
+
+uint32_t decode_cache_generation() {
+	return gen;
+}
+
+/* The array is only replaced together with the generation, so the JIT
+ * may keep a pointer to it in the code of a block.
+ */
+const bool* decode_cache_code_page() {
+	return code_page;
+}
+
+DC_entry* decode_cache_lookup(swaddr_t eip) {
+	DC_entry *e = &dc[eip & (DECODE_CACHE_SIZE - 1)];
+	return (e->gen == gen && e->eip == eip ? e : NULL);
+}
+
+/* Execute a cached instruction without fetching or decoding it. */
+int decode_cache_replay(DC_entry *e) {
+	/* the entry stays as decoded, the copy gets the current values */
+	Operands ops = e->ops;
+	refresh_operand(e, &ops.src);
+	refresh_operand(e, &ops.dest);
+	refresh_operand(e, &ops.src2);
+#ifdef DEBUG
+	memcpy(operand_text, e->text, sizeof(operand_text));
+#endif
+	e->execute(&ops);
+	last_bytes = e->bytes;
+	return e->len;
+}
+
+/* Execute the instruction at `eip', replaying it from the cache if possible. */
+int decode_cache_exec(swaddr_t eip) {
+	DC_entry *e = decode_cache_lookup(eip);
+	if(e != NULL) { return decode_cache_replay(e); }
+
+	Operands ops;
+	ops.is_operand_size_16 = false;
+	/* Operands not touched by the decoder must not be refreshed on replay. */
+	ops.src.type = ops.dest.type = ops.src2.type = OP_TYPE_IMM;
+	filling = true;
+	fill_count = 0;
+	fill_forbid = false;
+	uint32_t fill_gen = gen;
+	instr_bytes.eip = eip;
+
+	int len = exec(eip, &ops);
+
+	filling = false;
+	last_bytes = instr_bytes.bytes;
+	if(fill_count == 1 && !fill_forbid && fill_gen == gen && len <= INSTR_MAX_LEN) {
+		install(eip, len);
+	}
+	return len;
+}
+
+/* The bytes of the instruction which the last decode_cache_exec() or
+ * decode_cache_replay() executed, for the trace.
+ */
+const uint8_t* decode_cache_bytes() {
+	return last_bytes;
+}
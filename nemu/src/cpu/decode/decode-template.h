@@ -16,7 +16,7 @@ make_helper(concat(decode_i_, SUFFIX)) {
 	op_src->val = op_src->imm;
 
 #ifdef DEBUG
-	snprintf(op_src->str, OP_STR_SIZE, "$0x%x", op_src->imm);
+	snprintf(OP_STR(op_src), OP_STR_SIZE, "$0x%x", op_src->imm);
 #endif
 	return DATA_BYTE;
 }
@@ -37,43 +37,46 @@ make_helper(concat(decode_si_, SUFFIX)) {
 	//panic("please implement me");
 
 #ifdef DEBUG
-	snprintf(op_src->str, OP_STR_SIZE, "$0x%x", op_src->val);
+	snprintf(OP_STR(op_src), OP_STR_SIZE, "$0x%x", op_src->val);
 #endif
 	return DATA_BYTE;
 }
 #endif
 
 /* eAX */
-static int concat(decode_a_, SUFFIX) (swaddr_t eip, Operand *op) {
+static int concat(decode_a_, SUFFIX) (swaddr_t eip, Operands *ops, Operand *op) {
 	op->type = OP_TYPE_REG;
+	op->size = DATA_BYTE;
 	op->reg = R_EAX;
 	op->val = REG(R_EAX);
 
 #ifdef DEBUG
-	snprintf(op->str, OP_STR_SIZE, "%%%s", REG_NAME(R_EAX));
+	snprintf(OP_STR(op), OP_STR_SIZE, "%%%s", REG_NAME(R_EAX));
 #endif
 	return 0;
 }
 
 /* eXX: eAX, eCX, eDX, eBX, eSP, eBP, eSI, eDI */
-static int concat3(decode_r_, SUFFIX, _internal) (swaddr_t eip, Operand *op) {
+static int concat3(decode_r_, SUFFIX, _internal) (swaddr_t eip, Operands *ops, Operand *op) {
 	op->type = OP_TYPE_REG;
-	op->reg = ops_decoded.opcode & 0x7;
+	op->size = DATA_BYTE;
+	op->reg = ops->opcode & 0x7;
 	op->val = REG(op->reg);
 
 #ifdef DEBUG
-	snprintf(op->str, OP_STR_SIZE, "%%%s", REG_NAME(op->reg));
+	snprintf(OP_STR(op), OP_STR_SIZE, "%%%s", REG_NAME(op->reg));
 #endif
 	return 0;
 }
 
-static int concat3(decode_rm_, SUFFIX, _internal) (swaddr_t eip, Operand *rm, Operand *reg) {
+static int concat3(decode_rm_, SUFFIX, _internal) (swaddr_t eip, Operands *ops, Operand *rm, Operand *reg) {
 	rm->size = DATA_BYTE;
-	int len = read_ModR_M(eip, rm, reg);
+	int len = read_ModR_M(eip, ops, rm, reg);
+	reg->size = DATA_BYTE;
 	reg->val = REG(reg->reg);
 
 #ifdef DEBUG
-	snprintf(reg->str, OP_STR_SIZE, "%%%s", REG_NAME(reg->reg));
+	snprintf(OP_STR(reg), OP_STR_SIZE, "%%%s", REG_NAME(reg->reg));
 #endif
 	return len;
 }
@@ -82,14 +85,14 @@ static int concat3(decode_rm_, SUFFIX, _internal) (swaddr_t eip, Operand *rm, Op
  * Ev <- Gv
  */
 make_helper(concat(decode_r2rm_, SUFFIX)) {
-	return decode_rm_internal(eip, op_dest, op_src);
+	return decode_rm_internal(eip, ops, op_dest, op_src);
 }
 
 /* Gb <- Eb
  * Gv <- Ev
  */
 make_helper(concat(decode_rm2r_, SUFFIX)) {
-	return decode_rm_internal(eip, op_src, op_dest);
+	return decode_rm_internal(eip, ops, op_src, op_dest);
 }
 
 
@@ -97,16 +100,16 @@ make_helper(concat(decode_rm2r_, SUFFIX)) {
  * eAX <- Iv
  */
 make_helper(concat(decode_i2a_, SUFFIX)) {
-	decode_a(eip, op_dest);
-	return decode_i(eip);
+	decode_a(eip, ops, op_dest);
+	return decode_i(eip, ops);
 }
 
 /* Gv <- EvIb
  * Gv <- EvIv
  * use for imul */
 make_helper(concat(decode_i_rm2r_, SUFFIX)) {
-	int len = decode_rm_internal(eip, op_src2, op_dest);
-	len += decode_i(eip + len);
+	int len = decode_rm_internal(eip, ops, op_src2, op_dest);
+	len += decode_i(eip + len, ops);
 	return len;
 }
 
@@ -114,8 +117,8 @@ make_helper(concat(decode_i_rm2r_, SUFFIX)) {
  * Ev <- Iv
  */
 make_helper(concat(decode_i2rm_, SUFFIX)) {
-	int len = decode_rm_internal(eip, op_dest, op_src2);		/* op_src2 not use here */
-	len += decode_i(eip + len);
+	int len = decode_rm_internal(eip, ops, op_dest, op_src2);		/* op_src2 not use here */
+	len += decode_i(eip + len, ops);
 	return len;
 }
 
@@ -123,59 +126,74 @@ make_helper(concat(decode_i2rm_, SUFFIX)) {
  * eXX <- Iv 
  */
 make_helper(concat(decode_i2r_, SUFFIX)) {
-	decode_r_internal(eip, op_dest);
-	return decode_i(eip);
+	decode_r_internal(eip, ops, op_dest);
+	return decode_i(eip, ops);
 }
 
 /* used by unary operations */
 make_helper(concat(decode_rm_, SUFFIX)) {
-	return decode_rm_internal(eip, op_src, op_src2);		/* op_src2 not use here */
+	return decode_rm_internal(eip, ops, op_src, op_src2);		/* op_src2 not use here */
 }
 
 make_helper(concat(decode_r_, SUFFIX)) {
-	return decode_r_internal(eip, op_src);
+	return decode_r_internal(eip, ops, op_src);
 }
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
 make_helper(concat(decode_si2rm_, SUFFIX)) {
-	int len = decode_rm_internal(eip, op_dest, op_src2);	/* op_src2 not use here */
-	len += decode_si_b(eip + len);
+	int len = decode_rm_internal(eip, ops, op_dest, op_src2);	/* op_src2 not use here */
+	len += decode_si_b(eip + len, ops);
 	return len;
 }
 
 make_helper(concat(decode_si_rm2r_, SUFFIX)) {
-	int len = decode_rm_internal(eip, op_src2, op_dest);
-	len += decode_si_b(eip + len);
+	int len = decode_rm_internal(eip, ops, op_src2, op_dest);
+	len += decode_si_b(eip + len, ops);
+	return len;
+}
+
+/* Ev, Gv, CL
+ * used by shld and shrd */
+make_helper(concat(decode_cl_rm2r_, SUFFIX)) {
+	int len = decode_rm_internal(eip, ops, op_src2, op_dest);
+	op_src->type = OP_TYPE_REG;
+	op_src->size = 1;
+	op_src->reg = R_CL;
+	op_src->val = reg_b(R_CL);
+#ifdef DEBUG
+	sprintf(OP_STR(op_src), "%%cl");
+#endif
 	return len;
 }
 #endif
 
 /* used by shift instructions */
 make_helper(concat(decode_rm_1_, SUFFIX)) {
-	int len = decode_r2rm(eip);
+	int len = decode_r2rm(eip, ops);
 	op_src->type = OP_TYPE_IMM;
 	op_src->imm = 1;
 	op_src->val = 1;
 #ifdef DEBUG
-	sprintf(op_src->str, "$1");
+	sprintf(OP_STR(op_src), "$1");
 #endif
 	return len;
 }
 
 make_helper(concat(decode_rm_cl_, SUFFIX)) {
-	int len = decode_r2rm(eip);
+	int len = decode_r2rm(eip, ops);
 	op_src->type = OP_TYPE_REG;
+	op_src->size = 1;
 	op_src->reg = R_CL;
 	op_src->val = reg_b(R_CL);
 #ifdef DEBUG
-	sprintf(op_src->str, "%%cl");
+	sprintf(OP_STR(op_src), "%%cl");
 #endif
 	return len;
 }
 
 make_helper(concat(decode_rm_imm_, SUFFIX)) {
-	int len = decode_r2rm(eip);
-	len += decode_i_b(eip + len);
+	int len = decode_r2rm(eip, ops);
+	len += decode_i_b(eip + len, ops);
 	return len;
 }
 
@@ -1,8 +1,9 @@
 #include "common.h"
 #include "cpu/decode/decode.h"
 
-/* shared by all helper function */
-Operands ops_decoded;
+#ifdef DEBUG
+char operand_text[NR_OP][OP_STR_SIZE];
+#endif
 
 #define DATA_BYTE 1
 #include "decode-template.h"
@@ -1,91 +1,116 @@
 #include "cpu/decode/modrm.h"
 #include "cpu/helper.h"
 
-int load_addr(swaddr_t eip, ModR_M *m, Operand *rm) {
-	assert(m->mod != 3);
-
-	int32_t disp = 0;
-	int instr_len, disp_offset, disp_size = 4;
-	int base_reg = -1, index_reg = -1, scale = 0;
-	swaddr_t addr = 0;
+ModR_M_format modrm_format;
+
+/* Parse the ModR/M byte at `eip' and the address bytes after it.
+ * Return their length.
+ */
+int parse_ModR_M(swaddr_t eip) {
+	ModR_M_format *f = &modrm_format;
+	f->eip = eip;
+	f->m.val = instr_fetch(eip, 1);
+	f->base_reg = f->index_reg = -1;
+	f->scale = 0;
+	f->disp = 0;
+	f->disp_size = 0;
+
+	if(f->m.mod == 3) {
+		f->len = 1;
+		return 1;
+	}
 
-	if(m->R_M == R_ESP) {
+	int disp_offset;
+	if(f->m.R_M == R_ESP) {
 		SIB s;
 		s.val = instr_fetch(eip + 1, 1);
-		base_reg = s.base;
+		f->base_reg = s.base;
+		f->scale = s.ss;
 		disp_offset = 2;
-		scale = s.ss;
 
-		if(s.index != R_ESP) { index_reg = s.index; }
+		if(s.index != R_ESP) { f->index_reg = s.index; }
 	}
 	else {
 		/* no SIB */
-		base_reg = m->R_M;
+		f->base_reg = f->m.R_M;
 		disp_offset = 1;
 	}
 
-	if(m->mod == 0) {
-		if(base_reg == R_EBP) { base_reg = -1; }
-		else { disp_size = 0; }
+	if(f->m.mod == 0) {
+		if(f->base_reg == R_EBP) { f->base_reg = -1; f->disp_size = 4; }
 	}
-	else if(m->mod == 1) { disp_size = 1; }
+	else { f->disp_size = (f->m.mod == 1 ? 1 : 4); }
 
-	instr_len = disp_offset;
-	if(disp_size != 0) {
+	if(f->disp_size != 0) {
 		/* has disp */
-		disp = instr_fetch(eip + disp_offset, disp_size);
-		if(disp_size == 1) { disp = (int8_t)disp; }
-
-		instr_len += disp_size;
-		addr += disp;
+		f->disp = instr_fetch(eip + disp_offset, f->disp_size);
+		if(f->disp_size == 1) { f->disp = (int8_t)f->disp; }
 	}
 
-	if(base_reg != -1) {
-		addr += reg_l(base_reg);
+	f->len = disp_offset + f->disp_size;
+	return f->len;
+}
+
+/* exec() has parsed the ModR/M byte of most instructions already */
+static inline ModR_M_format* format_at(swaddr_t eip) {
+	if(modrm_format.eip != eip) { parse_ModR_M(eip); }
+	return &modrm_format;
+}
+
+int load_addr(swaddr_t eip, ModR_M *m, Operands *ops, Operand *rm) {
+	assert(m->mod != 3);
+
+	ModR_M_format *f = format_at(eip);
+	swaddr_t addr = f->disp;
+
+	if(f->base_reg != -1) {
+		addr += reg_l(f->base_reg);
 	}
 
-	if(index_reg != -1) {
-		addr += reg_l(index_reg) << scale;
+	if(f->index_reg != -1) {
+		addr += reg_l(f->index_reg) << f->scale;
 	}
 
+	decode_cache_note_addr(f->base_reg, f->index_reg, f->scale, f->disp);
+
 #ifdef DEBUG
 	char disp_buf[16];
 	char base_buf[8];
 	char index_buf[8];
+	int32_t disp = f->disp;
 
-	if(disp_size != 0) {
+	if(f->disp_size != 0) {
 		/* has disp */
 		sprintf(disp_buf, "%s%#x", (disp < 0 ? "-" : ""), (disp < 0 ? -disp : disp));
 	}
 	else { disp_buf[0] = '\0'; }
 
-	if(base_reg == -1) { base_buf[0] = '\0'; }
+	if(f->base_reg == -1) { base_buf[0] = '\0'; }
 	else { 
-		sprintf(base_buf, "%%%s", regsl[base_reg]); 
+		sprintf(base_buf, "%%%s", regsl[f->base_reg]); 
 	}
 
-	if(index_reg == -1) { index_buf[0] = '\0'; }
+	if(f->index_reg == -1) { index_buf[0] = '\0'; }
 	else { 
-		sprintf(index_buf, ",%%%s,%d", regsl[index_reg], 1 << scale); 
+		sprintf(index_buf, ",%%%s,%d", regsl[f->index_reg], 1 << f->scale); 
 	}
 
-	if(base_reg == -1 && index_reg == -1) {
-		sprintf(rm->str, "%s", disp_buf);
+	if(f->base_reg == -1 && f->index_reg == -1) {
+		sprintf(OP_STR(rm), "%s", disp_buf);
 	}
 	else {
-		sprintf(rm->str, "%s(%s%s)", disp_buf, base_buf, index_buf);
+		sprintf(OP_STR(rm), "%s(%s%s)", disp_buf, base_buf, index_buf);
 	}
 #endif
 
 	rm->type = OP_TYPE_MEM;
 	rm->addr = addr;
 
-	return instr_len;
+	return f->len;
 }
 
-int read_ModR_M(swaddr_t eip, Operand *rm, Operand *reg) {
-	ModR_M m;
-	m.val = instr_fetch(eip, 1);
+int read_ModR_M(swaddr_t eip, Operands *ops, Operand *rm, Operand *reg) {
+	ModR_M m = format_at(eip)->m;
 	reg->type = OP_TYPE_REG;
 	reg->reg = m.reg;
 
@@ -100,17 +125,16 @@ int read_ModR_M(swaddr_t eip, Operand *rm, Operand *reg) {
 		}
 #ifdef DEBUG
 		switch(rm->size) {
-			case 1: sprintf(rm->str, "%%%s", regsb[m.R_M]); break;
-			case 2: sprintf(rm->str, "%%%s", regsw[m.R_M]); break;
-			case 4: sprintf(rm->str, "%%%s", regsl[m.R_M]); break;
+			case 1: sprintf(OP_STR(rm), "%%%s", regsb[m.R_M]); break;
+			case 2: sprintf(OP_STR(rm), "%%%s", regsw[m.R_M]); break;
+			case 4: sprintf(OP_STR(rm), "%%%s", regsl[m.R_M]); break;
 		}
 #endif
 		return 1;
 	}
 	else {
-		int instr_len = load_addr(eip, &m, rm);
+		int instr_len = load_addr(eip, &m, ops, rm);
 		rm->val = swaddr_read(rm->addr, rm->size);
 		return instr_len;
 	}
 }
-
@@ -1,15 +1,126 @@
-#include "cpu/reg.h"
+#include "cpu/eflags.h"
 
 static const int parity_table [] = {
-	0, 1, 0, 1,
-	1, 0, 1, 0,
-	0, 1, 0, 1,
-	1, 0, 1, 0
+	0, 1, 1, 0,
+	1, 0, 0, 1,
+	1, 0, 0, 1,
+	0, 1, 1, 0
 };
 
-void update_eflags_pf_zf_sf(uint32_t result) {
-	uint8_t temp = result & 0xff;
-	cpu.eflags.PF = parity_table[temp & 0xf] ^ parity_table[temp >> 4];
-	cpu.eflags.ZF = (result == 0);
-	cpu.eflags.SF = result >> 31;
+static inline uint32_t lf_mask() {
+	return 0xffffffffu >> ((4 - cpu.lf.size) << 3);
+}
+
+static inline uint32_t lf_msb(uint32_t val) {
+	return (val >> ((cpu.lf.size << 3) - 1)) & 1;
+}
+
+/* The bit of the sign-extended operand of sar which goes to CF. A count
+ * beyond the operand size shifts out copies of the sign bit.
+ */
+static inline uint32_t sar_bit(uint32_t count) {
+	uint32_t bit = 32 - (cpu.lf.size << 3) + count - 1;
+	return (bit < 31 ? bit : 31);
+}
+
+uint32_t eflags_CF() {
+	uint32_t mask = lf_mask();
+	uint32_t dest = cpu.lf.dest & mask, src = cpu.lf.src & mask, result = cpu.lf.result & mask;
+	uint32_t carry;
+	switch(cpu.lf.op) {
+		case LF_ADD: return result < dest;
+		case LF_ADC:
+			carry = (result - dest - src) & mask;
+			return result < dest || (carry && result == dest);
+		case LF_SUB: return dest < src;
+		case LF_SBB:
+			carry = (dest - src - result) & mask;
+			return dest < src || (carry && dest == src);
+		case LF_LOGIC: return 0;
+		/* `src' is the shift count */
+		case LF_SHL: return ((uint64_t)dest << src >> (cpu.lf.size << 3)) & 1;
+		case LF_SHR: return (dest >> (src - 1)) & 1;
+		case LF_SAR: return ((int32_t)(dest << (32 - (cpu.lf.size << 3))) >> sar_bit(src)) & 1;
+		/* `src' tells whether the product overflows the lower half */
+		case LF_MUL: return src != 0;
+		default: return cpu.eflags.CF;
+	}
+}
+
+uint32_t eflags_PF() {
+	if(cpu.lf.op == LF_NONE) { return cpu.eflags.PF; }
+	/* PF is set when the low byte has an even number of 1 bits */
+	uint8_t temp = cpu.lf.result & 0xff;
+	return !(parity_table[temp & 0xf] ^ parity_table[temp >> 4]);
+}
+
+uint32_t eflags_AF() {
+	switch(cpu.lf.op) {
+		/* the carry out of bit 3 */
+		case LF_ADD:
+		case LF_ADC:
+		case LF_SUB:
+		case LF_SBB:
+		case LF_INC:
+		case LF_DEC: return ((cpu.lf.dest ^ cpu.lf.src ^ cpu.lf.result) >> 4) & 1;
+		case LF_NONE: return cpu.eflags.AF;
+		default: return 0;
+	}
+}
+
+uint32_t eflags_ZF() {
+	if(cpu.lf.op == LF_NONE) { return cpu.eflags.ZF; }
+	return (cpu.lf.result & lf_mask()) == 0;
+}
+
+uint32_t eflags_SF() {
+	if(cpu.lf.op == LF_NONE) { return cpu.eflags.SF; }
+	return lf_msb(cpu.lf.result);
+}
+
+uint32_t eflags_OF() {
+	uint32_t mask = lf_mask();
+	uint32_t dest = cpu.lf.dest & mask, src = cpu.lf.src & mask, result = cpu.lf.result & mask;
+	switch(cpu.lf.op) {
+		case LF_ADD:
+		case LF_ADC: return lf_msb(~(dest ^ src) & (dest ^ result));
+		case LF_SUB:
+		case LF_SBB: return lf_msb((dest ^ src) & (dest ^ result));
+		case LF_LOGIC: return 0;
+		case LF_INC: return result == (mask >> 1) + 1;
+		case LF_DEC: return result == mask >> 1;
+		case LF_SHL: return lf_msb(result) ^ eflags_CF();
+		/* the result of shr has 0 as its top bit, that of shrd may not */
+		case LF_SHR: return lf_msb(dest ^ result);
+		case LF_SAR: return 0;
+		case LF_MUL: return src != 0;
+		default: return cpu.eflags.OF;
+	}
+}
+
+bool eflags_cond(int cc) {
+	bool ret;
+	switch(cc >> 1) {
+		case 0: ret = eflags_OF(); break;							/* o */
+		case 1: ret = eflags_CF(); break;							/* b */
+		case 2: ret = eflags_ZF(); break;							/* e */
+		case 3: ret = eflags_CF() || eflags_ZF(); break;			/* be */
+		case 4: ret = eflags_SF(); break;							/* s */
+		case 5: ret = eflags_PF(); break;							/* p */
+		case 6: ret = eflags_SF() != eflags_OF(); break;			/* l */
+		default: ret = eflags_ZF() || eflags_SF() != eflags_OF();	/* le */
+	}
+	/* an odd condition is the negation of the one before it */
+	return ret ^ (cc & 1);
+}
+
+void eflags_sync() {
+	if(cpu.lf.op == LF_NONE) { return; }
+	cpu.eflags.CF = eflags_CF();
+	cpu.eflags.PF = eflags_PF();
+	cpu.eflags.AF = eflags_AF();
+	cpu.eflags.ZF = eflags_ZF();
+	cpu.eflags.SF = eflags_SF();
+	cpu.eflags.OF = eflags_OF();
+	cpu.lf.op = LF_NONE;
 }
@@ -7,6 +7,13 @@
 #include "data-mov/push.h"
 #include "data-mov/pop.h"
 #include "data-mov/leave.h"
+#include "data-mov/enter.h"
+#include "data-mov/pusha.h"
+#include "data-mov/pushf.h"
+#include "data-mov/sreg.h"
+#include "data-mov/cmovcc.h"
+#include "data-mov/bswap.h"
+#include "data-mov/xlat.h"
 
 #include "arith/adc.h"
 #include "arith/dec.h"
@@ -19,11 +26,17 @@
 #include "arith/sbb.h"
 #include "arith/sub.h"
 #include "arith/add.h"
+#include "arith/xadd.h"
+#include "arith/cmpxchg.h"
+#include "arith/bcd.h"
 
 #include "control/jmp.h"
 #include "control/call.h"
 #include "control/jcc.h"
 #include "control/return.h"
+#include "control/loop.h"
+#include "control/far.h"
+#include "control/int.h"
 
 #include "logic/and.h"
 #include "logic/or.h"
@@ -33,17 +46,29 @@
 #include "logic/shl.h"
 #include "logic/shr.h"
 #include "logic/shrd.h"
+#include "logic/shld.h"
+#include "logic/rotate.h"
+#include "logic/bt.h"
+#include "logic/bsf.h"
 #include "logic/test.h"
 #include "logic/cmp.h"
 #include "logic/setcc.h"
 
 #include "string/rep.h"
 #include "string/scas.h"
+#include "string/cmps.h"
 #include "string/stos.h"
 #include "string/movs.h"
 #include "string/lods.h"
+#include "string/ins.h"
+#include "string/outs.h"
+
+#include "io/in.h"
+#include "io/out.h"
 
 #include "misc/misc.h"
 
+#include "fpu/fpu.h"
+
 #include "special/special.h"
 
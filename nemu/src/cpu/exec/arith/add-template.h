@@ -2,14 +2,9 @@
 
 #define instr add
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = op_src->val + op_dest->val;
-    update_eflags_pf_zf_sf(result);
-    int len = (DATA_BYTE << 3) - 1;
-    int s1 = op_dest->val>>len;
-    int s2 = op_src->val>>len;
-    cpu.eflags.OF = (s1 == s2 && s2 != cpu.eflags.SF);
-    cpu.eflags.CF = (result < op_dest->val);
+    set_lazy_flags(LF_ADD, DATA_BYTE, op_dest->val, op_src->val, result);
     OPERAND_W(op_dest, result);
     print_asm_template2();
 }
@@ -0,0 +1,100 @@
+#include "cpu/exec/helper.h"
+#include "cpu/eflags.h"
+#include "cpu/intr.h"
+
+/* The decimal adjustments work on AL. SF, ZF and PF follow the result
+ * as after a logical operation, and CF and AF are set by hand.
+ */
+static void bcd_flags(uint8_t result, bool cf, bool af) {
+	set_lazy_flags(LF_LOGIC, 1, 0, 0, result);
+	eflags_sync();
+	cpu.eflags.CF = cf;
+	cpu.eflags.AF = af;
+}
+
+/* 0x27 */
+make_helper(daa) {
+	eflags_sync();
+	uint8_t al = reg_b(R_AL), old_al = al;
+	bool af = false;
+	if((al & 0xf) > 9 || cpu.eflags.AF) {
+		al += 0x6;
+		af = true;
+	}
+	/* unlike das, the carry of the first step is dropped */
+	bool cf = (old_al > 0x99 || cpu.eflags.CF);
+	if(cf) { al += 0x60; }
+	reg_b(R_AL) = al;
+	bcd_flags(al, cf, af);
+
+	print_asm("daa");
+	return 1;
+}
+
+/* 0x2f */
+make_helper(das) {
+	eflags_sync();
+	uint8_t al = reg_b(R_AL), old_al = al;
+	bool cf = false, af = false;
+	if((al & 0xf) > 9 || cpu.eflags.AF) {
+		cf = (al < 0x6) || cpu.eflags.CF;
+		al -= 0x6;
+		af = true;
+	}
+	if(old_al > 0x99 || cpu.eflags.CF) {
+		al -= 0x60;
+		cf = true;
+	}
+	reg_b(R_AL) = al;
+	bcd_flags(al, cf, af);
+
+	print_asm("das");
+	return 1;
+}
+
+/* 0x37 and 0x3f, with AH taking the carry or borrow */
+static void ascii_adjust(int step) {
+	eflags_sync();
+	bool adjust = ((reg_b(R_AL) & 0xf) > 9 || cpu.eflags.AF);
+	if(adjust) {
+		reg_w(R_AX) += step * 0x6;
+		reg_b(R_AH) += step;
+	}
+	reg_b(R_AL) &= 0xf;
+	bcd_flags(reg_b(R_AL), adjust, adjust);
+}
+
+make_helper(aaa) {
+	ascii_adjust(1);
+	print_asm("aaa");
+	return 1;
+}
+
+make_helper(aas) {
+	ascii_adjust(-1);
+	print_asm("aas");
+	return 1;
+}
+
+/* 0xd4 */
+make_helper(aam) {
+	uint8_t base = instr_fetch(eip + 1, 1);
+	print_asm("aam $0x%x", base);
+	if(base == 0) { raise_intr(0); }
+	uint8_t al = reg_b(R_AL);
+	reg_b(R_AH) = al / base;
+	reg_b(R_AL) = al % base;
+	set_lazy_flags(LF_LOGIC, 1, 0, 0, reg_b(R_AL));
+	return 2;
+}
+
+/* 0xd5 */
+make_helper(aad) {
+	uint8_t base = instr_fetch(eip + 1, 1);
+	uint8_t al = reg_b(R_AL) + reg_b(R_AH) * base;
+	reg_w(R_AX) = al;
+	set_lazy_flags(LF_LOGIC, 1, 0, 0, al);
+
+	print_asm("aad $0x%x", base);
+	return 2;
+}
@@ -0,0 +1,11 @@
+#ifndef __BCD_H__
+#define __BCD_H__
+
+make_helper(daa);
+make_helper(das);
+make_helper(aaa);
+make_helper(aas);
+make_helper(aam);
+make_helper(aad);
+
+#endif
@@ -0,0 +1,25 @@
+#include "cpu/exec/template-start.h"
+
+#define instr cmpxchg
+
+/* The flags are those of comparing the accumulator with the destination.
+ * The destination is written either way, as the bus cycle of the
+ * processor does.
+ */
+static void do_execute(Operands *ops) {
+	DATA_TYPE acc = REG(R_EAX);
+	DATA_TYPE dest = op_dest->val;
+	set_lazy_flags(LF_SUB, DATA_BYTE, acc, dest, (DATA_TYPE)(acc - dest));
+	if(acc == dest) {
+		OPERAND_W(op_dest, op_src->val);
+	}
+	else {
+		OPERAND_W(op_dest, dest);
+		REG(R_EAX) = dest;
+	}
+	print_asm_template2();
+}
+
+make_instr_helper(r2rm)
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,8 @@
+#ifndef __CMPXCHG_H__
+#define __CMPXCHG_H__
+
+make_helper(cmpxchg_r2rm_b);
+
+make_helper(cmpxchg_r2rm_v);
+
+#endif
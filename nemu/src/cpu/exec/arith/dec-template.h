@@ -2,12 +2,11 @@
 
 #define instr dec
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = op_src->val - 1;
 	OPERAND_W(op_src, result);
 
-        update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-	cpu.eflags.OF = (result == 0x7fffffff);
+	set_lazy_flags(LF_DEC, DATA_BYTE, op_src->val, 1, result);
 
 	print_asm_template1();
 }
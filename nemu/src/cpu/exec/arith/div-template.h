@@ -2,16 +2,24 @@
 
 #define instr div
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	uint64_t a;
-	uint32_t b = (DATA_TYPE)op_src->val;
+	uint64_t b = (DATA_TYPE)op_src->val;
 #if DATA_BYTE == 1
-	a = reg_w(R_EAX);
+	a = reg_w(R_AX);
 #else
 	a = ((uint64_t)REG(R_EDX) << (DATA_BYTE * 8)) | REG(R_EAX);
 #endif
+	/* divide error, also when the quotient does not fit */
+	if(b == 0 || a / b > (DATA_TYPE)-1) { raise_intr(0); }
+
+#if DATA_BYTE == 1
+	reg_b(R_AL) = a / b;
+	reg_b(R_AH) = a % b;
+#else
 	REG(R_EAX) = a / b;
 	REG(R_EDX) = a % b;
+#endif
 
 	print_asm_template1();
 }
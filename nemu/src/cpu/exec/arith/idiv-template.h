@@ -2,16 +2,28 @@
 
 #define instr idiv
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	int64_t a;
-	int32_t b = (DATA_TYPE_S)op_src->val;
+	int64_t b = (DATA_TYPE_S)op_src->val;
 #if DATA_BYTE == 1
-	a = (int16_t)reg_w(R_EAX);
+	a = (int16_t)reg_w(R_AX);
+#elif DATA_BYTE == 2
+	a = (int32_t)((uint32_t)reg_w(R_DX) << 16 | reg_w(R_AX));
 #else
-	a = ((int64_t)REG(R_EDX) << (DATA_BYTE * 8)) | (int64_t)REG(R_EAX);
+	a = (int64_t)((uint64_t)reg_l(R_EDX) << 32 | reg_l(R_EAX));
 #endif
-	REG(R_EAX) = a / b;
+	/* divide error, also when the quotient does not fit */
+	if(b == 0 || (b == -1 && a == INT64_MIN)) { raise_intr(0); }
+	int64_t q = a / b;
+	if(q != (DATA_TYPE_S)q) { raise_intr(0); }
+
+#if DATA_BYTE == 1
+	reg_b(R_AL) = q;
+	reg_b(R_AH) = a % b;
+#else
+	REG(R_EAX) = q;
 	REG(R_EDX) = a % b;
+#endif
 
 	print_asm_template1();
 }
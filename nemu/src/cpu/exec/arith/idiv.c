@@ -1,4 +1,5 @@
 #include "cpu/exec/helper.h"
+#include "cpu/intr.h"
 
 #define DATA_BYTE 1
 #include "idiv-template.h"
@@ -11,21 +11,21 @@
 #define instr imul
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
-static void do_execute() {
-	RET_DATA_TYPE result = (RET_DATA_TYPE)op_src->val * (RET_DATA_TYPE)op_src2->val;
+static void do_execute(Operands *ops) {
+	RET_DATA_TYPE result = (RET_DATA_TYPE)(DATA_TYPE_S)op_src->val * (DATA_TYPE_S)op_src2->val;
 	OPERAND_W(op_dest, result);
 
-	/* There is no need to update EFLAGS, since no other instructions 
-	 * in PA will test the flags updated by this instruction.
-	 */
+	/* CF and OF tell whether the product is truncated */
+	set_lazy_flags(LF_MUL, DATA_BYTE, 0, result != (DATA_TYPE_S)result, result);
 
 	print_asm_template3();
 }
 
 make_helper(concat(imul_rm2r_, SUFFIX)) {
-	int len = concat(decode_rm2r_, SUFFIX)(eip + 1);
-	ops_decoded.src2 = ops_decoded.dest;
-	do_execute();
+	int len = concat(decode_rm2r_, SUFFIX)(eip + 1, ops);
+	ops->src2 = ops->dest;
+	decode_cache_record(ops, do_execute);
+	do_execute(ops);
 	return len + 1;
 }
 
@@ -33,8 +33,7 @@ make_instr_helper(si_rm2r)
 make_instr_helper(i_rm2r)
 #endif
 
-make_helper(concat(imul_rm2a_, SUFFIX)) {
-	int len = concat(decode_rm_, SUFFIX)(eip + 1);
+static void concat(do_imul_rm2a_, SUFFIX) (Operands *ops) {
 	int64_t src = (DATA_TYPE_S)op_src->val;
 	int64_t result = (DATA_TYPE_S)REG(R_EAX) * src;
 #if DATA_BYTE == 1
@@ -47,12 +46,13 @@ make_helper(concat(imul_rm2a_, SUFFIX)) {
 	REG(R_EDX) = result >> 32;
 #endif
 
-	/* There is no need to update EFLAGS, since no other instructions 
-	 * in PA will test the flags updated by this instruction.
-	 */
+	set_lazy_flags(LF_MUL, DATA_BYTE, 0, result != (DATA_TYPE_S)result, result);
 
 	print_asm_template1();
-	return len + 1;
+}
+
+make_helper(concat(imul_rm2a_, SUFFIX)) {
+	return idex(eip, ops, concat(decode_rm_, SUFFIX), concat(do_imul_rm2a_, SUFFIX));
 }
 
 #undef RET_DATA_TYPE
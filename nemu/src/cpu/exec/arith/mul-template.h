@@ -2,9 +2,9 @@
 
 #define instr mul
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	uint64_t src = op_src->val;
-	uint64_t result = REG(R_EAX) * src;
+	uint64_t result = (DATA_TYPE)REG(R_EAX) * src;
 #if DATA_BYTE == 1
 	reg_w(R_AX) = result;
 #elif DATA_BYTE == 2
@@ -15,9 +15,8 @@ static void do_execute() {
 	REG(R_EDX) = result >> 32;
 #endif
 
-	/* There is no need to update EFLAGS, since no other instructions 
-	 * in PA will test the flags updated by this instruction.
-	 */
+	/* CF and OF tell whether the upper half is in use */
+	set_lazy_flags(LF_MUL, DATA_BYTE, 0, (result >> (DATA_BYTE * 8)) != 0, result);
 
 	print_asm_template1();
 }
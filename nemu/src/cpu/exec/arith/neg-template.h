@@ -2,13 +2,12 @@
 
 #define instr neg
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = -op_src->val;
 	OPERAND_W(op_src, result);
 
-	/* There is no need to update EFLAGS, since no other instructions 
-	 * in PA will test the flags updated by this instruction.
-	 */
+	/* neg sets the flags as `0 - src' does */
+	set_lazy_flags(LF_SUB, DATA_BYTE, 0, op_src->val, result);
 
 	print_asm_template1();
 }
@@ -2,23 +2,21 @@
 
 #define instr sub
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = op_dest->val - op_src->val;
 	OPERAND_W(op_dest, result);
 
-	update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-	cpu.eflags.CF = result > op_dest->val;
-	cpu.eflags.OF = MSB((op_dest->val ^ op_src->val) & (op_dest->val ^ result));
+	set_lazy_flags(LF_SUB, DATA_BYTE, op_dest->val, op_src->val, result);
 
 	print_asm_template2();
 }
 
+make_instr_helper(i2a)
 make_instr_helper(i2rm)
 #if DATA_BYTE == 2 || DATA_BYTE == 4
 make_instr_helper(si2rm)
 #endif
 make_instr_helper(r2rm)
 make_instr_helper(rm2r)
-make_instr_helper(i2a)
 
 #include "cpu/exec/template-end.h"
@@ -0,0 +1,26 @@
+#include "cpu/exec/template-start.h"
+
+#define instr xadd
+
+/* The register gets the old destination, and the destination the sum.
+ * A destination in memory is written first, so that a page fault leaves
+ * the register as it was.
+ */
+static void do_execute(Operands *ops) {
+	DATA_TYPE dest = op_dest->val;
+	DATA_TYPE result = dest + op_src->val;
+	set_lazy_flags(LF_ADD, DATA_BYTE, dest, op_src->val, result);
+	if(op_dest->type == OP_TYPE_MEM) {
+		OPERAND_W(op_dest, result);
+		OPERAND_W(op_src, dest);
+	}
+	else {
+		OPERAND_W(op_src, dest);
+		OPERAND_W(op_dest, result);
+	}
+	print_asm_template2();
+}
+
+make_instr_helper(r2rm)
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,8 @@
+#ifndef __XADD_H__
+#define __XADD_H__
+
+make_helper(xadd_r2rm_b);
+
+make_helper(xadd_r2rm_v);
+
+#endif
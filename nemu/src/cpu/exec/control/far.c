@@ -0,0 +1,82 @@
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+
+/* Far transfers load CS as well as EIP. `len' is the length of the
+ * instruction, which the caller adds to EIP.
+ */
+static void far_jump(uint16_t selector, uint32_t offset, int len) {
+	cpu.cs.selector = selector;
+	sreg_load(R_CS);
+	cpu.eip = offset - len;
+}
+
+static void far_push(size_t size, uint32_t ret_addr) {
+	swaddr_write(cpu.esp - size, size, cpu.cs.selector);
+	swaddr_write(cpu.esp - 2 * size, size, ret_addr);
+	cpu.esp -= 2 * size;
+}
+
+/* 0xea and 0x9a, with the pointer ptr16:32 in the instruction */
+make_helper(ljmp_i) {
+	size_t size = (ops->is_operand_size_16 ? 2 : 4);
+	uint32_t offset = instr_fetch(eip + 1, size);
+	uint16_t selector = instr_fetch(eip + 1 + size, 2);
+	int len = 1 + size + 2;
+
+	print_asm("ljmp $0x%x,$0x%x", selector, offset);
+	far_jump(selector, offset, len);
+	return len;
+}
+
+make_helper(lcall_i) {
+	size_t size = (ops->is_operand_size_16 ? 2 : 4);
+	uint32_t offset = instr_fetch(eip + 1, size);
+	uint16_t selector = instr_fetch(eip + 1 + size, 2);
+	int len = 1 + size + 2;
+
+	print_asm("lcall $0x%x,$0x%x", selector, offset);
+	far_push(size, cpu.eip + len);
+	far_jump(selector, offset, len);
+	return len;
+}
+
+/* 0xff /3 and /5, with the pointer m16:32 in memory */
+static int far_rm(swaddr_t eip, Operands *ops, bool call) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	Assert(m.mod != 3, "the pointer of a far transfer must be in memory");
+	int len = load_addr(eip + 1, &m, ops, op_src) + 1;
+	size_t size = (ops->is_operand_size_16 ? 2 : 4);
+	uint32_t offset = swaddr_read(op_src->addr, size);
+	uint16_t selector = swaddr_read(op_src->addr + size, 2);
+
+	print_asm("%s *%s", (call ? "lcall" : "ljmp"), OP_STR(op_src));
+	if(call) { far_push(size, cpu.eip + len); }
+	far_jump(selector, offset, len);
+	return len;
+}
+
+make_helper(ljmp_rm) { return far_rm(eip, ops, false); }
+make_helper(lcall_rm) { return far_rm(eip, ops, true); }
+
+static int far_ret(swaddr_t eip, Operands *ops, uint16_t imm, int len) {
+	size_t size = (ops->is_operand_size_16 ? 2 : 4);
+	uint32_t offset = swaddr_read(cpu.esp, size);
+	uint16_t selector = swaddr_read(cpu.esp + size, 2);
+	cpu.esp += 2 * size + imm;
+	far_jump(selector, offset, len);
+	return len;
+}
+
+/* 0xcb */
+make_helper(lret) {
+	print_asm("lret");
+	return far_ret(eip, ops, 0, 1);
+}
+
+/* 0xca */
+make_helper(lret_i) {
+	uint16_t imm = instr_fetch(eip + 1, 2);
+	print_asm("lret $0x%x", imm);
+	return far_ret(eip, ops, imm, 3);
+}
@@ -0,0 +1,11 @@
+#ifndef __FAR_H__
+#define __FAR_H__
+
+make_helper(ljmp_i);
+make_helper(lcall_i);
+make_helper(ljmp_rm);
+make_helper(lcall_rm);
+make_helper(lret);
+make_helper(lret_i);
+
+#endif
@@ -0,0 +1,80 @@
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+#include "cpu/eflags.h"
+#include "cpu/intr.h"
+
+/* raise_intr() does not come back. The address pushed is that of the
+ * next instruction.
+ */
+
+/* 0xcd */
+make_helper(int_i) {
+	uint8_t NO = instr_fetch(eip + 1, 1);
+	print_asm("int $0x%x", NO);
+	cpu.eip += 2;
+	raise_intr(NO);
+	return 2;
+}
+
+/* 0xce */
+make_helper(into) {
+	print_asm("into");
+	if(eflags_OF()) {
+		cpu.eip += 1;
+		raise_intr(4);
+	}
+	return 1;
+}
+
+/* 0x62: #BR is a fault, which returns to the bound itself */
+make_helper(bound) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	Assert(m.mod != 3, "the bounds of bound must be in memory");
+	int len = load_addr(eip + 1, &m, ops, op_src);
+	int32_t idx, lower, upper;
+	if(ops->is_operand_size_16) {
+		idx = (int16_t)reg_w(m.reg);
+		lower = (int16_t)swaddr_read(op_src->addr, 2);
+		upper = (int16_t)swaddr_read(op_src->addr + 2, 2);
+	}
+	else {
+		idx = reg_l(m.reg);
+		lower = swaddr_read(op_src->addr, 4);
+		upper = swaddr_read(op_src->addr + 4, 4);
+	}
+
+	print_asm("bound %s,%%%s", OP_STR(op_src), (ops->is_operand_size_16 ? regsw : regsl)[m.reg]);
+	if(idx < lower || idx > upper) { raise_intr(5); }
+	return len + 1;
+}
+
+/* the flags iret may change, which are those of popf with RF and VM */
+#define IRET_MASK 0x37fd5
+
+/* 0xcf */
+make_helper(iret) {
+	uint32_t new_eip, new_eflags;
+	uint16_t selector;
+	if(ops->is_operand_size_16) {
+		new_eip = swaddr_read(cpu.esp, 2);
+		selector = swaddr_read(cpu.esp + 2, 2);
+		new_eflags = (cpu.eflags.val & 0xffff0000) | swaddr_read(cpu.esp + 4, 2);
+		cpu.esp += 6;
+	}
+	else {
+		new_eip = swaddr_read(cpu.esp, 4);
+		selector = swaddr_read(cpu.esp + 4, 2);
+		new_eflags = swaddr_read(cpu.esp + 8, 4);
+		cpu.esp += 12;
+	}
+
+	cpu.cs.selector = selector;
+	sreg_load(R_CS);
+	cpu.eflags.val = (cpu.eflags.val & ~IRET_MASK) | (new_eflags & IRET_MASK);
+	cpu.lf.op = LF_NONE;
+	cpu.eip = new_eip - 1;
+
+	print_asm(ops->is_operand_size_16 ? "iretw" : "iret");
+	return 1;
+}
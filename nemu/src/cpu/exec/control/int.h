@@ -0,0 +1,9 @@
+#ifndef __INT_H__
+#define __INT_H__
+
+make_helper(int_i);
+make_helper(into);
+make_helper(bound);
+make_helper(iret);
+
+#endif
@@ -2,9 +2,9 @@
 
 #define instr jae
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jae %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.CF == 0) cpu.eip += op_src->val;
+	if(eflags_CF() == 0) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
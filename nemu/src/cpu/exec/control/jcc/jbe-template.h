@@ -2,9 +2,9 @@
 
 #define instr jbe
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	print_asm("jbe %x", cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.CF == 1 || cpu.eflags.ZF == 1) cpu.eip += op_src->val;
+	if(eflags_CF() == 1 || eflags_ZF() == 1) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
@@ -2,9 +2,9 @@
 
 #define instr jl
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jl %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.SF != cpu.eflags.OF) cpu.eip += op_src->val;
+	if(eflags_SF() != eflags_OF()) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
@@ -2,9 +2,9 @@
 
 #define instr jne
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jne %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.ZF == 0) cpu.eip += op_src->val;
+	if(eflags_ZF() == 0) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
@@ -2,9 +2,9 @@
 
 #define instr jng
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jng %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.ZF == 1 || cpu.eflags.SF != cpu.eflags.OF) cpu.eip += op_src->val;
+	if(eflags_ZF() == 1 || eflags_SF() != eflags_OF()) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
@@ -2,9 +2,9 @@
 
 #define instr jno
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jno %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.OF == 0) cpu.eip += op_src->val;
+	if(eflags_OF() == 0) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
@@ -2,9 +2,9 @@
 
 #define instr jns
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jns %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.SF == 0) cpu.eip += op_src->val;
+	if(eflags_SF() == 0) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
@@ -2,9 +2,9 @@
 
 #define instr jo
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jo %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.OF == 1) cpu.eip += op_src->val;
+	if(eflags_OF() == 1) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
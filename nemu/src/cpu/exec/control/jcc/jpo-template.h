@@ -2,9 +2,9 @@
 
 #define instr jpo
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	print_asm("jpo %x",cpu.eip + 1 + DATA_BYTE + op_src->val);
-	if(cpu.eflags.PF == 0) cpu.eip += op_src->val;
+	if(eflags_PF() == 0) cpu.eip += op_src->val;
 }
 
 make_instr_helper(si)
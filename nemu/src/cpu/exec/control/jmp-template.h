@@ -2,7 +2,7 @@
 
 #define instr jmp
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	cpu.eip += op_src->val;
 	print_asm(str(instr) " %x", cpu.eip + 1 + DATA_BYTE);
 }
@@ -10,9 +10,9 @@ static void do_execute() {
 make_instr_helper(si)
 #if DATA_BYTE == 4
 make_helper(jmp_rm_l) {
-	int len = decode_rm_l(eip + 1);
+	int len = decode_rm_l(eip + 1, ops);
 	cpu.eip = op_src->val - (len + 1);
-	print_asm(str(instr) " *%s", op_src->str);
+	print_asm(str(instr) " *%s", OP_STR(op_src));
 	return len + 1;
 }
 #endif
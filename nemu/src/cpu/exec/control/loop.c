@@ -0,0 +1,33 @@
+#include "cpu/exec/helper.h"
+#include "cpu/eflags.h"
+
+#define DATA_BYTE 1
+#include "cpu/exec/template-start.h"
+
+#define instr loop
+
+#ifdef DEBUG
+static const char *loop_name[] = { "loopne", "loope", "loop", "jecxz" };
+#endif
+
+/* 0xe0 loopne, 0xe1 loope, 0xe2 loop and 0xe3 jecxz. The loops count
+ * ECX down without touching the flags.
+ */
+static void do_execute(Operands *ops) {
+	bool taken;
+	if(ops->opcode == 0xe3) {
+		taken = (cpu.ecx == 0);
+	}
+	else {
+		cpu.ecx --;
+		taken = (cpu.ecx != 0 && (ops->opcode == 0xe2 || eflags_ZF() == (ops->opcode & 0x1)));
+	}
+
+	print_asm("%s %x", loop_name[ops->opcode & 0x3], cpu.eip + 2 + op_src->val);
+	if(taken) { cpu.eip += op_src->val; }
+}
+
+make_instr_helper(si)
+
+#include "cpu/exec/template-end.h"
+#undef DATA_BYTE
@@ -0,0 +1,6 @@
+#ifndef __LOOP_H__
+#define __LOOP_H__
+
+make_helper(loop_si_b);
+
+#endif
@@ -0,0 +1,12 @@
+#include "cpu/exec/template-start.h"
+
+#define instr bswap
+
+static void do_execute(Operands *ops) {
+	OPERAND_W(op_src, __builtin_bswap32(op_src->val));
+	print_asm_template1();
+}
+
+make_instr_helper(r)
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,5 @@
+#include "cpu/exec/helper.h"
+
+#define DATA_BYTE 4
+#include "bswap-template.h"
+#undef DATA_BYTE
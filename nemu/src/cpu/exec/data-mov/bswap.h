@@ -0,0 +1,6 @@
+#ifndef __BSWAP_H__
+#define __BSWAP_H__
+
+make_helper(bswap_r_l);
+
+#endif
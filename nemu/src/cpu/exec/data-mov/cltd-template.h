@@ -1,14 +1,14 @@
 #include "cpu/exec/template-start.h"
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
-make_helper(concat(cltd_, SUFFIX)) {
+/* They have no operands to decode, but are still kept in the decode cache. */
+static void concat(do_cltd_, SUFFIX) (Operands *ops) {
 	REG(R_EDX) = -(MSB(REG(R_EAX)));
 
 	print_asm("cltd" str(SUFFIX));
-	return 1;
 }
 
-make_helper(concat(cwtl_, SUFFIX)) {
+static void concat(do_cwtl_, SUFFIX) (Operands *ops) {
 #if DATA_BYTE == 2
 	reg_w(R_AX) = (int8_t)reg_b(R_AL);
 #else
@@ -16,6 +16,17 @@ make_helper(concat(cwtl_, SUFFIX)) {
 #endif
 
 	print_asm("cwtl" str(SUFFIX));
+}
+
+make_helper(concat(cltd_, SUFFIX)) {
+	decode_cache_record(ops, concat(do_cltd_, SUFFIX));
+	concat(do_cltd_, SUFFIX)(ops);
+	return 1;
+}
+
+make_helper(concat(cwtl_, SUFFIX)) {
+	decode_cache_record(ops, concat(do_cwtl_, SUFFIX));
+	concat(do_cwtl_, SUFFIX)(ops);
 	return 1;
 }
 #endif
@@ -0,0 +1,20 @@
+#include "cpu/exec/template-start.h"
+
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+
+#define instr cmovcc
+
+/* The condition is the low 4 bits of the opcode, as with jcc. The source
+ * is read even if it is not moved.
+ */
+static void do_execute(Operands *ops) {
+	int cc = ops->opcode & 0xf;
+	if(eflags_cond(cc)) { OPERAND_W(op_dest, op_src->val); }
+	print_asm("cmov%s" str(SUFFIX) " %s,%s", cc_name[cc], OP_STR(op_src), OP_STR(op_dest));
+}
+
+make_instr_helper(rm2r)
+
+#endif
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,20 @@
+#include "cpu/exec/helper.h"
+
+#ifdef DEBUG
+static const char *cc_name[] = {
+	"o", "no", "b", "ae", "e", "ne", "be", "a",
+	"s", "ns", "p", "np", "l", "ge", "le", "g"
+};
+#endif
+
+#define DATA_BYTE 2
+#include "cmovcc-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 4
+#include "cmovcc-template.h"
+#undef DATA_BYTE
+
+/* for instruction encoding overloading */
+
+make_helper_v(cmovcc_rm2r)
@@ -0,0 +1,6 @@
+#ifndef __CMOVCC_H__
+#define __CMOVCC_H__
+
+make_helper(cmovcc_rm2r_v);
+
+#endif
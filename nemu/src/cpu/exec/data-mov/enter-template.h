@@ -0,0 +1,38 @@
+#include "cpu/exec/template-start.h"
+
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+static inline void concat(enter_push_, SUFFIX) (uint32_t *esp, DATA_TYPE val) {
+	*esp -= DATA_BYTE;
+	MEM_W(*esp, val);
+}
+
+/* enter $size,$level makes a frame of `size' bytes, which holds a copy
+ * of the frame pointers of `level - 1' enclosing frames for nested
+ * procedures. ESP and EBP change at the end, so that a page fault
+ * leaves them as they were.
+ */
+make_helper(concat(enter_, SUFFIX)) {
+	uint16_t size = instr_fetch(eip + 1, 2);
+	uint8_t level = instr_fetch(eip + 3, 1) & 0x1f;
+
+	uint32_t esp = reg_l(R_ESP), ebp = reg_l(R_EBP);
+	concat(enter_push_, SUFFIX)(&esp, REG(R_EBP));
+	uint32_t frame = esp;
+	if(level > 0) {
+		int i;
+		for(i = 1; i < level; i ++) {
+			ebp -= DATA_BYTE;
+			concat(enter_push_, SUFFIX)(&esp, MEM_R(ebp));
+		}
+		concat(enter_push_, SUFFIX)(&esp, frame);
+	}
+	reg_l(R_EBP) = ebp;
+	REG(R_EBP) = frame;
+	reg_l(R_ESP) = esp - size;
+
+	print_asm("enter" str(SUFFIX) " $0x%x,$0x%x", size, level);
+	return 4;
+}
+#endif
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,6 @@
+#ifndef __ENTER_H__
+#define __ENTER_H__
+
+make_helper(enter_v);
+
+#endif
@@ -2,7 +2,7 @@
 
 #define instr mov
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	OPERAND_W(op_dest, op_src->val);
 	print_asm_template2();
 }
@@ -1,38 +1,46 @@
 #include "cpu/exec/template-start.h"
 
 #if DATA_BYTE == 2 || DATA_BYTE  == 4
-make_helper(concat(movzb_, SUFFIX)) {
-	int len = decode_rm2r_b(eip + 1);
+static void concat(do_movzb_, SUFFIX) (Operands *ops) {
 	REG(op_dest->reg) = op_src->val;
 
-	print_asm("movzb" str(SUFFIX) " %s,%%%s", op_src->str, REG_NAME(op_dest->reg));
-	return len + 1;
+	print_asm("movzb" str(SUFFIX) " %s,%%%s", OP_STR(op_src), REG_NAME(op_dest->reg));
 }
 
-make_helper(concat(movsb_, SUFFIX)) {
-	int len = decode_rm2r_b(eip + 1);
+static void concat(do_movsb_, SUFFIX) (Operands *ops) {
 	REG(op_dest->reg) = (int8_t)op_src->val;
 
-	print_asm("movsb" str(SUFFIX) " %s,%%%s", op_src->str, REG_NAME(op_dest->reg));
-	return len + 1;
+	print_asm("movsb" str(SUFFIX) " %s,%%%s", OP_STR(op_src), REG_NAME(op_dest->reg));
+}
+
+make_helper(concat(movzb_, SUFFIX)) {
+	return idex(eip, ops, decode_rm2r_b, concat(do_movzb_, SUFFIX));
+}
+
+make_helper(concat(movsb_, SUFFIX)) {
+	return idex(eip, ops, decode_rm2r_b, concat(do_movsb_, SUFFIX));
 }
 #endif
 
 #if DATA_BYTE  == 4
-make_helper(concat(movzw_, SUFFIX)) {
-	int len = decode_rm2r_w(eip + 1);
+static void concat(do_movzw_, SUFFIX) (Operands *ops) {
 	REG(op_dest->reg) = op_src->val;
 
-	print_asm("movzw" str(SUFFIX) " %s,%%%s", op_src->str, REG_NAME(op_dest->reg));
-	return len + 1;
+	print_asm("movzw" str(SUFFIX) " %s,%%%s", OP_STR(op_src), REG_NAME(op_dest->reg));
 }
 
-make_helper(concat(movsw_, SUFFIX)) {
-	int len = decode_rm2r_w(eip + 1);
+static void concat(do_movsw_, SUFFIX) (Operands *ops) {
 	REG(op_dest->reg) = (int16_t)op_src->val;
 
-	print_asm("movsw" str(SUFFIX) " %s,%%%s", op_src->str, REG_NAME(op_dest->reg));
-	return len + 1;
+	print_asm("movsw" str(SUFFIX) " %s,%%%s", OP_STR(op_src), REG_NAME(op_dest->reg));
+}
+
+make_helper(concat(movzw_, SUFFIX)) {
+	return idex(eip, ops, decode_rm2r_w, concat(do_movzw_, SUFFIX));
+}
+
+make_helper(concat(movsw_, SUFFIX)) {
+	return idex(eip, ops, decode_rm2r_w, concat(do_movsw_, SUFFIX));
 }
 #endif
 
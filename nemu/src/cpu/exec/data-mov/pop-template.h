@@ -2,15 +2,34 @@
 
 #define instr pop
 
-static void do_execute() {
-    reg_l(op_src->reg) = MEM_R(cpu.esp);
+static void do_execute(Operands *ops) {
+	DATA_TYPE val = MEM_R(reg_l(R_ESP));
 	reg_l(R_ESP) += DATA_BYTE;
+	/* `pop %esp' leaves the popped value in ESP */
+	OPERAND_W(op_src, val);
 	print_asm_template1();
 }
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
 make_instr_helper(r)
-make_instr_helper(rm)
+
+/* A memory operand based on ESP is addressed with ESP after the pop, so
+ * it is decoded only then. ESP goes back for the store, so that a page
+ * fault leaves it as it was.
+ */
+make_helper(concat(pop_rm_, SUFFIX)) {
+	DATA_TYPE val = MEM_R(reg_l(R_ESP));
+	reg_l(R_ESP) += DATA_BYTE;
+	int len = concat(decode_rm_, SUFFIX) (eip + 1, ops);
+	if(op_src->type == OP_TYPE_MEM) {
+		reg_l(R_ESP) -= DATA_BYTE;
+		OPERAND_W(op_src, val);
+		reg_l(R_ESP) += DATA_BYTE;
+	}
+	else { OPERAND_W(op_src, val); }
+	print_asm_template1();
+	return len + 1;
+}
 #endif
 
 #include "cpu/exec/template-end.h"
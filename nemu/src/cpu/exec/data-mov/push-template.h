@@ -2,10 +2,18 @@
 
 #define instr push
 
-static void do_execute () {
-	reg_l (R_ESP) -= ((DATA_BYTE == 1) ? 4 : DATA_BYTE);
-	if (DATA_BYTE == 1)op_src->val = (int8_t)op_src->val;
-	swaddr_write(reg_l(R_ESP), 4, op_src->val);
+static void do_execute(Operands *ops) {
+#if DATA_BYTE == 1
+	/* an 8-bit immediate is pushed sign-extended to the operand size */
+	size_t len = (ops->is_operand_size_16 ? 2 : 4);
+	uint32_t val = (int8_t)op_src->val;
+#else
+	size_t len = DATA_BYTE;
+	uint32_t val = op_src->val;
+#endif
+	/* ESP moves only once the store has not faulted */
+	swaddr_write(reg_l(R_ESP) - len, len, val);
+	reg_l(R_ESP) -= len;
 	print_asm_template1();
 }
 
@@ -0,0 +1,32 @@
+#include "cpu/exec/template-start.h"
+
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+/* pusha pushes ESP as it was before the instruction, popa skips it.
+ * Both move ESP at the end, so that a page fault leaves it as it was.
+ */
+make_helper(concat(pusha_, SUFFIX)) {
+	uint32_t esp = reg_l(R_ESP);
+	int i;
+	for(i = R_EAX; i <= R_EDI; i ++) {
+		MEM_W(esp - (i + 1) * DATA_BYTE, (i == R_ESP ? esp : REG(i)));
+	}
+	reg_l(R_ESP) = esp - 8 * DATA_BYTE;
+
+	print_asm("pusha" str(SUFFIX));
+	return 1;
+}
+
+make_helper(concat(popa_, SUFFIX)) {
+	uint32_t esp = reg_l(R_ESP);
+	int i;
+	for(i = R_EDI; i >= R_EAX; i --) {
+		if(i != R_ESP) { REG(i) = MEM_R(esp + (R_EDI - i) * DATA_BYTE); }
+	}
+	reg_l(R_ESP) = esp + 8 * DATA_BYTE;
+
+	print_asm("popa" str(SUFFIX));
+	return 1;
+}
+#endif
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,14 @@
+#include "cpu/exec/helper.h"
+
+#define DATA_BYTE 2
+#include "pusha-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 4
+#include "pusha-template.h"
+#undef DATA_BYTE
+
+/* for instruction encoding overloading */
+
+make_helper_v(pusha)
+make_helper_v(popa)
@@ -0,0 +1,7 @@
+#ifndef __PUSHA_H__
+#define __PUSHA_H__
+
+make_helper(pusha_v);
+make_helper(popa_v);
+
+#endif
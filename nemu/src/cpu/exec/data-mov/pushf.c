@@ -0,0 +1,38 @@
+#include "cpu/exec/helper.h"
+
+/* the flags popf may change: CF, PF, AF, ZF, SF, TF, IF, DF, OF, IOPL and NT */
+#define POPF_MASK 0x7fd5
+
+make_helper(pushf) {
+	eflags_sync();
+	if(ops->is_operand_size_16) {
+		swaddr_write(cpu.esp - 2, 2, cpu.eflags.val);
+		cpu.esp -= 2;
+	}
+	else {
+		/* the image has RF and VM cleared */
+		swaddr_write(cpu.esp - 4, 4, cpu.eflags.val & 0xfffcffff);
+		cpu.esp -= 4;
+	}
+
+	print_asm(ops->is_operand_size_16 ? "pushfw" : "pushfl");
+	return 1;
+}
+
+make_helper(popf) {
+	uint32_t mask = POPF_MASK;
+	uint32_t val;
+	if(ops->is_operand_size_16) {
+		val = swaddr_read(cpu.esp, 2);
+		cpu.esp += 2;
+	}
+	else {
+		val = swaddr_read(cpu.esp, 4);
+		cpu.esp += 4;
+	}
+	cpu.eflags.val = (cpu.eflags.val & ~mask) | (val & mask);
+	cpu.lf.op = LF_NONE;
+
+	print_asm(ops->is_operand_size_16 ? "popfw" : "popfl");
+	return 1;
+}
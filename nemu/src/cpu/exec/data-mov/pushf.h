@@ -0,0 +1,7 @@
+#ifndef __PUSHF_H__
+#define __PUSHF_H__
+
+make_helper(pushf);
+make_helper(popf);
+
+#endif
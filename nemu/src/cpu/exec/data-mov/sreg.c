@@ -0,0 +1,97 @@
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+
+#ifdef DEBUG
+static const char *sreg_name[] = {"es", "cs", "ss", "ds", "fs", "gs"};
+#endif
+
+static void load_sreg(uint8_t sreg, uint16_t selector) {
+	Assert(sreg < 6 && sreg != R_CS, "can not load segment register %d", sreg);
+	cpu.sreg[sreg].selector = selector;
+	sreg_load(sreg);
+}
+
+/* 0x8e */
+make_helper(mov_rm2sreg) {
+	int len = decode_rm_w(eip + 1, ops);
+	uint8_t sreg = modrm_format.m.reg;
+	load_sreg(sreg, op_src->val);
+
+	print_asm("movw %s,%%%s", OP_STR(op_src), sreg_name[sreg]);
+	return len + 1;
+}
+
+/* 0x8c */
+make_helper(mov_sreg2rm) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	uint16_t selector = cpu.sreg[m.reg].selector;
+	int len;
+	if(m.mod == 3) {
+		/* a register gets the selector zero-extended */
+		if(ops->is_operand_size_16) { reg_w(m.R_M) = selector; }
+		else { reg_l(m.R_M) = selector; }
+		len = 1;
+#ifdef DEBUG
+		sprintf(OP_STR(op_src), "%%%s", (ops->is_operand_size_16 ? regsw : regsl)[m.R_M]);
+#endif
+	}
+	else {
+		len = load_addr(eip + 1, &m, ops, op_src);
+		swaddr_write(op_src->addr, 2, selector);
+	}
+
+	print_asm("movw %%%s,%s", sreg_name[m.reg], OP_STR(op_src));
+	return len + 1;
+}
+
+/* The segment register of push and pop: ES, CS, SS and DS are 0x06,
+ * 0x0e, 0x16 and 0x1e, FS and GS are 0x0f 0xa0 and 0x0f 0xa8.
+ */
+static inline uint8_t opcode_sreg(Operands *ops) {
+	return (ops->opcode & 0x100 ? R_FS + ((ops->opcode >> 3) & 1) : (ops->opcode >> 3) & 0x3);
+}
+
+make_helper(push_sreg) {
+	uint8_t sreg = opcode_sreg(ops);
+	size_t len = (ops->is_operand_size_16 ? 2 : 4);
+	swaddr_write(cpu.esp - len, len, cpu.sreg[sreg].selector);
+	cpu.esp -= len;
+
+	print_asm("push %%%s", sreg_name[sreg]);
+	return 1;
+}
+
+make_helper(pop_sreg) {
+	uint8_t sreg = opcode_sreg(ops);
+	size_t len = (ops->is_operand_size_16 ? 2 : 4);
+	uint16_t selector = swaddr_read(cpu.esp, 2);
+	load_sreg(sreg, selector);
+	cpu.esp += len;
+
+	print_asm("pop %%%s", sreg_name[sreg]);
+	return 1;
+}
+
+/* lds, les, lss, lfs and lgs load a far pointer: an offset of the
+ * operand size followed by a selector.
+ */
+static int load_far_pointer(swaddr_t eip, Operands *ops, uint8_t sreg) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	int len = load_addr(eip + 1, &m, ops, op_src);
+	size_t size = (ops->is_operand_size_16 ? 2 : 4);
+	uint32_t offset = swaddr_read(op_src->addr, size);
+	load_sreg(sreg, swaddr_read(op_src->addr + size, 2));
+	if(size == 2) { reg_w(m.reg) = offset; }
+	else { reg_l(m.reg) = offset; }
+
+	print_asm("l%s %s,%%%s", sreg_name[sreg], OP_STR(op_src), (size == 2 ? regsw : regsl)[m.reg]);
+	return len + 1;
+}
+
+make_helper(les) { return load_far_pointer(eip, ops, R_ES); }
+make_helper(lds) { return load_far_pointer(eip, ops, R_DS); }
+make_helper(lss) { return load_far_pointer(eip, ops, R_SS); }
+make_helper(lfs) { return load_far_pointer(eip, ops, R_FS); }
+make_helper(lgs) { return load_far_pointer(eip, ops, R_GS); }
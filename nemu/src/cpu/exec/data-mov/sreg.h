@@ -0,0 +1,14 @@
+#ifndef __SREG_H__
+#define __SREG_H__
+
+make_helper(mov_rm2sreg);
+make_helper(mov_sreg2rm);
+make_helper(push_sreg);
+make_helper(pop_sreg);
+make_helper(les);
+make_helper(lds);
+make_helper(lss);
+make_helper(lfs);
+make_helper(lgs);
+
+#endif
@@ -0,0 +1,8 @@
+#include "cpu/exec/helper.h"
+
+make_helper(xlat) {
+	reg_b(R_AL) = swaddr_read(cpu.ebx + reg_b(R_AL), 1);
+
+	print_asm("xlat %%ds:(%%ebx)");
+	return 1;
+}
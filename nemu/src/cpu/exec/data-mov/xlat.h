@@ -0,0 +1,6 @@
+#ifndef __XLAT_H__
+#define __XLAT_H__
+
+make_helper(xlat);
+
+#endif
@@ -3,238 +3,284 @@
 
 #include "all-instr.h"
 
-typedef int (*helper_fun)(swaddr_t);
+typedef int (*helper_fun)(swaddr_t, Operands *);
 static make_helper(_2byte_esc);
 
-#define make_group(name, item0, item1, item2, item3, item4, item5, item6, item7) \
-	static helper_fun concat(opcode_table_, name) [8] = { \
-	/* 0x00 */	item0, item1, item2, item3, \
-	/* 0x04 */	item4, item5, item6, item7  \
-	}; \
-	static make_helper(name) { \
-		ModR_M m; \
-		m.val = instr_fetch(eip + 1, 1); \
-		return concat(opcode_table_, name) [m.opcode](eip); \
-	}
-	
-/* 0x80 */
-make_group(group1_b,
-	add_i2rm_b, or_i2rm_b, inv, inv, 
-	and_i2rm_b, inv, inv, cmp_i2rm_b)
+/* Decode attributes of an opcode. From them exec() parses the ModR/M
+ * byte, picks the helper of a group by its reg field, and knows the
+ * length of the instruction before the helper decodes it.
+ */
+#define A_MODRM		0x01	/* a ModR/M byte follows the opcode */
+#define A_IB		0x02	/* an 8-bit immediate */
+#define A_IW		0x04	/* a 16-bit immediate */
+#define A_IV		0x08	/* an immediate of the operand size */
+#define A_IL		0x10	/* a 32-bit immediate or address */
+#define A_PREFIX	0x20	/* a prefix or escape; its helper decodes the rest */
+#define A_GROUP		0x40	/* the reg field of ModR/M selects the helper */
+#define A_GROUP_SHIFT 8
 
-/* 0x81 */
-make_group(group1_v,
-	add_i2rm_v, or_i2rm_v, inv, inv, 
-	and_i2rm_v, sub_i2rm_v, inv, cmp_i2rm_v)
+typedef struct {
+	helper_fun helper;
+	uint16_t attr;
+} Opcode_entry;
 
-/* 0x83 */
-make_group(group1_sx_v,
-	add_si2rm_v, or_si2rm_v, inv, inv, 
-	and_si2rm_v, sub_si2rm_v, inv, cmp_si2rm_v)
+/* shorthands for the tables */
+#define E A_MODRM
+#define Ib A_IB
+#define Iw A_IW
+#define Iv A_IV
+#define Il A_IL
+#define INV { inv, 0 }
+#define GROUP(name) { NULL, A_MODRM | A_GROUP | ((name) << A_GROUP_SHIFT) }
 
-/* 0xc0 */
-make_group(group2_i_b,
-	inv, inv, inv, inv, 
-	shl_rm_imm_b, shr_rm_imm_b, inv, sar_rm_imm_b)
+enum {
+	group1_b, group1_v, group1_sx_v,
+	group2_i_b, group2_i_v, group2_1_b, group2_1_v, group2_cl_b, group2_cl_v,
+	group3_b, group3_v, group4, group5, group6, group7, group8,
+	NR_GROUP
+};
 
+/* The entries of a group imply a ModR/M byte. */
+static const Opcode_entry group_table [NR_GROUP][8] = {
+/* 0x80, 0x82 */
+[group1_b] = {
+	{ add_i2rm_b, Ib }, { or_i2rm_b, Ib }, { adc_i2rm_b, Ib }, { sbb_i2rm_b, Ib },
+	{ and_i2rm_b, Ib }, { sub_i2rm_b, Ib }, { xor_i2rm_b, Ib }, { cmp_i2rm_b, Ib } },
+/* 0x81 */
+[group1_v] = {
+	{ add_i2rm_v, Iv }, { or_i2rm_v, Iv }, { adc_i2rm_v, Iv }, { sbb_i2rm_v, Iv },
+	{ and_i2rm_v, Iv }, { sub_i2rm_v, Iv }, { xor_i2rm_v, Iv }, { cmp_i2rm_v, Iv } },
+/* 0x83 */
+[group1_sx_v] = {
+	{ add_si2rm_v, Ib }, { or_si2rm_v, Ib }, { adc_si2rm_v, Ib }, { sbb_si2rm_v, Ib },
+	{ and_si2rm_v, Ib }, { sub_si2rm_v, Ib }, { xor_si2rm_v, Ib }, { cmp_si2rm_v, Ib } },
+/* 0xc0, /6 is an alias of shl */
+[group2_i_b] = {
+	{ rol_rm_imm_b, Ib }, { ror_rm_imm_b, Ib }, { rcl_rm_imm_b, Ib }, { rcr_rm_imm_b, Ib },
+	{ shl_rm_imm_b, Ib }, { shr_rm_imm_b, Ib }, { shl_rm_imm_b, Ib }, { sar_rm_imm_b, Ib } },
 /* 0xc1 */
-make_group(group2_i_v,
-	inv, inv, inv, inv, 
-	shl_rm_imm_v, shr_rm_imm_v, inv, sar_rm_imm_v)
-
+[group2_i_v] = {
+	{ rol_rm_imm_v, Ib }, { ror_rm_imm_v, Ib }, { rcl_rm_imm_v, Ib }, { rcr_rm_imm_v, Ib },
+	{ shl_rm_imm_v, Ib }, { shr_rm_imm_v, Ib }, { shl_rm_imm_v, Ib }, { sar_rm_imm_v, Ib } },
 /* 0xd0 */
-make_group(group2_1_b,
-	inv, inv, inv, inv, 
-	shl_rm_1_b, shr_rm_1_b, inv, sar_rm_1_b)
-
+[group2_1_b] = {
+	{ rol_rm_1_b, 0 }, { ror_rm_1_b, 0 }, { rcl_rm_1_b, 0 }, { rcr_rm_1_b, 0 },
+	{ shl_rm_1_b, 0 }, { shr_rm_1_b, 0 }, { shl_rm_1_b, 0 }, { sar_rm_1_b, 0 } },
 /* 0xd1 */
-make_group(group2_1_v,
-	inv, inv, inv, inv, 
-	shr_rm_1_v, shr_rm_1_v, inv, sar_rm_1_v)
-
+[group2_1_v] = {
+	{ rol_rm_1_v, 0 }, { ror_rm_1_v, 0 }, { rcl_rm_1_v, 0 }, { rcr_rm_1_v, 0 },
+	{ shl_rm_1_v, 0 }, { shr_rm_1_v, 0 }, { shl_rm_1_v, 0 }, { sar_rm_1_v, 0 } },
 /* 0xd2 */
-make_group(group2_cl_b,
-	inv, inv, inv, inv, 
-	shl_rm_cl_b, shr_rm_cl_b, inv, sar_rm_cl_b)
-
+[group2_cl_b] = {
+	{ rol_rm_cl_b, 0 }, { ror_rm_cl_b, 0 }, { rcl_rm_cl_b, 0 }, { rcr_rm_cl_b, 0 },
+	{ shl_rm_cl_b, 0 }, { shr_rm_cl_b, 0 }, { shl_rm_cl_b, 0 }, { sar_rm_cl_b, 0 } },
 /* 0xd3 */
-make_group(group2_cl_v,
-	inv, inv, inv, inv, 
-	shl_rm_cl_v, shr_rm_cl_v, inv, sar_rm_cl_v)
-
-/* 0xf6 */
-make_group(group3_b,
-	test_i2rm_b, inv, inv, inv, 
-	inv, inv, inv, inv)
-
+[group2_cl_v] = {
+	{ rol_rm_cl_v, 0 }, { ror_rm_cl_v, 0 }, { rcl_rm_cl_v, 0 }, { rcr_rm_cl_v, 0 },
+	{ shl_rm_cl_v, 0 }, { shr_rm_cl_v, 0 }, { shl_rm_cl_v, 0 }, { sar_rm_cl_v, 0 } },
+/* 0xf6, /1 is an alias of test */
+[group3_b] = {
+	{ test_i2rm_b, Ib }, { test_i2rm_b, Ib }, { not_rm_b, 0 }, { neg_rm_b, 0 },
+	{ mul_rm_b, 0 }, { imul_rm2a_b, 0 }, { div_rm_b, 0 }, { idiv_rm_b, 0 } },
 /* 0xf7 */
-make_group(group3_v,
-	test_i2rm_v, inv, not_rm_v, neg_rm_v, 
-	mul_rm_v, imul_rm2a_v, div_rm_v, idiv_rm_v)
-
+[group3_v] = {
+	{ test_i2rm_v, Iv }, { test_i2rm_v, Iv }, { not_rm_v, 0 }, { neg_rm_v, 0 },
+	{ mul_rm_v, 0 }, { imul_rm2a_v, 0 }, { div_rm_v, 0 }, { idiv_rm_v, 0 } },
 /* 0xfe */
-make_group(group4,
-	inv, inv, inv, inv, 
-	inv, inv, inv, inv)
-
+[group4] = {
+	{ inc_rm_b, 0 }, { dec_rm_b, 0 }, INV, INV,
+	INV, INV, INV, INV },
 /* 0xff */
-make_group(group5,
-	inv, dec_rm_v, call_rm_v, inv, 
-	jmp_rm_l, inv, push_rm_v, inv)
-
-make_group(group6,
-	inv, inv, inv, inv, 
-	inv, inv, inv, inv)
+[group5] = {
+	{ inc_rm_v, 0 }, { dec_rm_v, 0 }, { call_rm_v, 0 }, { lcall_rm, 0 },
+	{ jmp_rm_l, 0 }, { ljmp_rm, 0 }, { push_rm_v, 0 }, INV },
+/* 0x0f 0x00 */
+[group6] = {
+	INV, INV, INV, INV,
+	INV, INV, INV, INV },
+/* 0x0f 0x01 */
+[group7] = {
+	{ sgdt, 0 }, { sidt, 0 }, { lgdt, 0 }, { lidt, 0 },
+	{ smsw, 0 }, INV, { lmsw, 0 }, { invlpg, 0 } },
+/* 0x0f 0xba */
+[group8] = {
+	INV, INV, INV, INV,
+	{ bt_si2rm_v, Ib }, { bts_si2rm_v, Ib }, { btr_si2rm_v, Ib }, { btc_si2rm_v, Ib } },
+};
 
-make_group(group7,
-	inv, inv, inv, inv, 
-	inv, inv, inv, inv)
+static const Opcode_entry opcode_table [256] = {
+/* 0x00 */	{ add_r2rm_b, E }, { add_r2rm_v, E }, { add_rm2r_b, E }, { add_rm2r_v, E },
+/* 0x04 */	{ add_i2a_b, Ib }, { add_i2a_v, Iv }, { push_sreg, 0 }, { pop_sreg, 0 },
+/* 0x08 */	{ or_r2rm_b, E }, { or_r2rm_v, E }, { or_rm2r_b, E }, { or_rm2r_v, E },
+/* 0x0c */	{ or_i2a_b, Ib }, { or_i2a_v, Iv }, { push_sreg, 0 }, { _2byte_esc, A_PREFIX },
+/* 0x10 */	{ adc_r2rm_b, E }, { adc_r2rm_v, E }, { adc_rm2r_b, E }, { adc_rm2r_v, E },
+/* 0x14 */	{ adc_i2a_b, Ib }, { adc_i2a_v, Iv }, { push_sreg, 0 }, { pop_sreg, 0 },
+/* 0x18 */	{ sbb_r2rm_b, E }, { sbb_r2rm_v, E }, { sbb_rm2r_b, E }, { sbb_rm2r_v, E },
+/* 0x1c */	{ sbb_i2a_b, Ib }, { sbb_i2a_v, Iv }, { push_sreg, 0 }, { pop_sreg, 0 },
+/* 0x20 */	{ and_r2rm_b, E }, { and_r2rm_v, E }, { and_rm2r_b, E }, { and_rm2r_v, E },
+/* 0x24 */	{ and_i2a_b, Ib }, { and_i2a_v, Iv }, { seg_override, A_PREFIX }, { daa, 0 },
+/* 0x28 */	{ sub_r2rm_b, E }, { sub_r2rm_v, E }, { sub_rm2r_b, E }, { sub_rm2r_v, E },
+/* 0x2c */	{ sub_i2a_b, Ib }, { sub_i2a_v, Iv }, { seg_override, A_PREFIX }, { das, 0 },
+/* 0x30 */	{ xor_r2rm_b, E }, { xor_r2rm_v, E }, { xor_rm2r_b, E }, { xor_rm2r_v, E },
+/* 0x34 */	{ xor_i2a_b, Ib }, { xor_i2a_v, Iv }, { seg_override, A_PREFIX }, { aaa, 0 },
+/* 0x38 */	{ cmp_r2rm_b, E }, { cmp_r2rm_v, E }, { cmp_rm2r_b, E }, { cmp_rm2r_v, E },
+/* 0x3c */	{ cmp_i2a_b, Ib }, { cmp_i2a_v, Iv }, { seg_override, A_PREFIX }, { aas, 0 },
+/* 0x40 */	{ inc_r_v, 0 }, { inc_r_v, 0 }, { inc_r_v, 0 }, { inc_r_v, 0 },
+/* 0x44 */	{ inc_r_v, 0 }, { inc_r_v, 0 }, { inc_r_v, 0 }, { inc_r_v, 0 },
+/* 0x48 */	{ dec_r_v, 0 }, { dec_r_v, 0 }, { dec_r_v, 0 }, { dec_r_v, 0 },
+/* 0x4c */	{ dec_r_v, 0 }, { dec_r_v, 0 }, { dec_r_v, 0 }, { dec_r_v, 0 },
+/* 0x50 */	{ push_r_v, 0 }, { push_r_v, 0 }, { push_r_v, 0 }, { push_r_v, 0 },
+/* 0x54 */	{ push_r_v, 0 }, { push_r_v, 0 }, { push_r_v, 0 }, { push_r_v, 0 },
+/* 0x58 */	{ pop_r_v, 0 }, { pop_r_v, 0 }, { pop_r_v, 0 }, { pop_r_v, 0 },
+/* 0x5c */	{ pop_r_v, 0 }, { pop_r_v, 0 }, { pop_r_v, 0 }, { pop_r_v, 0 },
+/* 0x60 */	{ pusha_v, 0 }, { popa_v, 0 }, { bound, E }, INV,
+/* 0x64 */	{ seg_override, A_PREFIX }, { seg_override, A_PREFIX }, { operand_size, A_PREFIX }, INV,
+/* 0x68 */	{ push_i_v, Iv }, { imul_i_rm2r_v, E|Iv }, { push_i_b, Ib }, { imul_si_rm2r_v, E|Ib },
+/* 0x6c */	{ ins_b, 0 }, { ins_v, 0 }, { outs_b, 0 }, { outs_v, 0 },
+/* 0x70 */	{ jo_si_b, Ib }, { jno_si_b, Ib }, { jb_si_b, Ib }, { jae_si_b, Ib },
+/* 0x74 */	{ je_si_b, Ib }, { jne_si_b, Ib }, { jbe_si_b, Ib }, { ja_si_b, Ib },
+/* 0x78 */	{ js_si_b, Ib }, { jns_si_b, Ib }, { jp_si_b, Ib }, { jpo_si_b, Ib },
+/* 0x7c */	{ jl_si_b, Ib }, { jge_si_b, Ib }, { jng_si_b, Ib }, { jnle_si_b, Ib },
+/* 0x80 */	GROUP(group1_b), GROUP(group1_v), GROUP(group1_b), GROUP(group1_sx_v),
+/* 0x84 */	{ test_r2rm_b, E }, { test_r2rm_v, E }, { xchg_r2rm_b, E }, { xchg_r2rm_v, E },
+/* 0x88 */	{ mov_r2rm_b, E }, { mov_r2rm_v, E }, { mov_rm2r_b, E }, { mov_rm2r_v, E },
+/* 0x8c */	{ mov_sreg2rm, E }, { lea, E }, { mov_rm2sreg, E }, { pop_rm_v, E },
+/* 0x90 */	{ nop, 0 }, { xchg_a2r_v, 0 }, { xchg_a2r_v, 0 }, { xchg_a2r_v, 0 },
+/* 0x94 */	{ xchg_a2r_v, 0 }, { xchg_a2r_v, 0 }, { xchg_a2r_v, 0 }, { xchg_a2r_v, 0 },
+/* 0x98 */	{ cwtl_v, 0 }, { cltd_v, 0 }, { lcall_i, Iv|Iw }, { fwait, 0 },
+/* 0x9c */	{ pushf, 0 }, { popf, 0 }, { sahf, 0 }, { lahf, 0 },
+/* 0xa0 */	{ mov_moffs2a_b, Il }, { mov_moffs2a_v, Il }, { mov_a2moffs_b, Il }, { mov_a2moffs_v, Il },
+/* 0xa4 */	{ movs_b, 0 }, { movs_v, 0 }, { cmps_b, 0 }, { cmps_v, 0 },
+/* 0xa8 */	{ test_i2a_b, Ib }, { test_i2a_v, Iv }, { stos_b, 0 }, { stos_v, 0 },
+/* 0xac */	{ lods_b, 0 }, { lods_v, 0 }, { scas_b, 0 }, { scas_v, 0 },
+/* 0xb0 */	{ mov_i2r_b, Ib }, { mov_i2r_b, Ib }, { mov_i2r_b, Ib }, { mov_i2r_b, Ib },
+/* 0xb4 */	{ mov_i2r_b, Ib }, { mov_i2r_b, Ib }, { mov_i2r_b, Ib }, { mov_i2r_b, Ib },
+/* 0xb8 */	{ mov_i2r_v, Iv }, { mov_i2r_v, Iv }, { mov_i2r_v, Iv }, { mov_i2r_v, Iv },
+/* 0xbc */	{ mov_i2r_v, Iv }, { mov_i2r_v, Iv }, { mov_i2r_v, Iv }, { mov_i2r_v, Iv },
+/* 0xc0 */	GROUP(group2_i_b), GROUP(group2_i_v), { ret_i, Iw }, { ret, 0 },
+/* 0xc4 */	{ les, E }, { lds, E }, { mov_i2rm_b, E|Ib }, { mov_i2rm_v, E|Iv },
+/* 0xc8 */	{ enter_v, Iw|Ib }, { leave_r_v, 0 }, { lret_i, Iw }, { lret, 0 },
+/* 0xcc */	{ int3, 0 }, { int_i, Ib }, { into, 0 }, { iret, 0 },
+/* 0xd0 */	GROUP(group2_1_b), GROUP(group2_1_v), GROUP(group2_cl_b), GROUP(group2_cl_v),
+/* 0xd4 */	{ aam, Ib }, { aad, Ib }, { nemu_trap, 0 }, { xlat, 0 },
+/* 0xd8 */	{ fpu_d8, E }, { fpu_d9, E }, { fpu_da, E }, { fpu_db, E },
+/* 0xdc */	{ fpu_dc, E }, { fpu_dd, E }, { fpu_de, E }, { fpu_df, E },
+/* 0xe0 */	{ loop_si_b, Ib }, { loop_si_b, Ib }, { loop_si_b, Ib }, { loop_si_b, Ib },
+/* 0xe4 */	{ in_i2a_b, Ib }, { in_i2a_v, Ib }, { out_a2i_b, Ib }, { out_a2i_v, Ib },
+/* 0xe8 */	{ call_i_v, Iv }, { jmp_si_l, Iv }, { ljmp_i, Iv|Iw }, { jmp_si_b, Ib },
+/* 0xec */	{ in_d2a_b, 0 }, { in_d2a_v, 0 }, { out_a2d_b, 0 }, { out_a2d_v, 0 },
+/* 0xf0 */	{ lock, A_PREFIX }, INV, { repnz, A_PREFIX }, { rep, A_PREFIX },
+/* 0xf4 */	{ hlt, 0 }, { cmc, 0 }, GROUP(group3_b), GROUP(group3_v),
+/* 0xf8 */	{ clc, 0 }, { stc, 0 }, { cli, 0 }, { sti, 0 },
+/* 0xfc */	{ cld, 0 }, { std, 0 }, GROUP(group4), GROUP(group5)
+};
 
+static const Opcode_entry _2byte_opcode_table [256] = {
+/* 0x00 */	GROUP(group6), GROUP(group7), INV, INV,
+/* 0x04 */	INV, INV, { clts, 0 }, INV,
+/* 0x08 */	INV, INV, INV, INV,
+/* 0x0c */	INV, INV, INV, INV,
+/* 0x10 */	INV, INV, INV, INV,
+/* 0x14 */	INV, INV, INV, INV,
+/* 0x18 */	INV, INV, INV, INV,
+/* 0x1c */	INV, INV, INV, INV,
+/* 0x20 */	{ mov_cr2r, E }, INV, { mov_r2cr, E }, INV,
+/* 0x24 */	INV, INV, INV, INV,
+/* 0x28 */	INV, INV, INV, INV,
+/* 0x2c */	INV, INV, INV, INV,
+/* 0x30 */	INV, INV, INV, INV,
+/* 0x34 */	INV, INV, INV, INV,
+/* 0x38 */	INV, INV, INV, INV,
+/* 0x3c */	INV, INV, INV, INV,
+/* 0x40 */	{ cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E },
+/* 0x44 */	{ cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E },
+/* 0x48 */	{ cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E },
+/* 0x4c */	{ cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E }, { cmovcc_rm2r_v, E },
+/* 0x50 */	INV, INV, INV, INV,
+/* 0x54 */	INV, INV, INV, INV,
+/* 0x58 */	INV, INV, INV, INV,
+/* 0x5c */	INV, INV, INV, INV,
+/* 0x60 */	INV, INV, INV, INV,
+/* 0x64 */	INV, INV, INV, INV,
+/* 0x68 */	INV, INV, INV, INV,
+/* 0x6c */	INV, INV, INV, INV,
+/* 0x70 */	INV, INV, INV, INV,
+/* 0x74 */	INV, INV, INV, INV,
+/* 0x78 */	INV, INV, INV, INV,
+/* 0x7c */	INV, INV, INV, INV,
+/* 0x80 */	{ jo_si_v, Iv }, { jno_si_v, Iv }, { jb_si_v, Iv }, { jae_si_v, Iv },
+/* 0x84 */	{ je_si_v, Iv }, { jne_si_v, Iv }, { jbe_si_v, Iv }, { ja_si_v, Iv },
+/* 0x88 */	{ js_si_v, Iv }, { jns_si_v, Iv }, { jp_si_v, Iv }, { jpo_si_v, Iv },
+/* 0x8c */	{ jl_si_v, Iv }, { jge_si_v, Iv }, { jng_si_v, Iv }, { jnle_si_v, Iv },
+/* 0x90 */	{ seto_rm_b, E }, { setno_rm_b, E }, { setb_rm_b, E }, { setae_rm_b, E },
+/* 0x94 */	{ sete_rm_b, E }, { setne_rm_b, E }, { setbe_rm_b, E }, { seta_rm_b, E },
+/* 0x98 */	{ sets_rm_b, E }, { setns_rm_b, E }, { setp_rm_b, E }, { setnp_rm_b, E },
+/* 0x9c */	{ setl_rm_b, E }, { setge_rm_b, E }, { setle_rm_b, E }, { setg_rm_b, E },
+/* 0xa0 */	{ push_sreg, 0 }, { pop_sreg, 0 }, INV, { bt_r2rm_v, E },
+/* 0xa4 */	{ shld_si_rm2r_v, E|Ib }, { shld_cl_rm2r_v, E }, INV, INV,
+/* 0xa8 */	{ push_sreg, 0 }, { pop_sreg, 0 }, INV, { bts_r2rm_v, E },
+/* 0xac */	{ shrd_si_rm2r_v, E|Ib }, { shrd_cl_rm2r_v, E }, INV, { imul_rm2r_v, E },
+/* 0xb0 */	{ cmpxchg_r2rm_b, E }, { cmpxchg_r2rm_v, E }, { lss, E }, { btr_r2rm_v, E },
+/* 0xb4 */	{ lfs, E }, { lgs, E }, { movzb_v, E }, { movzw_l, E },
+/* 0xb8 */	INV, INV, GROUP(group8), { btc_r2rm_v, E },
+/* 0xbc */	{ bsf_rm2r_v, E }, { bsr_rm2r_v, E }, { movsb_v, E }, { movsw_l, E },
+/* 0xc0 */	{ xadd_r2rm_b, E }, { xadd_r2rm_v, E }, INV, INV,
+/* 0xc4 */	INV, INV, INV, INV,
+/* 0xc8 */	{ bswap_r_l, 0 }, { bswap_r_l, 0 }, { bswap_r_l, 0 }, { bswap_r_l, 0 },
+/* 0xcc */	{ bswap_r_l, 0 }, { bswap_r_l, 0 }, { bswap_r_l, 0 }, { bswap_r_l, 0 },
+/* 0xd0 */	INV, INV, INV, INV,
+/* 0xd4 */	INV, INV, INV, INV,
+/* 0xd8 */	INV, INV, INV, INV,
+/* 0xdc */	INV, INV, INV, INV,
+/* 0xe0 */	INV, INV, INV, INV,
+/* 0xe4 */	INV, INV, INV, INV,
+/* 0xe8 */	INV, INV, INV, INV,
+/* 0xec */	INV, INV, INV, INV,
+/* 0xf0 */	INV, INV, INV, INV,
+/* 0xf4 */	INV, INV, INV, INV,
+/* 0xf8 */	INV, INV, INV, INV,
+/* 0xfc */	INV, INV, INV, INV
+};
 
-/* TODO: Add more instructions!!! */
+static inline int imm_len(Operands *ops, uint32_t attr) {
+	int len = 0;
+	if(attr & A_IB) { len += 1; }
+	if(attr & A_IW) { len += 2; }
+	if(attr & A_IV) { len += (ops->is_operand_size_16 ? 2 : 4); }
+	if(attr & A_IL) { len += 4; }
+	return len;
+}
 
-helper_fun opcode_table [256] = {
-/* 0x00 */	add_r2rm_b, add_r2rm_v, add_rm2r_b, add_rm2r_v,
-/* 0x04 */	add_i2a_b, add_i2a_v, inv, inv,
-/* 0x08 */	or_r2rm_b, or_r2rm_v, or_rm2r_b, or_rm2r_v,
-/* 0x0c */	or_i2a_b, or_i2a_v, inv, _2byte_esc,
-/* 0x10 */	inv, adc_r2rm_v, inv, inv,
-/* 0x14 */	inv, inv, inv, inv,
-/* 0x18 */	inv, sbb_r2rm_v, inv, inv,
-/* 0x1c */	inv, inv, inv, inv,
-/* 0x20 */	and_r2rm_b, and_r2rm_v, and_rm2r_b, and_rm2r_v,
-/* 0x24 */	and_i2a_b, and_i2a_v, inv, inv,
-/* 0x28 */	inv, sub_r2rm_v, inv, sub_rm2r_v,
-/* 0x2c */	inv, sub_i2a_v, inv, inv,
-/* 0x30 */	inv, xor_r2rm_v, inv, inv,
-/* 0x34 */	inv, inv, inv, inv,
-/* 0x38 */	cmp_r2rm_b, cmp_r2rm_v, cmp_rm2r_b, cmp_rm2r_v,
-/* 0x3c */	cmp_i2a_b, cmp_i2a_v, inv, inv,
-/* 0x40 */	inc_r_v, inc_r_v, inc_r_v, inc_r_v,
-/* 0x44 */	inv, inc_r_v, inc_r_v, inc_r_v,
-/* 0x48 */	dec_r_v, dec_r_v, dec_r_v, dec_r_v,
-/* 0x4c */	inv, dec_r_v, dec_r_v, dec_r_v,
-/* 0x50 */	push_r_v, push_r_v, push_r_v, push_r_v,
-/* 0x54 */	push_r_v, push_r_v, push_r_v, push_r_v,
-/* 0x58 */	pop_r_v, pop_r_v, pop_r_v, pop_r_v,
-/* 0x5c */	pop_r_v, pop_r_v, pop_r_v, pop_r_v,
-/* 0x60 */	inv, inv, inv, inv,
-/* 0x64 */	inv, inv, operand_size, inv,
-/* 0x68 */	push_i_v, imul_i_rm2r_v, push_i_b, imul_si_rm2r_v,
-/* 0x6c */	inv, inv, inv, inv,
-/* 0x70 */	jo_si_b, jno_si_b, jb_si_b, jae_si_b,
-/* 0x74 */	je_si_b, jne_si_b, jbe_si_b, ja_si_b,
-/* 0x78 */	js_si_b, jns_si_b, jp_si_b, jpo_si_b,
-/* 0x7c */	jl_si_b, jge_si_b, jng_si_b, jnle_si_b,
-/* 0x80 */	group1_b, group1_v, inv, group1_sx_v, 
-/* 0x84 */	test_r2rm_b, test_r2rm_v, inv, inv,
-/* 0x88 */	mov_r2rm_b, mov_r2rm_v, mov_rm2r_b, mov_rm2r_v,
-/* 0x8c */	inv, lea, inv, pop_rm_v,
-/* 0x90 */	nop, inv, inv, inv,
-/* 0x94 */	inv, inv, inv, inv,
-/* 0x98 */	inv, cltd_v, inv, inv,
-/* 0x9c */	inv, inv, inv, inv,
-/* 0xa0 */	mov_moffs2a_b, mov_moffs2a_v, mov_a2moffs_b, mov_a2moffs_v,
-/* 0xa4 */	movs_b, movs_v, inv, inv,
-/* 0xa8 */	test_i2a_b, test_i2a_v, stos_b, stos_v,
-/* 0xac */	lods_b, lods_v, scas_b, inv,
-/* 0xb0 */	mov_i2r_b, mov_i2r_b, mov_i2r_b, mov_i2r_b,
-/* 0xb4 */	mov_i2r_b, mov_i2r_b, mov_i2r_b, mov_i2r_b,
-/* 0xb8 */	mov_i2r_v, mov_i2r_v, mov_i2r_v, mov_i2r_v, 
-/* 0xbc */	mov_i2r_v, mov_i2r_v, mov_i2r_v, mov_i2r_v, 
-/* 0xc0 */	group2_i_b, group2_i_v, ret_i, ret,
-/* 0xc4 */	inv, inv, mov_i2rm_b, mov_i2rm_v,
-/* 0xc8 */	inv, leave_r_v, inv, inv,
-/* 0xcc */	int3, inv, inv, inv,
-/* 0xd0 */	group2_1_b, group2_1_v, group2_cl_b, group2_cl_v,
-/* 0xd4 */	inv, inv, nemu_trap, inv,
-/* 0xd8 */	inv, inv, inv, inv,
-/* 0xdc */	inv, inv, inv, inv,
-/* 0xe0 */	inv, inv, inv, inv,
-/* 0xe4 */	inv, inv, inv, inv,
-/* 0xe8 */	call_i_v, jmp_si_l, inv, jmp_si_b,
-/* 0xec */	inv, inv, inv, inv,
-/* 0xf0 */	inv, inv, repnz, rep,
-/* 0xf4 */	inv, inv, group3_b, group3_v,
-/* 0xf8 */	inv, inv, inv, inv,
-/* 0xfc */	inv, inv, group4, group5
-};
+/* `eip' points to the last byte of the opcode. */
+static int exec_entry(swaddr_t eip, Operands *ops, const Opcode_entry *e) {
+	int len = 1;
+	if(e->attr & A_MODRM) {
+		len += parse_ModR_M(eip + 1);
+		if(e->attr & A_GROUP) {
+			ops->group_idx = modrm_format.m.opcode;
+			e = &group_table[e->attr >> A_GROUP_SHIFT][modrm_format.m.opcode];
+		}
+	}
+	len += imm_len(ops, e->attr);
 
-helper_fun _2byte_opcode_table [256] = {
-/* 0x00 */	group6, group7, inv, inv, 
-/* 0x04 */	inv, inv, inv, inv, 
-/* 0x08 */	inv, inv, inv, inv, 
-/* 0x0c */	inv, inv, inv, inv, 
-/* 0x10 */	inv, inv, inv, inv, 
-/* 0x14 */	inv, inv, inv, inv, 
-/* 0x18 */	inv, inv, inv, inv, 
-/* 0x1c */	inv, inv, inv, inv, 
-/* 0x20 */	inv, inv, inv, inv, 
-/* 0x24 */	inv, inv, inv, inv,
-/* 0x28 */	inv, inv, inv, inv, 
-/* 0x2c */	inv, inv, inv, inv, 
-/* 0x30 */	inv, inv, inv, inv, 
-/* 0x34 */	inv, inv, inv, inv,
-/* 0x38 */	inv, inv, inv, inv, 
-/* 0x3c */	inv, inv, inv, inv, 
-/* 0x40 */	inv, inv, inv, inv, 
-/* 0x44 */	inv, inv, inv, inv,
-/* 0x48 */	inv, inv, inv, inv, 
-/* 0x4c */	inv, inv, inv, inv, 
-/* 0x50 */	inv, inv, inv, inv, 
-/* 0x54 */	inv, inv, inv, inv,
-/* 0x58 */  inv, inv, inv, inv, 
-/* 0x5c */	inv, inv, inv, inv,
-/* 0x60 */	inv, inv, inv, inv,
-/* 0x64 */	inv, inv, inv, inv,
-/* 0x68 */	inv, inv, inv, inv, 
-/* 0x6c */	inv, inv, inv, inv, 
-/* 0x70 */	inv, inv, inv, inv,
-/* 0x74 */	inv, inv, inv, inv,
-/* 0x78 */	inv, inv, inv, inv, 
-/* 0x7c */	inv, inv, inv, inv, 
-/* 0x80 */	jo_si_v, jno_si_v, jb_si_v, jae_si_v,
-/* 0x84 */	je_si_v, jne_si_v, jbe_si_v, ja_si_v,
-/* 0x88 */	js_si_v, jns_si_v, jp_si_v, jpo_si_v,
-/* 0x8c */	jl_si_v, jge_si_v, jng_si_v, jnle_si_v, 
-/* 0x90 */	inv, seto_rm_b, setb_rm_b, setae_rm_b,
-/* 0x94 */	sete_rm_b, setne_rm_b, setbe_rm_b, seta_rm_b,
-/* 0x98 */	inv, sets_rm_b, inv, setp_rm_b, 
-/* 0x9c */	inv, setge_rm_b, inv, setg_rm_b, 
-/* 0xa0 */	inv, inv, inv, inv, 
-/* 0xa4 */	inv, inv, inv, inv,
-/* 0xa8 */	inv, inv, inv, inv,
-/* 0xac */	shrdi_v, inv, inv, imul_rm2r_v,
-/* 0xb0 */	inv, inv, inv, inv, 
-/* 0xb4 */	inv, inv, movzb_v, movzw_l, 
-/* 0xb8 */	inv, inv, inv, inv,
-/* 0xbc */	inv, inv, movsb_v, movsw_l,
-/* 0xc0 */	inv, inv, inv, inv,
-/* 0xc4 */	inv, inv, inv, inv,
-/* 0xc8 */	inv, inv, inv, inv,
-/* 0xcc */	inv, inv, inv, inv,
-/* 0xd0 */	inv, inv, inv, inv,
-/* 0xd4 */	inv, inv, inv, inv,
-/* 0xd8 */	inv, inv, inv, inv,
-/* 0xdc */	inv, inv, inv, inv,
-/* 0xe0 */	inv, inv, inv, inv,
-/* 0xe4 */	inv, inv, inv, inv,
-/* 0xe8 */	inv, inv, inv, inv,
-/* 0xec */	inv, inv, inv, inv,
-/* 0xf0 */	inv, inv, inv, inv,
-/* 0xf4 */	inv, inv, inv, inv,
-/* 0xf8 */	inv, inv, inv, inv,
-/* 0xfc */	inv, inv, inv, inv
-};
+	int instr_len = e->helper(eip, ops);
+#ifdef DEBUG
+	Assert(instr_len == len || (e->attr & A_PREFIX),
+			"eip = 0x%08x: the helper decodes %d bytes, but the opcode table says %d", eip, instr_len, len);
+#endif
+	return instr_len;
+}
 
 make_helper(exec) {
-	ops_decoded.opcode = instr_fetch(eip, 1);
-	return opcode_table[ ops_decoded.opcode ](eip);
+	instr_window_fetch(eip);
+	modrm_format.eip = 0;
+	ops->opcode = instr_fetch(eip, 1);
+	return exec_entry(eip, ops, &opcode_table[ ops->opcode ]);
 }
 
 static make_helper(_2byte_esc) {
 	eip ++;
 	uint32_t opcode = instr_fetch(eip, 1);
-	ops_decoded.opcode = opcode | 0x100;
-	return _2byte_opcode_table[opcode](eip) + 1; 
+	ops->opcode = opcode | 0x100;
+	return exec_entry(eip, ops, &_2byte_opcode_table[opcode]) + 1;
 }
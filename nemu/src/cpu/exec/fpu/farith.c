@@ -0,0 +1,393 @@
+#include "fpu-op.h"
+#include "cpu/eflags.h"
+#include <math.h>
+
+#define LN2 0.693147180559945309417232121458176568L
+#define LOG2E 1.442695040888963407359924681001892137L
+
+/* The reg field of ModR/M selects the operation of d8, da, dc and de. */
+enum { FADD, FMUL, FCOM, FCOMP, FSUB, FSUBR, FDIV, FDIVR };
+
+#ifdef DEBUG
+static const char *arith_name[] = { "fadd", "fmul", "fcom", "fcomp", "fsub", "fsubr", "fdiv", "fdivr" };
+#endif
+
+static long double arith(int op, long double a, long double b) {
+	switch(op) {
+		case FADD: return a + b;
+		case FMUL: return a * b;
+		case FSUB: return a - b;
+		case FSUBR: return b - a;
+		case FDIV: return a / b;
+		case FDIVR: return b / a;
+		default: assert(0);
+	}
+}
+
+static bool is_snan(long double v) {
+	uint64_t m;
+	memcpy(&m, &v, 8);
+	return isnan(v) && !(m & (1ull << 62));
+}
+
+/* fcom raises IE on any NaN, fucom on a signaling one only. */
+static int compare(long double a, long double b, bool quiet) {
+	if(isunordered(a, b)) {
+		if(!quiet || is_snan(a) || is_snan(b)) { cpu.fpu.sw |= FPU_IE; }
+		return FPU_C3 | FPU_C2 | FPU_C0;
+	}
+	return (isless(a, b) ? FPU_C0 : a == b ? FPU_C3 : 0);
+}
+
+static void set_cc(int cc) {
+	cpu.fpu.sw = (cpu.fpu.sw & ~FPU_CC) | cc;
+}
+
+/* ST(0) op= `b'. The caller has begun the host FPU, so that converting
+ * `b' from memory raises its exceptions as well.
+ */
+static void arith_st0(int op, long double b) {
+	long double a = fpu_get(0);
+	if(op == FCOM || op == FCOMP) { set_cc(compare(a, b, false)); }
+	else {
+		set_cc(0);
+		fpu_set(0, arith(op, a, b));
+	}
+	fpu_host_end();
+	if(op == FCOMP) { fpu_pop(); }
+}
+
+void farith_m32(Operands *ops) {
+	fpu_enter(ops, false);
+	union { uint32_t i; float f; } m = { swaddr_read(op_src->addr, 4) };
+	fpu_host_begin();
+	fpu_barrier(m);
+	arith_st0(fpu_modrm_reg(ops), m.f);
+	print_asm("%ss %s", arith_name[fpu_modrm_reg(ops)], OP_STR(op_src));
+}
+
+void farith_m64(Operands *ops) {
+	fpu_enter(ops, false);
+	union { uint64_t i; double f; } m = { fpu_read_q(op_src->addr) };
+	fpu_host_begin();
+	fpu_barrier(m);
+	arith_st0(fpu_modrm_reg(ops), m.f);
+	print_asm("%sl %s", arith_name[fpu_modrm_reg(ops)], OP_STR(op_src));
+}
+
+void fiarith_m16(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_host_begin();
+	arith_st0(fpu_modrm_reg(ops), (int16_t)swaddr_read(op_src->addr, 2));
+	print_asm("fi%ss %s", arith_name[fpu_modrm_reg(ops)] + 1, OP_STR(op_src));
+}
+
+void fiarith_m32(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_host_begin();
+	arith_st0(fpu_modrm_reg(ops), (int32_t)swaddr_read(op_src->addr, 4));
+	print_asm("fi%sl %s", arith_name[fpu_modrm_reg(ops)] + 1, OP_STR(op_src));
+}
+
+/* d8: ST(0) op= ST(i) */
+void farith_st0(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	fpu_host_begin();
+	arith_st0(fpu_modrm_reg(ops), fpu_get(i));
+	print_asm("%s %%st(%d),%%st", arith_name[fpu_modrm_reg(ops)], i);
+}
+
+/* dc, and de which pops: ST(i) op= ST(0). Their reg fields 4 - 7 name
+ * the reverse operations of d8.
+ */
+void farith_sti(Operands *ops) {
+	fpu_enter(ops, false);
+	int op = fpu_modrm_reg(ops);
+	int i = fpu_modrm_rm(ops);
+	bool pop = (ops->opcode == 0xde);
+	if(op == FCOM || op == FCOMP) {
+		/* aliases of fcom and fcomp */
+		fpu_host_begin();
+		arith_st0(op, fpu_get(i));
+		if(pop) { fpu_pop(); }
+	}
+	else {
+		if(op >= FSUB) { op ^= 1; }
+		fpu_host_begin();
+		long double a = fpu_get(i), b = fpu_get(0);
+		set_cc(0);
+		fpu_set(i, arith(op, a, b));
+		fpu_host_end();
+		if(pop) { fpu_pop(); }
+	}
+	print_asm("%s%s %%st,%%st(%d)", arith_name[op], (pop ? "p" : ""), i);
+}
+
+/* dd /4 and /5 */
+void fucom(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	long double a = fpu_get(0), b = fpu_get(i);
+	fpu_host_begin();
+	set_cc(compare(a, b, true));
+	fpu_host_end();
+	bool pop = (fpu_modrm_reg(ops) == 5);
+	if(pop) { fpu_pop(); }
+	print_asm("fucom%s %%st(%d)", (pop ? "p" : ""), i);
+}
+
+/* de d9 fcompp, da e9 fucompp */
+void fcompp(Operands *ops) {
+	fpu_enter(ops, false);
+	bool quiet = (ops->opcode == 0xda);
+	long double a = fpu_get(0), b = fpu_get(1);
+	fpu_host_begin();
+	set_cc(compare(a, b, quiet));
+	fpu_host_end();
+	fpu_pop();
+	fpu_pop();
+	print_asm("f%scompp", (quiet ? "u" : ""));
+}
+
+/* db /5 fucomi, db /6 fcomi, and the popping df /5 and df /6 */
+void fcomi(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	bool quiet = (fpu_modrm_reg(ops) == 5);
+	bool pop = (ops->opcode == 0xdf);
+	long double a = fpu_get(0), b = fpu_get(i);
+	fpu_host_begin();
+	int cc = compare(a, b, quiet);
+	fpu_host_end();
+	cpu.fpu.sw &= ~FPU_C1;
+
+	eflags_sync();
+	cpu.eflags.ZF = !!(cc & FPU_C3);
+	cpu.eflags.PF = !!(cc & FPU_C2);
+	cpu.eflags.CF = !!(cc & FPU_C0);
+	cpu.eflags.OF = cpu.eflags.SF = cpu.eflags.AF = 0;
+	if(pop) { fpu_pop(); }
+	print_asm("f%scomi%s %%st(%d),%%st", (quiet ? "u" : ""), (pop ? "p" : ""), i);
+}
+
+/* da /0 - /3 fcmovb, fcmove, fcmovbe, fcmovu, and db negates them */
+void fcmov(Operands *ops) {
+	static const int cc[] = { 0x2, 0x4, 0x6, 0xa };
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	bool negate = (ops->opcode == 0xdb);
+	if(eflags_cond(cc[fpu_modrm_reg(ops)] | negate)) {
+		long double v = fpu_get(i);
+		fpu_set(0, v);
+	}
+	cpu.fpu.sw &= ~FPU_C1;
+
+#ifdef DEBUG
+	static const char *name[] = { "b", "e", "be", "u" };
+	print_asm("fcmov%s%s %%st(%d),%%st", (negate ? "n" : ""), name[fpu_modrm_reg(ops)], i);
+#endif
+}
+
+/* d9 e0 fchs, e1 fabs, e4 ftst, e5 fxam */
+void fd9_4(Operands *ops) {
+	fpu_enter(ops, false);
+	int rm = fpu_modrm_rm(ops);
+	long double v;
+	switch(rm) {
+		case 0:
+			v = fpu_get(0);
+			fpu_set(0, -v);
+			set_cc(0);
+			print_asm("fchs");
+			break;
+		case 1:
+			v = fpu_get(0);
+			fpu_set(0, fabsl(v));
+			set_cc(0);
+			print_asm("fabs");
+			break;
+		case 4:
+			v = fpu_get(0);
+			fpu_host_begin();
+			set_cc(compare(v, 0.0L, false));
+			fpu_host_end();
+			print_asm("ftst");
+			break;
+		case 5: {
+			/* C3, C2 and C0 tell the class, C1 the sign */
+			int cc;
+			v = cpu.fpu.st[fpu_phys(0)];
+			if(fpu_empty(0)) { cc = FPU_C3 | FPU_C0; }
+			else {
+				switch(fpclassify(v)) {
+					case FP_NAN: cc = FPU_C0; break;
+					case FP_INFINITE: cc = FPU_C2 | FPU_C0; break;
+					case FP_ZERO: cc = FPU_C3; break;
+					case FP_SUBNORMAL: cc = FPU_C3 | FPU_C2; break;
+					default: cc = FPU_C2; break;
+				}
+			}
+			set_cc(cc | (signbit(v) ? FPU_C1 : 0));
+			print_asm("fxam");
+			break;
+		}
+		default:
+			assert(0);
+	}
+}
+
+/* fprem and fprem1 compute the whole remainder at once, so C2 is always
+ * clear. C0, C3 and C1 get the low bits of the quotient. The caller has
+ * begun the host FPU.
+ */
+static void fprem(bool ieee) {
+	int q;
+	long double a = fpu_get(0), b = fpu_get(1);
+	long double r = remquol(a, b, &q);
+	if(q < 0) { q = -q; }
+	if(!ieee && r != 0 && signbit(r) != signbit(a)) {
+		/* the quotient of fprem is truncated, that of remquol() rounded */
+		r = fmodl(a, b);
+		q --;
+	}
+	fpu_set(0, r);
+	set_cc(isnan(r) ? 0 : ((q & 0x4) ? FPU_C0 : 0) | ((q & 0x2) ? FPU_C3 : 0) | ((q & 0x1) ? FPU_C1 : 0));
+}
+
+/* fsin, fcos, fsincos and fptan leave an operand beyond 2^63 alone and set C2 */
+static bool trig_out_of_range(long double v) {
+	bool out = (fabsl(v) >= 0x1p63L && !isinf(v));
+	set_cc(out ? FPU_C2 : 0);
+	return out;
+}
+
+/* d9 f0 - f7 */
+void fd9_6(Operands *ops) {
+	fpu_enter(ops, false);
+	int rm = fpu_modrm_rm(ops);
+	long double a, b;
+	fpu_host_begin();
+	switch(rm) {
+		case 0:
+			a = fpu_get(0);
+			fpu_set(0, expm1l(a * LN2));
+			set_cc(0);
+			print_asm("f2xm1");
+			break;
+		case 1:
+			a = fpu_get(0); b = fpu_get(1);
+			fpu_set(1, b * log2l(a));
+			set_cc(0);
+			fpu_pop();
+			print_asm("fyl2x");
+			break;
+		case 2:
+			a = fpu_get(0);
+			if(!trig_out_of_range(a)) {
+				fpu_set(0, tanl(a));
+				fpu_push(1.0L);
+			}
+			print_asm("fptan");
+			break;
+		case 3:
+			a = fpu_get(0); b = fpu_get(1);
+			fpu_set(1, atan2l(b, a));
+			set_cc(0);
+			fpu_pop();
+			print_asm("fpatan");
+			break;
+		case 4:
+			a = fpu_get(0);
+			if(a == 0) {
+				cpu.fpu.sw |= FPU_ZE;
+				fpu_set(0, -INFINITY);
+			}
+			else if(isinf(a)) { fpu_set(0, INFINITY); }
+			else if(!isnan(a)) {
+				b = logbl(a);
+				fpu_set(0, b);
+				a = scalbnl(a, -(int)b);
+			}
+			set_cc(0);
+			fpu_push(a);
+			print_asm("fxtract");
+			break;
+		case 5:
+			fprem(true);
+			print_asm("fprem1");
+			break;
+		case 6:
+			cpu.fpu.top = (cpu.fpu.top - 1) & 0x7;
+			set_cc(0);
+			print_asm("fdecstp");
+			break;
+		case 7:
+			cpu.fpu.top = (cpu.fpu.top + 1) & 0x7;
+			set_cc(0);
+			print_asm("fincstp");
+			break;
+	}
+	fpu_host_end();
+}
+
+/* d9 f8 - ff */
+void fd9_7(Operands *ops) {
+	fpu_enter(ops, false);
+	int rm = fpu_modrm_rm(ops);
+	long double a, b;
+	fpu_host_begin();
+	switch(rm) {
+		case 0:
+			fprem(false);
+			print_asm("fprem");
+			break;
+		case 1:
+			a = fpu_get(0); b = fpu_get(1);
+			fpu_set(1, b * (log1pl(a) * LOG2E));
+			set_cc(0);
+			fpu_pop();
+			print_asm("fyl2xp1");
+			break;
+		case 2:
+			fpu_set(0, sqrtl(fpu_get(0)));
+			set_cc(0);
+			print_asm("fsqrt");
+			break;
+		case 3:
+			a = fpu_get(0);
+			if(!trig_out_of_range(a)) {
+				fpu_set(0, sinl(a));
+				fpu_push(cosl(a));
+			}
+			print_asm("fsincos");
+			break;
+		case 4:
+			fpu_set(0, rintl(fpu_get(0)));
+			set_cc(0);
+			print_asm("frndint");
+			break;
+		case 5:
+			a = fpu_get(0); b = fpu_get(1);
+			if(isnan(b)) { a = a + b; }
+			else if(isinf(b)) { a = a * (b > 0 ? INFINITY : 0.0L); }
+			else {
+				/* any scale beyond this overflows or underflows anyway */
+				long double n = truncl(b);
+				if(n > 0x10000) { n = 0x10000; }
+				if(n < -0x10000) { n = -0x10000; }
+				a = scalbnl(a, (int)n);
+			}
+			fpu_set(0, a);
+			set_cc(0);
+			print_asm("fscale");
+			break;
+		case 6:
+		case 7:
+			a = fpu_get(0);
+			if(!trig_out_of_range(a)) { fpu_set(0, (rm == 6 ? sinl(a) : cosl(a))); }
+			print_asm(rm == 6 ? "fsin" : "fcos");
+			break;
+	}
+	fpu_host_end();
+}
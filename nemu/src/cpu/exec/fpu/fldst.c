@@ -0,0 +1,395 @@
+#include "fpu-op.h"
+#include <math.h>
+
+static long double read_m80(swaddr_t addr) {
+	uint8_t buf[10];
+	uint64_t m = fpu_read_q(addr);
+	uint16_t e = swaddr_read(addr + 8, 2);
+	memcpy(buf, &m, 8);
+	memcpy(buf + 8, &e, 2);
+	return fpu_load80(buf);
+}
+
+static void write_m80(swaddr_t addr, long double v) {
+	uint8_t buf[10];
+	uint64_t m;
+	uint16_t e;
+	fpu_store80(buf, v);
+	memcpy(&m, buf, 8);
+	memcpy(&e, buf + 8, 2);
+	fpu_write_q(addr, m);
+	swaddr_write(addr + 8, 2, e);
+}
+
+/* d9 /2, /3, dd /2, /3 and df /2, /3 */
+static inline bool st_pop(Operands *ops) {
+	return (fpu_modrm_reg(ops) & 1) || ops->opcode == 0xdf;
+}
+
+void fld_m32(Operands *ops) {
+	fpu_enter(ops, false);
+	long double v = 0;
+	/* a stack overflow leaves the operand alone */
+	if(fpu_empty(7)) {
+		union { uint32_t i; float f; } m = { swaddr_read(op_src->addr, 4) };
+		fpu_host_begin();
+		fpu_barrier(m);
+		v = m.f;
+		fpu_barrier(v);
+		fpu_host_end();
+	}
+	fpu_push(v);
+	print_asm("flds %s", OP_STR(op_src));
+}
+
+void fld_m64(Operands *ops) {
+	fpu_enter(ops, false);
+	long double v = 0;
+	/* a stack overflow leaves the operand alone */
+	if(fpu_empty(7)) {
+		union { uint64_t i; double f; } m = { fpu_read_q(op_src->addr) };
+		fpu_host_begin();
+		fpu_barrier(m);
+		v = m.f;
+		fpu_barrier(v);
+		fpu_host_end();
+	}
+	fpu_push(v);
+	print_asm("fldl %s", OP_STR(op_src));
+}
+
+void fld_m80(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_push(read_m80(op_src->addr));
+	print_asm("fldt %s", OP_STR(op_src));
+}
+
+void fild_m16(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_push((int16_t)swaddr_read(op_src->addr, 2));
+	print_asm("filds %s", OP_STR(op_src));
+}
+
+void fild_m32(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_push((int32_t)swaddr_read(op_src->addr, 4));
+	print_asm("fildl %s", OP_STR(op_src));
+}
+
+void fild_m64(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_push((int64_t)fpu_read_q(op_src->addr));
+	print_asm("fildll %s", OP_STR(op_src));
+}
+
+/* 18 packed BCD digits and a sign byte */
+void fbld(Operands *ops) {
+	fpu_enter(ops, false);
+	long double v = 0;
+	int i;
+	for(i = 8; i >= 0; i --) {
+		uint8_t b = swaddr_read(op_src->addr + i, 1);
+		v = v * 100 + (b >> 4) * 10 + (b & 0xf);
+	}
+	if(swaddr_read(op_src->addr + 9, 1) & 0x80) { v = -v; }
+	fpu_push(v);
+	print_asm("fbld %s", OP_STR(op_src));
+}
+
+void fst_m32(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_host_begin();
+	long double v = fpu_get(0);
+	fpu_barrier(v);
+	union { float f; uint32_t i; } m = { v };
+	fpu_barrier(m);
+	fpu_host_end();
+	swaddr_write(op_src->addr, 4, m.i);
+	bool pop = st_pop(ops);
+	if(pop) { fpu_pop(); }
+	print_asm("fst%ss %s", (pop ? "p" : ""), OP_STR(op_src));
+}
+
+void fst_m64(Operands *ops) {
+	fpu_enter(ops, false);
+	fpu_host_begin();
+	long double v = fpu_get(0);
+	fpu_barrier(v);
+	union { double f; uint64_t i; } m = { v };
+	fpu_barrier(m);
+	fpu_host_end();
+	fpu_write_q(op_src->addr, m.i);
+	bool pop = st_pop(ops);
+	if(pop) { fpu_pop(); }
+	print_asm("fst%sl %s", (pop ? "p" : ""), OP_STR(op_src));
+}
+
+void fstp_m80(Operands *ops) {
+	fpu_enter(ops, false);
+	write_m80(op_src->addr, fpu_get(0));
+	fpu_pop();
+	print_asm("fstpt %s", OP_STR(op_src));
+}
+
+/* Round `v' to an integer within [min, max] by the rounding control, or
+ * toward zero for fisttp. Beyond that the result is the integer
+ * indefinite, which is `min'.
+ */
+static int64_t to_int(long double v, int64_t min, int64_t max, bool trunc) {
+	fpu_host_begin();
+	fpu_barrier(v);
+	long double r = (trunc ? truncl(v) : rintl(v));
+	fpu_barrier(r);
+	fpu_host_end();
+	cpu.fpu.sw &= ~FPU_C1;
+	if(!(r >= min && r <= max)) {
+		cpu.fpu.sw |= FPU_IE;
+		return min;
+	}
+	if(r != v) { cpu.fpu.sw |= FPU_PE; }
+	return r;
+}
+
+static void fist(Operands *ops, int size, bool trunc) {
+	static const int64_t max[] = { [2] = INT16_MAX, [4] = INT32_MAX, [8] = INT64_MAX };
+	fpu_enter(ops, false);
+	int64_t val = to_int(fpu_get(0), -max[size] - 1, max[size], trunc);
+	if(size == 8) { fpu_write_q(op_src->addr, val); }
+	else { swaddr_write(op_src->addr, size, val); }
+}
+
+void fist_m16(Operands *ops) {
+	fist(ops, 2, false);
+	bool pop = st_pop(ops);
+	if(pop) { fpu_pop(); }
+	print_asm("fist%ss %s", (pop ? "p" : ""), OP_STR(op_src));
+}
+
+void fist_m32(Operands *ops) {
+	fist(ops, 4, false);
+	bool pop = st_pop(ops);
+	if(pop) { fpu_pop(); }
+	print_asm("fist%sl %s", (pop ? "p" : ""), OP_STR(op_src));
+}
+
+/* df /7, which always pops */
+void fist_m64(Operands *ops) {
+	fist(ops, 8, false);
+	fpu_pop();
+	print_asm("fistpll %s", OP_STR(op_src));
+}
+
+void fisttp_m16(Operands *ops) {
+	fist(ops, 2, true);
+	fpu_pop();
+	print_asm("fisttps %s", OP_STR(op_src));
+}
+
+void fisttp_m32(Operands *ops) {
+	fist(ops, 4, true);
+	fpu_pop();
+	print_asm("fisttpl %s", OP_STR(op_src));
+}
+
+void fisttp_m64(Operands *ops) {
+	fist(ops, 8, true);
+	fpu_pop();
+	print_asm("fisttpll %s", OP_STR(op_src));
+}
+
+void fbstp(Operands *ops) {
+	fpu_enter(ops, false);
+	long double v = fpu_get(0);
+	fpu_host_begin();
+	fpu_barrier(v);
+	long double r = rintl(v);
+	fpu_barrier(r);
+	fpu_host_end();
+	cpu.fpu.sw &= ~FPU_C1;
+
+	uint8_t buf[10] = { 0 };
+	if(!(fabsl(r) < 1e18L)) {
+		/* the packed BCD indefinite */
+		cpu.fpu.sw |= FPU_IE;
+		buf[7] = 0xc0;
+		buf[8] = buf[9] = 0xff;
+	}
+	else {
+		if(r != v) { cpu.fpu.sw |= FPU_PE; }
+		uint64_t n = fabsl(r);
+		int i;
+		for(i = 0; i < 9; i ++, n /= 100) {
+			buf[i] = ((n / 10 % 10) << 4) | (n % 10);
+		}
+		buf[9] = (signbit(r) ? 0x80 : 0);
+	}
+	int i;
+	for(i = 0; i < 10; i ++) {
+		swaddr_write(op_src->addr + i, 1, buf[i]);
+	}
+	fpu_pop();
+	print_asm("fbstp %s", OP_STR(op_src));
+}
+
+/* d9 /0 */
+void fld_sti(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	fpu_push(fpu_get(i));
+	print_asm("fld %%st(%d)", i);
+}
+
+void fst_sti(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	cpu.fpu.sw &= ~FPU_C1;
+	fpu_set(i, fpu_get(0));
+	bool pop = st_pop(ops);
+	if(pop) { fpu_pop(); }
+	print_asm("fst%s %%st(%d)", (pop ? "p" : ""), i);
+}
+
+void fxch(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	long double a = fpu_get(0), b = fpu_get(i);
+	cpu.fpu.sw &= ~FPU_C1;
+	fpu_set(0, b);
+	fpu_set(i, a);
+	print_asm("fxch %%st(%d)", i);
+}
+
+/* dd /0 ffree, df /0 ffreep */
+void ffree(Operands *ops) {
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	fpu_set_tag(i, FPU_TAG_EMPTY);
+	bool pop = (ops->opcode == 0xdf);
+	if(pop) { fpu_pop(); }
+	print_asm("ffree%s %%st(%d)", (pop ? "p" : ""), i);
+}
+
+/* d9 e8 - ee */
+void fconst(Operands *ops) {
+	static const long double val[] = {
+		1.0L, 3.321928094887362347870319429489390175L, 1.442695040888963407359924681001892137L,
+		3.141592653589793238462643383279502884L, 0.301029995663981195213738894724493027L,
+		0.693147180559945309417232121458176568L, 0.0L
+	};
+	fpu_enter(ops, false);
+	int i = fpu_modrm_rm(ops);
+	fpu_push(val[i]);
+
+#ifdef DEBUG
+	static const char *name[] = { "1", "l2t", "l2e", "pi", "lg2", "ln2", "z" };
+	print_asm("fld%s", name[i]);
+#endif
+}
+
+void fldcw(Operands *ops) {
+	fpu_enter(ops, true);
+	/* bit 6 always reads as 1 */
+	cpu.fpu.cw = (swaddr_read(op_src->addr, 2) & 0x1f7f) | 0x40;
+	print_asm("fldcw %s", OP_STR(op_src));
+}
+
+void fnstcw(Operands *ops) {
+	fpu_enter(ops, true);
+	swaddr_write(op_src->addr, 2, cpu.fpu.cw);
+	print_asm("fnstcw %s", OP_STR(op_src));
+}
+
+void fnstsw(Operands *ops) {
+	fpu_enter(ops, true);
+	swaddr_write(op_src->addr, 2, fpu_status());
+	print_asm("fnstsw %s", OP_STR(op_src));
+}
+
+/* df e0 */
+void fnstsw_ax(Operands *ops) {
+	fpu_enter(ops, true);
+	reg_w(R_AX) = fpu_status();
+	print_asm("fnstsw %%ax");
+}
+
+/* d9 d0 fnop, and db e0 - e4 */
+void fnctl(Operands *ops) {
+	fpu_enter(ops, ops->opcode == 0xdb);
+	switch(op_src2->imm) {
+		case 0xe2:
+			cpu.fpu.sw &= ~(FPU_B | FPU_ES | FPU_SF | FPU_EXCEPTIONS);
+			print_asm("fnclex");
+			break;
+		case 0xe3:
+			fpu_init();
+			print_asm("fninit");
+			break;
+		default:
+			/* fnop, and fneni, fndisi and fnsetpm of the older FPUs */
+			print_asm("fnop");
+			break;
+	}
+}
+
+/* the 28-byte environment of the 32-bit protected mode */
+static void load_env(swaddr_t addr) {
+	cpu.fpu.cw = (swaddr_read(addr, 2) & 0x1f7f) | 0x40;
+	uint16_t sw = swaddr_read(addr + 4, 2);
+	cpu.fpu.sw = sw & ~(FPU_ES | FPU_B | 0x3800);
+	cpu.fpu.top = (sw >> 11) & 0x7;
+	uint16_t tw = swaddr_read(addr + 8, 2);
+	int i;
+	cpu.fpu.tw = 0;
+	for(i = 0; i < 8; i ++) {
+		if(((tw >> (i * 2)) & 0x3) == FPU_TAG_EMPTY) { cpu.fpu.tw |= FPU_TAG_EMPTY << (i * 2); }
+	}
+	cpu.fpu.fip = swaddr_read(addr + 12, 4);
+	cpu.fpu.fop = (swaddr_read(addr + 16, 4) >> 16) & 0x7ff;
+	cpu.fpu.fdp = swaddr_read(addr + 20, 4);
+}
+
+static void store_env(swaddr_t addr) {
+	swaddr_write(addr, 4, 0xffff0000 | cpu.fpu.cw);
+	swaddr_write(addr + 4, 4, 0xffff0000 | fpu_status());
+	swaddr_write(addr + 8, 4, 0xffff0000 | fpu_tag_word());
+	swaddr_write(addr + 12, 4, cpu.fpu.fip);
+	swaddr_write(addr + 16, 4, (cpu.fpu.fop << 16) | cpu.cs.selector);
+	swaddr_write(addr + 20, 4, cpu.fpu.fdp);
+	swaddr_write(addr + 24, 4, 0xffff0000 | cpu.ds.selector);
+}
+
+void fldenv(Operands *ops) {
+	fpu_enter(ops, true);
+	load_env(op_src->addr);
+	print_asm("fldenv %s", OP_STR(op_src));
+}
+
+void fnstenv(Operands *ops) {
+	fpu_enter(ops, true);
+	store_env(op_src->addr);
+	/* fnstenv masks all exceptions */
+	cpu.fpu.cw |= FPU_EXCEPTIONS;
+	print_asm("fnstenv %s", OP_STR(op_src));
+}
+
+/* the environment and then ST(0) - ST(7) */
+void frstor(Operands *ops) {
+	fpu_enter(ops, true);
+	load_env(op_src->addr);
+	int i;
+	for(i = 0; i < 8; i ++) {
+		cpu.fpu.st[fpu_phys(i)] = read_m80(op_src->addr + 28 + i * 10);
+	}
+	print_asm("frstor %s", OP_STR(op_src));
+}
+
+void fnsave(Operands *ops) {
+	fpu_enter(ops, true);
+	store_env(op_src->addr);
+	int i;
+	for(i = 0; i < 8; i ++) {
+		write_m80(op_src->addr + 28 + i * 10, cpu.fpu.st[fpu_phys(i)]);
+	}
+	fpu_init();
+	print_asm("fnsave %s", OP_STR(op_src));
+}
@@ -0,0 +1,130 @@
+#ifndef __FPU_OP_H__
+#define __FPU_OP_H__
+
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+#include "cpu/fpu.h"
+#include "cpu/intr.h"
+
+/* The escape helpers in fpu.c decode an x87 instruction like idex(), and
+ * leave the ModR/M byte in `src2' and the address of a memory operand in
+ * `src' for the execute functions below. Operands wider than 4 bytes are
+ * read and written by the execute function itself.
+ */
+
+#define fpu_modrm_reg(ops) ((op_src2->imm >> 3) & 0x7)
+#define fpu_modrm_rm(ops) (op_src2->imm & 0x7)
+
+/* The compiler knows nothing of the host FPU state. Converting to or from
+ * `x' stays between fpu_host_begin() and this barrier, or this barrier
+ * and fpu_host_end().
+ */
+#define fpu_barrier(x) asm volatile ("" : "+m" (x))
+
+/* the real indefinite, which a masked invalid operation produces */
+#define FPU_INDEFINITE (-__builtin_nanl(""))
+
+static inline void fpu_stack_fault(bool overflow) {
+	cpu.fpu.sw = (cpu.fpu.sw & ~FPU_C1) | FPU_IE | FPU_SF | (overflow ? FPU_C1 : 0);
+}
+
+static inline long double fpu_get(int i) {
+	if(fpu_empty(i)) {
+		fpu_stack_fault(false);
+		return FPU_INDEFINITE;
+	}
+	return cpu.fpu.st[fpu_phys(i)];
+}
+
+static inline void fpu_set(int i, long double v) {
+	cpu.fpu.st[fpu_phys(i)] = v;
+	fpu_set_tag(i, 0);
+}
+
+static inline void fpu_push(long double v) {
+	cpu.fpu.top = (cpu.fpu.top - 1) & 0x7;
+	if(!fpu_empty(0)) {
+		fpu_stack_fault(true);
+		v = FPU_INDEFINITE;
+	}
+	fpu_set(0, v);
+}
+
+static inline void fpu_pop() {
+	fpu_set_tag(0, FPU_TAG_EMPTY);
+	cpu.fpu.top = (cpu.fpu.top + 1) & 0x7;
+}
+
+/* Every x87 instruction starts here. The control instructions neither
+ * take a pending exception nor become the last instruction of fnstenv.
+ */
+static inline void fpu_enter(Operands *ops, bool control) {
+	if(cpu.cr0.emulation || cpu.cr0.task_switched) { raise_intr(7); }
+	if(control) { return; }
+	if(fpu_status() & FPU_ES) { raise_intr(16); }
+
+	cpu.fpu.fip = cpu.eip;
+	cpu.fpu.fop = ((ops->opcode & 0x7) << 8) | op_src2->imm;
+	if((op_src2->imm >> 6) != 3) { cpu.fpu.fdp = op_src->addr; }
+}
+
+static inline uint64_t fpu_read_q(swaddr_t addr) {
+	return swaddr_read(addr, 4) | ((uint64_t)swaddr_read(addr + 4, 4) << 32);
+}
+
+static inline void fpu_write_q(swaddr_t addr, uint64_t val) {
+	swaddr_write(addr, 4, val);
+	swaddr_write(addr + 4, 4, val >> 32);
+}
+
+/* the execute functions of the opcode tables in fpu.c */
+
+/* fldst.c */
+void fld_m32(Operands *);
+void fld_m64(Operands *);
+void fld_m80(Operands *);
+void fild_m16(Operands *);
+void fild_m32(Operands *);
+void fild_m64(Operands *);
+void fbld(Operands *);
+void fst_m32(Operands *);
+void fst_m64(Operands *);
+void fstp_m80(Operands *);
+void fist_m16(Operands *);
+void fist_m32(Operands *);
+void fist_m64(Operands *);
+void fisttp_m16(Operands *);
+void fisttp_m32(Operands *);
+void fisttp_m64(Operands *);
+void fbstp(Operands *);
+void fld_sti(Operands *);
+void fst_sti(Operands *);
+void fxch(Operands *);
+void ffree(Operands *);
+void fconst(Operands *);
+void fldcw(Operands *);
+void fnstcw(Operands *);
+void fnstsw(Operands *);
+void fnstsw_ax(Operands *);
+void fnctl(Operands *);
+void fldenv(Operands *);
+void fnstenv(Operands *);
+void frstor(Operands *);
+void fnsave(Operands *);
+
+/* farith.c */
+void farith_m32(Operands *);
+void farith_m64(Operands *);
+void fiarith_m16(Operands *);
+void fiarith_m32(Operands *);
+void farith_st0(Operands *);
+void farith_sti(Operands *);
+void fucom(Operands *);
+void fcompp(Operands *);
+void fcomi(Operands *);
+void fcmov(Operands *);
+void fd9_4(Operands *);
+void fd9_6(Operands *);
+void fd9_7(Operands *);
+
+#endif
@@ -0,0 +1,108 @@
+#include "fpu-op.h"
+
+make_helper(inv);
+
+/* An x87 instruction is picked by its escape, by whether ModR/M names a
+ * register or memory, and by the reg field of ModR/M. The memory forms
+ * give the size of their operand; the register forms give the mask of
+ * R/M values which are valid.
+ */
+typedef struct {
+	void (*execute) (Operands *);
+	uint8_t arg;
+} Fpu_entry;
+
+#define M(f, size) { f, size }
+#define R(f) { f, 0xff }
+#define R_ONLY(f, mask) { f, mask }
+#define NONE { NULL, 0 }
+
+static const Fpu_entry mem_table [8][8] = {
+/* d8 */	{ M(farith_m32, 4), M(farith_m32, 4), M(farith_m32, 4), M(farith_m32, 4),
+		  M(farith_m32, 4), M(farith_m32, 4), M(farith_m32, 4), M(farith_m32, 4) },
+/* d9 */	{ M(fld_m32, 4), NONE, M(fst_m32, 4), M(fst_m32, 4),
+		  M(fldenv, 4), M(fldcw, 2), M(fnstenv, 4), M(fnstcw, 2) },
+/* da */	{ M(fiarith_m32, 4), M(fiarith_m32, 4), M(fiarith_m32, 4), M(fiarith_m32, 4),
+		  M(fiarith_m32, 4), M(fiarith_m32, 4), M(fiarith_m32, 4), M(fiarith_m32, 4) },
+/* db */	{ M(fild_m32, 4), M(fisttp_m32, 4), M(fist_m32, 4), M(fist_m32, 4),
+		  NONE, M(fld_m80, 4), NONE, M(fstp_m80, 4) },
+/* dc */	{ M(farith_m64, 4), M(farith_m64, 4), M(farith_m64, 4), M(farith_m64, 4),
+		  M(farith_m64, 4), M(farith_m64, 4), M(farith_m64, 4), M(farith_m64, 4) },
+/* dd */	{ M(fld_m64, 4), M(fisttp_m64, 4), M(fst_m64, 4), M(fst_m64, 4),
+		  M(frstor, 4), NONE, M(fnsave, 4), M(fnstsw, 2) },
+/* de */	{ M(fiarith_m16, 2), M(fiarith_m16, 2), M(fiarith_m16, 2), M(fiarith_m16, 2),
+		  M(fiarith_m16, 2), M(fiarith_m16, 2), M(fiarith_m16, 2), M(fiarith_m16, 2) },
+/* df */	{ M(fild_m16, 2), M(fisttp_m16, 2), M(fist_m16, 2), M(fist_m16, 2),
+		  M(fbld, 4), M(fild_m64, 4), M(fbstp, 4), M(fist_m64, 4) },
+};
+
+/* The undocumented aliases (such as dd /1 for fxch) behave as on the
+ * Pentium.
+ */
+static const Fpu_entry reg_table [8][8] = {
+/* d8 */	{ R(farith_st0), R(farith_st0), R(farith_st0), R(farith_st0),
+		  R(farith_st0), R(farith_st0), R(farith_st0), R(farith_st0) },
+/* d9 */	{ R(fld_sti), R(fxch), R_ONLY(fnctl, 0x01), R(fst_sti),
+		  R_ONLY(fd9_4, 0x33), R_ONLY(fconst, 0x7f), R(fd9_6), R(fd9_7) },
+/* da */	{ R(fcmov), R(fcmov), R(fcmov), R(fcmov),
+		  NONE, R_ONLY(fcompp, 0x02), NONE, NONE },
+/* db */	{ R(fcmov), R(fcmov), R(fcmov), R(fcmov),
+		  R_ONLY(fnctl, 0x1f), R(fcomi), R(fcomi), NONE },
+/* dc */	{ R(farith_sti), R(farith_sti), R(farith_sti), R(farith_sti),
+		  R(farith_sti), R(farith_sti), R(farith_sti), R(farith_sti) },
+/* dd */	{ R(ffree), R(fxch), R(fst_sti), R(fst_sti),
+		  R(fucom), R(fucom), NONE, NONE },
+/* de */	{ R(farith_sti), R(farith_sti), R(farith_sti), R_ONLY(fcompp, 0x02),
+		  R(farith_sti), R(farith_sti), R(farith_sti), R(farith_sti) },
+/* df */	{ R(ffree), R(fxch), R(fst_sti), R(fst_sti),
+		  R_ONLY(fnstsw_ax, 0x01), R(fcomi), R(fcomi), NONE },
+};
+
+/* `eip' points to the escape */
+static int fpu_esc(swaddr_t eip, Operands *ops, int esc) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+
+	const Fpu_entry *e;
+	if(m.mod == 3) {
+		e = &reg_table[esc][m.reg];
+		if(!(e->arg & (1 << m.R_M))) { return inv(eip, ops); }
+	}
+	else {
+		e = &mem_table[esc][m.reg];
+		if(e->execute == NULL) { return inv(eip, ops); }
+	}
+
+	op_src2->type = OP_TYPE_IMM;
+	op_src2->imm = m.val;
+	op_dest->type = OP_TYPE_IMM;
+
+	int len = 1;
+	if(m.mod == 3) { op_src->type = OP_TYPE_IMM; }
+	else {
+		/* the execute function reads and writes the operand itself */
+		op_src->size = e->arg;
+		len = load_addr(eip + 1, &m, ops, op_src);
+	}
+
+	decode_cache_record(ops, e->execute);
+	e->execute(ops);
+	return len + 1;
+}
+
+make_helper(fpu_d8) { return fpu_esc(eip, ops, 0); }
+make_helper(fpu_d9) { return fpu_esc(eip, ops, 1); }
+make_helper(fpu_da) { return fpu_esc(eip, ops, 2); }
+make_helper(fpu_db) { return fpu_esc(eip, ops, 3); }
+make_helper(fpu_dc) { return fpu_esc(eip, ops, 4); }
+make_helper(fpu_dd) { return fpu_esc(eip, ops, 5); }
+make_helper(fpu_de) { return fpu_esc(eip, ops, 6); }
+make_helper(fpu_df) { return fpu_esc(eip, ops, 7); }
+
+/* 0x9b */
+make_helper(fwait) {
+	if(cpu.cr0.monitor_coprocessor && cpu.cr0.task_switched) { raise_intr(7); }
+	if(fpu_status() & FPU_ES) { raise_intr(16); }
+	print_asm("fwait");
+	return 1;
+}
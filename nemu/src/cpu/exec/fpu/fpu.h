@@ -0,0 +1,14 @@
+#ifndef __FPU_ESC_H__
+#define __FPU_ESC_H__
+
+make_helper(fpu_d8);
+make_helper(fpu_d9);
+make_helper(fpu_da);
+make_helper(fpu_db);
+make_helper(fpu_dc);
+make_helper(fpu_dd);
+make_helper(fpu_de);
+make_helper(fpu_df);
+make_helper(fwait);
+
+#endif
@@ -0,0 +1,18 @@
+#include "cpu/exec/template-start.h"
+
+make_helper(concat(in_i2a_, SUFFIX)) {
+	uint8_t port = instr_fetch(eip + 1, 1);
+	REG(R_EAX) = pio_read(port, DATA_BYTE);
+
+	print_asm("in" str(SUFFIX) " $0x%x,%%%s", port, REG_NAME(R_EAX));
+	return 2;
+}
+
+make_helper(concat(in_d2a_, SUFFIX)) {
+	REG(R_EAX) = pio_read(reg_w(R_DX), DATA_BYTE);
+
+	print_asm("in" str(SUFFIX) " (%%dx),%%%s", REG_NAME(R_EAX));
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
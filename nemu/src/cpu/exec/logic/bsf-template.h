@@ -0,0 +1,36 @@
+#include "cpu/exec/template-start.h"
+
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+
+/* bsf and bsr set ZF for a zero source, and leave the destination */
+
+#define instr bsf
+
+static void do_execute(Operands *ops) {
+	DATA_TYPE src = op_src->val;
+	eflags_sync();
+	cpu.eflags.ZF = (src == 0);
+	if(src != 0) { OPERAND_W(op_dest, __builtin_ctz(src)); }
+	print_asm_template2();
+}
+
+make_instr_helper(rm2r)
+
+#undef instr
+#define instr bsr
+
+static void do_execute(Operands *ops) {
+	DATA_TYPE src = op_src->val;
+	eflags_sync();
+	cpu.eflags.ZF = (src == 0);
+	if(src != 0) { OPERAND_W(op_dest, 31 - __builtin_clz(src)); }
+	print_asm_template2();
+}
+
+make_instr_helper(rm2r)
+
+#undef instr
+
+#endif
+
+#include "cpu/exec/template-end.h"
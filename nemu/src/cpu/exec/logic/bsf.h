@@ -0,0 +1,7 @@
+#ifndef __BSF_H__
+#define __BSF_H__
+
+make_helper(bsf_rm2r_v);
+make_helper(bsr_rm2r_v);
+
+#endif
@@ -0,0 +1,92 @@
+#include "cpu/exec/template-start.h"
+
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+
+#define BITS (DATA_BYTE << 3)
+#define BITS_LOG (DATA_BYTE == 2 ? 4 : 5)
+
+/* Find the bit `op_src' of the bit string at `op_dest'. An offset in a
+ * register is signed and may select another word in memory than the
+ * decoded one; an immediate offset stays in the operand.
+ */
+static inline uint32_t concat(bit_locate_, SUFFIX) (Operands *ops, Operand *op) {
+	*op = *op_dest;
+	if(op_src->type == OP_TYPE_REG && op->type == OP_TYPE_MEM) {
+		op->addr += ((DATA_TYPE_S)op_src->val >> BITS_LOG) * DATA_BYTE;
+		op->val = MEM_R(op->addr);
+	}
+	return op_src->val & (BITS - 1);
+}
+
+#define bit_locate concat(bit_locate_, SUFFIX)
+
+/* bt, bts, btr and btc copy the bit to CF, then leave, set, reset or
+ * complement it.
+ */
+
+#define instr bt
+
+static void do_execute(Operands *ops) {
+	Operand op;
+	uint32_t bit = bit_locate(ops, &op);
+	eflags_sync();
+	cpu.eflags.CF = (op.val >> bit) & 1;
+	print_asm_template2();
+}
+
+make_instr_helper(r2rm)
+make_instr_helper(si2rm)
+
+#undef instr
+#define instr bts
+
+static void do_execute(Operands *ops) {
+	Operand op;
+	uint32_t bit = bit_locate(ops, &op);
+	eflags_sync();
+	cpu.eflags.CF = (op.val >> bit) & 1;
+	OPERAND_W(&op, op.val | (1u << bit));
+	print_asm_template2();
+}
+
+make_instr_helper(r2rm)
+make_instr_helper(si2rm)
+
+#undef instr
+#define instr btr
+
+static void do_execute(Operands *ops) {
+	Operand op;
+	uint32_t bit = bit_locate(ops, &op);
+	eflags_sync();
+	cpu.eflags.CF = (op.val >> bit) & 1;
+	OPERAND_W(&op, op.val & ~(1u << bit));
+	print_asm_template2();
+}
+
+make_instr_helper(r2rm)
+make_instr_helper(si2rm)
+
+#undef instr
+#define instr btc
+
+static void do_execute(Operands *ops) {
+	Operand op;
+	uint32_t bit = bit_locate(ops, &op);
+	eflags_sync();
+	cpu.eflags.CF = (op.val >> bit) & 1;
+	OPERAND_W(&op, op.val ^ (1u << bit));
+	print_asm_template2();
+}
+
+make_instr_helper(r2rm)
+make_instr_helper(si2rm)
+
+#undef instr
+#undef bit_locate
+#undef BITS
+#undef BITS_LOG
+
+#endif
+
+#include "cpu/exec/template-end.h"
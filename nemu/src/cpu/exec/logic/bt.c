@@ -0,0 +1,20 @@
+#include "cpu/exec/helper.h"
+
+#define DATA_BYTE 2
+#include "bt-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 4
+#include "bt-template.h"
+#undef DATA_BYTE
+
+/* for instruction encoding overloading */
+
+make_helper_v(bt_r2rm)
+make_helper_v(bt_si2rm)
+make_helper_v(bts_r2rm)
+make_helper_v(bts_si2rm)
+make_helper_v(btr_r2rm)
+make_helper_v(btr_si2rm)
+make_helper_v(btc_r2rm)
+make_helper_v(btc_si2rm)
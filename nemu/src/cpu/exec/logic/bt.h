@@ -0,0 +1,13 @@
+#ifndef __BT_H__
+#define __BT_H__
+
+make_helper(bt_r2rm_v);
+make_helper(bt_si2rm_v);
+make_helper(bts_r2rm_v);
+make_helper(bts_si2rm_v);
+make_helper(btr_r2rm_v);
+make_helper(btr_si2rm_v);
+make_helper(btc_r2rm_v);
+make_helper(btc_si2rm_v);
+
+#endif
@@ -2,11 +2,9 @@
 
 #define instr cmp
 
-static void do_execute(){
+static void do_execute(Operands *ops){
 	DATA_TYPE result = op_dest->val - op_src->val;
-	update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-	cpu.eflags.CF = result > op_dest->val;
-	cpu.eflags.OF = MSB((op_dest->val ^ op_src->val) & (op_dest->val ^result));
+	set_lazy_flags(LF_SUB, DATA_BYTE, op_dest->val, op_src->val, result);
 	print_asm_template2();
 }
 
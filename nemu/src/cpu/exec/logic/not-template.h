@@ -2,7 +2,7 @@
 
 #define instr not
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = ~op_src->val;
 	OPERAND_W(op_src, result);
 	print_asm_template1();
@@ -0,0 +1,110 @@
+#include "cpu/exec/template-start.h"
+
+#define BITS (DATA_BYTE << 3)
+
+/* Rotates change only CF and OF, and neither if the count is 0. OF is
+ * defined only for a count of 1.
+ */
+
+#define instr rol
+
+static void do_execute(Operands *ops) {
+	DATA_TYPE dest = op_dest->val;
+	uint8_t count = op_src->val & 0x1f;
+	uint8_t n = count % BITS;
+	if(n != 0) { dest = (dest << n) | (dest >> (BITS - n)); }
+	OPERAND_W(op_dest, dest);
+
+	if(count != 0) {
+		eflags_sync();
+		cpu.eflags.CF = dest & 1;
+		cpu.eflags.OF = MSB(dest) ^ cpu.eflags.CF;
+	}
+
+	print_asm_template2();
+}
+
+make_instr_helper(rm_1)
+make_instr_helper(rm_cl)
+make_instr_helper(rm_imm)
+
+#undef instr
+#define instr ror
+
+static void do_execute(Operands *ops) {
+	DATA_TYPE dest = op_dest->val;
+	uint8_t count = op_src->val & 0x1f;
+	uint8_t n = count % BITS;
+	if(n != 0) { dest = (dest >> n) | (dest << (BITS - n)); }
+	OPERAND_W(op_dest, dest);
+
+	if(count != 0) {
+		eflags_sync();
+		cpu.eflags.CF = MSB(dest);
+		cpu.eflags.OF = MSB(dest) ^ MSB(dest << 1);
+	}
+
+	print_asm_template2();
+}
+
+make_instr_helper(rm_1)
+make_instr_helper(rm_cl)
+make_instr_helper(rm_imm)
+
+#undef instr
+#define instr rcl
+
+/* rcl and rcr rotate the operand together with CF */
+static void do_execute(Operands *ops) {
+	DATA_TYPE dest = op_dest->val;
+	uint8_t count = op_src->val & 0x1f;
+	uint8_t n = count % (BITS + 1);
+
+	if(count != 0) {
+		eflags_sync();
+		for(; n != 0; n --) {
+			uint32_t cf = MSB(dest);
+			dest = (dest << 1) | cpu.eflags.CF;
+			cpu.eflags.CF = cf;
+		}
+		cpu.eflags.OF = MSB(dest) ^ cpu.eflags.CF;
+	}
+	OPERAND_W(op_dest, dest);
+
+	print_asm_template2();
+}
+
+make_instr_helper(rm_1)
+make_instr_helper(rm_cl)
+make_instr_helper(rm_imm)
+
+#undef instr
+#define instr rcr
+
+static void do_execute(Operands *ops) {
+	DATA_TYPE dest = op_dest->val;
+	uint8_t count = op_src->val & 0x1f;
+	uint8_t n = count % (BITS + 1);
+
+	if(count != 0) {
+		eflags_sync();
+		cpu.eflags.OF = MSB(dest) ^ cpu.eflags.CF;
+		for(; n != 0; n --) {
+			uint32_t cf = dest & 1;
+			dest = (dest >> 1) | ((DATA_TYPE)cpu.eflags.CF << (BITS - 1));
+			cpu.eflags.CF = cf;
+		}
+	}
+	OPERAND_W(op_dest, dest);
+
+	print_asm_template2();
+}
+
+make_instr_helper(rm_1)
+make_instr_helper(rm_cl)
+make_instr_helper(rm_imm)
+
+#undef instr
+#undef BITS
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,28 @@
+#include "cpu/exec/helper.h"
+
+#define DATA_BYTE 1
+#include "rotate-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 2
+#include "rotate-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 4
+#include "rotate-template.h"
+#undef DATA_BYTE
+
+/* for instruction encoding overloading */
+
+make_helper_v(rol_rm_1)
+make_helper_v(rol_rm_cl)
+make_helper_v(rol_rm_imm)
+make_helper_v(ror_rm_1)
+make_helper_v(ror_rm_cl)
+make_helper_v(ror_rm_imm)
+make_helper_v(rcl_rm_1)
+make_helper_v(rcl_rm_cl)
+make_helper_v(rcl_rm_imm)
+make_helper_v(rcr_rm_1)
+make_helper_v(rcr_rm_cl)
+make_helper_v(rcr_rm_imm)
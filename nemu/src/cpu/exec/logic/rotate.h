@@ -0,0 +1,32 @@
+#ifndef __ROTATE_H__
+#define __ROTATE_H__
+
+make_helper(rol_rm_1_b);
+make_helper(rol_rm_cl_b);
+make_helper(rol_rm_imm_b);
+make_helper(rol_rm_1_v);
+make_helper(rol_rm_cl_v);
+make_helper(rol_rm_imm_v);
+
+make_helper(ror_rm_1_b);
+make_helper(ror_rm_cl_b);
+make_helper(ror_rm_imm_b);
+make_helper(ror_rm_1_v);
+make_helper(ror_rm_cl_v);
+make_helper(ror_rm_imm_v);
+
+make_helper(rcl_rm_1_b);
+make_helper(rcl_rm_cl_b);
+make_helper(rcl_rm_imm_b);
+make_helper(rcl_rm_1_v);
+make_helper(rcl_rm_cl_v);
+make_helper(rcl_rm_imm_v);
+
+make_helper(rcr_rm_1_b);
+make_helper(rcr_rm_cl_b);
+make_helper(rcr_rm_imm_b);
+make_helper(rcr_rm_1_v);
+make_helper(rcr_rm_cl_v);
+make_helper(rcr_rm_imm_v);
+
+#endif
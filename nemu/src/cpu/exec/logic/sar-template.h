@@ -2,7 +2,7 @@
 
 #define instr sar
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE src = op_src->val;
 	DATA_TYPE_S dest = op_dest->val;
 
@@ -10,7 +10,7 @@ static void do_execute () {
 	dest >>= count;
 	OPERAND_W(op_dest, dest);
 
-	update_eflags_pf_zf_sf(dest);
+	if(count != 0) { set_lazy_flags(LF_SAR, DATA_BYTE, op_dest->val, count, dest); }
 
 	print_asm_template2();
 }
@@ -5,7 +5,12 @@
 #include "setcc/sete.h"
 #include "setcc/setg.h"
 #include "setcc/setge.h"
+#include "setcc/setl.h"
+#include "setcc/setle.h"
 #include "setcc/setne.h"
+#include "setcc/setno.h"
+#include "setcc/setnp.h"
+#include "setcc/setns.h"
 #include "setcc/seto.h"
 #include "setcc/setp.h"
 #include "setcc/sets.h"
\ No newline at end of file
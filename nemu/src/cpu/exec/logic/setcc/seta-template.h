@@ -2,8 +2,8 @@
 
 #define instr seta
 
-static void do_execute() {
-	if (cpu.eflags.CF == 0 && cpu.eflags.ZF == 0) OPERAND_W(op_src, 1);
+static void do_execute(Operands *ops) {
+	if (eflags_CF() == 0 && eflags_ZF() == 0) OPERAND_W(op_src, 1);
 	else OPERAND_W(op_src, 0);
 	print_asm_template1();
 }
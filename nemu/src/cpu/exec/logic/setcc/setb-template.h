@@ -2,8 +2,8 @@
 
 #define instr setb
 
-static void do_execute() {
-	if (cpu.eflags.CF == 1) OPERAND_W(op_src, 1);
+static void do_execute(Operands *ops) {
+	if (eflags_CF() == 1) OPERAND_W(op_src, 1);
 	else OPERAND_W(op_src, 0);
 	print_asm_template1();
 }
@@ -2,8 +2,8 @@
 
 #define instr setg
 
-static void do_execute() {
-	if (cpu.eflags.ZF == 0 || cpu.eflags.SF == cpu.eflags.OF) OPERAND_W(op_src, 1);
+static void do_execute(Operands *ops) {
+	if (eflags_ZF() == 0 && eflags_SF() == eflags_OF()) OPERAND_W(op_src, 1);
 	else OPERAND_W(op_src, 0);
 	print_asm_template1();
 }
@@ -0,0 +1,6 @@
+#ifndef __SETL_H__
+#define __SETL_H__
+
+make_helper(setl_rm_b);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef __SETLE_H__
+#define __SETLE_H__
+
+make_helper(setle_rm_b);
+
+#endif
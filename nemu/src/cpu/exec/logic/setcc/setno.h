@@ -0,0 +1,6 @@
+#ifndef __SETNO_H__
+#define __SETNO_H__
+
+make_helper(setno_rm_b);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef __SETNP_H__
+#define __SETNP_H__
+
+make_helper(setnp_rm_b);
+
+#endif
@@ -0,0 +1,8 @@
+#include "cpu/exec/helper.h"
+
+#define DATA_BYTE 1
+#include "setns-template.h"
+#undef DATA_BYTE
+
+/* for instruction encoding overloading */
+
@@ -0,0 +1,6 @@
+#ifndef __SETNS_H__
+#define __SETNS_H__
+
+make_helper(setns_rm_b);
+
+#endif
@@ -0,0 +1,25 @@
+#include "cpu/exec/template-start.h"
+
+#define instr shld
+
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+/* shld shifts the bits of the register `op_dest' into `op_src2' from the right */
+static void do_execute(Operands *ops) {
+	DATA_TYPE in = op_dest->val;
+	DATA_TYPE out = op_src2->val;
+
+	uint8_t count = op_src->val & 0x1f;
+	if(count != 0) {
+		DATA_TYPE result = ((((uint64_t)out << (DATA_BYTE << 3)) | in) << count) >> (DATA_BYTE << 3);
+		OPERAND_W(op_src2, result);
+		set_lazy_flags(LF_SHL, DATA_BYTE, out, count, result);
+	}
+
+	print_asm("shld" str(SUFFIX) " %s,%s,%s", OP_STR(op_src), OP_STR(op_dest), OP_STR(op_src2));
+}
+
+make_instr_helper(si_rm2r)
+make_instr_helper(cl_rm2r)
+#endif
+
+#include "cpu/exec/template-end.h"
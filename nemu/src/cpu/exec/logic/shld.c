@@ -0,0 +1,14 @@
+#include "cpu/exec/helper.h"
+
+#define DATA_BYTE 2
+#include "shld-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 4
+#include "shld-template.h"
+#undef DATA_BYTE
+
+/* for instruction encoding overloading */
+
+make_helper_v(shld_si_rm2r)
+make_helper_v(shld_cl_rm2r)
@@ -0,0 +1,7 @@
+#ifndef __SHLD_H__
+#define __SHLD_H__
+
+make_helper(shld_si_rm2r_v);
+make_helper(shld_cl_rm2r_v);
+
+#endif
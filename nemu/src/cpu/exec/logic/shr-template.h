@@ -2,14 +2,14 @@
 
 #define instr shr
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE src = op_src->val;
 	DATA_TYPE dest = op_dest->val;
 
 	uint8_t count = src & 0x1f;
 	dest >>= count;
 	OPERAND_W(op_dest, dest);
-        update_eflags_pf_zf_sf(dest);
+	if(count != 0) { set_lazy_flags(LF_SHR, DATA_BYTE, op_dest->val, count, dest); }
 
 	print_asm_template2();
 }
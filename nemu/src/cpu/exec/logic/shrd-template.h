@@ -3,30 +3,23 @@
 #define instr shrd
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
-static void do_execute () {
+/* shrd shifts the bits of the register `op_dest' into `op_src2' from the left */
+static void do_execute(Operands *ops) {
 	DATA_TYPE in = op_dest->val;
 	DATA_TYPE out = op_src2->val;
 
-	uint8_t count = op_src->val;
-	count &= 0x1f;
-	while(count != 0) {
-		out >>= 1;
-		out |= (in & 1) << ((DATA_BYTE << 3) - 1);
-		in >>= 1;
-		count --;
+	uint8_t count = op_src->val & 0x1f;
+	if(count != 0) {
+		DATA_TYPE result = (((uint64_t)in << (DATA_BYTE << 3)) | out) >> count;
+		OPERAND_W(op_src2, result);
+		set_lazy_flags(LF_SHR, DATA_BYTE, out, count, result);
 	}
 
-	OPERAND_W(op_src2, out);
-
-	print_asm("shrd" str(SUFFIX) " %s,%s,%s", op_src->str, op_dest->str, op_src2->str);
+	print_asm("shrd" str(SUFFIX) " %s,%s,%s", OP_STR(op_src), OP_STR(op_dest), OP_STR(op_src2));
 }
 
-make_helper(concat(shrdi_, SUFFIX)) {
-	int len = concat(decode_si_rm2r_, SUFFIX) (eip + 1);  /* use decode_si_rm2r to read 1 byte immediate */
-	op_dest->val = REG(op_dest->reg);
-	do_execute();
-	return len + 1;
-}
+make_instr_helper(si_rm2r)
+make_instr_helper(cl_rm2r)
 #endif
 
 #include "cpu/exec/template-end.h"
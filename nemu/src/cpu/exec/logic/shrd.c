@@ -1,9 +1,5 @@
 #include "cpu/exec/helper.h"
 
-#define DATA_BYTE 1
-#include "shrd-template.h"
-#undef DATA_BYTE
-
 #define DATA_BYTE 2
 #include "shrd-template.h"
 #undef DATA_BYTE
@@ -13,4 +9,6 @@
 #undef DATA_BYTE
 
 /* for instruction encoding overloading */
-make_helper_v(shrdi)
+
+make_helper_v(shrd_si_rm2r)
+make_helper_v(shrd_cl_rm2r)
@@ -1,6 +1,7 @@
 #ifndef __SHRD_H__
 #define __SHRD_H__
 
-make_helper(shrdi_v);
+make_helper(shrd_si_rm2r_v);
+make_helper(shrd_cl_rm2r_v);
 
 #endif
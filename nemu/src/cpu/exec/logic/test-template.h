@@ -2,11 +2,9 @@
 
 #define instr test
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
     DATA_TYPE result = op_dest->val & op_src->val;
-    cpu.eflags.CF = 0;
-    cpu.eflags.OF = 0;
-    update_eflags_pf_zf_sf(result);
+    set_lazy_flags(LF_LOGIC, DATA_BYTE, op_dest->val, op_src->val, result);
     print_asm_template2();
 }
 
@@ -1,11 +1,92 @@
 #include "cpu/exec/helper.h"
 #include "cpu/decode/modrm.h"
+#include "cpu/decode/decode-cache.h"
+#include "cpu/eflags.h"
+#include "memory/tlb.h"
+#include "monitor/monitor.h"
 
 make_helper(nop) {
 	print_asm("nop");
 	return 1;
 }
 
+make_helper(cld) {
+	cpu.eflags.DF = 0;
+	print_asm("cld");
+	return 1;
+}
+
+make_helper(std) {
+	cpu.eflags.DF = 1;
+	print_asm("std");
+	return 1;
+}
+
+make_helper(clc) {
+	eflags_sync();
+	cpu.eflags.CF = 0;
+	print_asm("clc");
+	return 1;
+}
+
+make_helper(stc) {
+	eflags_sync();
+	cpu.eflags.CF = 1;
+	print_asm("stc");
+	return 1;
+}
+
+make_helper(cmc) {
+	eflags_sync();
+	cpu.eflags.CF = !cpu.eflags.CF;
+	print_asm("cmc");
+	return 1;
+}
+
+make_helper(cli) {
+	cpu.eflags.IF = 0;
+	print_asm("cli");
+	return 1;
+}
+
+make_helper(sti) {
+	cpu.eflags.IF = 1;
+	print_asm("sti");
+	return 1;
+}
+
+/* 0x9f */
+make_helper(lahf) {
+	eflags_sync();
+	reg_b(R_AH) = cpu.eflags.val;
+	print_asm("lahf");
+	return 1;
+}
+
+/* 0x9e: SF, ZF, AF, PF and CF come from AH */
+make_helper(sahf) {
+	eflags_sync();
+	cpu.eflags.val = (cpu.eflags.val & ~0xd5) | (reg_b(R_AH) & 0xd5);
+	print_asm("sahf");
+	return 1;
+}
+
+make_helper(hlt) {
+#ifdef HAS_DEVICE
+	if(cpu.eflags.IF) {
+		/* sleep until a device raises an interrupt */
+		extern void device_update();
+		while(!cpu.INTR) { device_update(); }
+		print_asm("hlt");
+		return 1;
+	}
+#endif
+	printf("\33[1;31mnemu: HALT\33[0m at eip = 0x%08x with interrupts disabled\n\n", cpu.eip);
+	nemu_state = END;
+	print_asm("hlt");
+	return 1;
+}
+
 make_helper(int3) {
 	void do_int3();
 	do_int3();
@@ -14,12 +95,145 @@ make_helper(int3) {
 	return 1;
 }
 
+static void do_lea(Operands *ops) {
+	if(ops->is_operand_size_16) {
+		reg_w(op_dest->reg) = op_src->addr;
+		print_asm("leaw %s,%%%s", OP_STR(op_src), regsw[op_dest->reg]);
+	}
+	else {
+		reg_l(op_dest->reg) = op_src->addr;
+		print_asm("leal %s,%%%s", OP_STR(op_src), regsl[op_dest->reg]);
+	}
+}
+
 make_helper(lea) {
 	ModR_M m;
 	m.val = instr_fetch(eip + 1, 1);
-	int len = load_addr(eip + 1, &m, op_src);
-	reg_l(m.reg) = op_src->addr;
+	/* only the address is used, so the operand has no size */
+	op_src->size = 0;
+	int len = load_addr(eip + 1, &m, ops, op_src);
+	op_dest->type = OP_TYPE_REG;
+	op_dest->size = (ops->is_operand_size_16 ? 2 : 4);
+	op_dest->reg = m.reg;
 
-	print_asm("leal %s,%%%s", op_src->str, regsl[m.reg]);
+	decode_cache_record(ops, do_lea);
+	do_lea(ops);
 	return 1 + len;
 }
+
+static uint32_t read_cr(int n) {
+	switch(n) {
+		case 0: return cpu.cr0.val;
+		case 2: return cpu.cr2;
+		case 3: return cpu.cr3.val;
+		case 4: return cpu.cr4.val;
+		default: panic("no control register cr%d", n);
+	}
+}
+
+/* Changing the translation drops every cached translation of it, and
+ * the decoded instructions which were looked up by linear address.
+ */
+static void write_cr(int n, uint32_t val) {
+	switch(n) {
+		case 0: cpu.cr0.val = val; tlb_flush(); break;
+		case 2: cpu.cr2 = val; return;
+		case 3: cpu.cr3.val = val; tlb_flush_nonglobal(); break;
+		case 4: cpu.cr4.val = val; tlb_flush(); break;
+		default: panic("no control register cr%d", n);
+	}
+	flush_decode_cache();
+}
+
+/* 0x0f 0x20 */
+make_helper(mov_cr2r) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	reg_l(m.R_M) = read_cr(m.reg);
+
+	print_asm("movl %%cr%d,%%%s", m.reg, regsl[m.R_M]);
+	return 2;
+}
+
+/* 0x0f 0x22 */
+make_helper(mov_r2cr) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	write_cr(m.reg, reg_l(m.R_M));
+
+	print_asm("movl %%%s,%%cr%d", regsl[m.R_M], m.reg);
+	return 2;
+}
+
+/* 0x0f 0x06 */
+make_helper(clts) {
+	write_cr(0, cpu.cr0.val & ~0x8);
+	print_asm("clts");
+	return 1;
+}
+
+/* The 6-byte operand of lgdt, lidt, sgdt and sidt is a 16-bit limit
+ * followed by a 32-bit base, of which a 16-bit operand size only
+ * keeps 24 bits.
+ */
+static int load_table(swaddr_t eip, Operands *ops, uint32_t *base, uint16_t *limit, const char *name) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	Assert(m.mod != 3, "the operand of %s must be in memory", name);
+	int len = load_addr(eip + 1, &m, ops, op_src);
+	*limit = swaddr_read(op_src->addr, 2);
+	*base = swaddr_read(op_src->addr + 2, 4) & (ops->is_operand_size_16 ? 0xffffff : 0xffffffff);
+
+	print_asm("%s %s", name, OP_STR(op_src));
+	return len + 1;
+}
+
+static int store_table(swaddr_t eip, Operands *ops, uint32_t base, uint16_t limit, const char *name) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	Assert(m.mod != 3, "the operand of %s must be in memory", name);
+	int len = load_addr(eip + 1, &m, ops, op_src);
+	swaddr_write(op_src->addr, 2, limit);
+	swaddr_write(op_src->addr + 2, 4, base & (ops->is_operand_size_16 ? 0xffffff : 0xffffffff));
+
+	print_asm("%s %s", name, OP_STR(op_src));
+	return len + 1;
+}
+
+/* 0x0f 0x01 /0 - /3 */
+make_helper(sgdt) { return store_table(eip, ops, cpu.gdtr.base, cpu.gdtr.limit, "sgdt"); }
+make_helper(sidt) { return store_table(eip, ops, cpu.idtr.base, cpu.idtr.limit, "sidt"); }
+make_helper(lgdt) { return load_table(eip, ops, &cpu.gdtr.base, &cpu.gdtr.limit, "lgdt"); }
+make_helper(lidt) { return load_table(eip, ops, &cpu.idtr.base, &cpu.idtr.limit, "lidt"); }
+
+/* 0x0f 0x01 /4 */
+make_helper(smsw) {
+	int len = decode_rm_w(eip + 1, ops);
+	write_operand_w(op_src, cpu.cr0.val);
+
+	print_asm("smsw %s", OP_STR(op_src));
+	return len + 1;
+}
+
+/* 0x0f 0x01 /6: only PE, MP, EM and TS, and PE can not be cleared */
+make_helper(lmsw) {
+	int len = decode_rm_w(eip + 1, ops);
+	uint32_t msw = (op_src->val & 0xf) | (cpu.cr0.val & 0x1);
+	write_cr(0, (cpu.cr0.val & ~0xf) | msw);
+
+	print_asm("lmsw %s", OP_STR(op_src));
+	return len + 1;
+}
+
+/* 0x0f 0x01 /7 */
+make_helper(invlpg) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	int len = load_addr(eip + 1, &m, ops, op_src);
+	/* the TLB keeps no record of which entry maps the page */
+	tlb_flush();
+	flush_decode_cache();
+
+	print_asm("invlpg %s", OP_STR(op_src));
+	return len + 1;
+}
@@ -2,7 +2,27 @@
 #define __MISC_H__
 
 make_helper(nop);
+make_helper(cld);
+make_helper(std);
+make_helper(clc);
+make_helper(stc);
+make_helper(cmc);
+make_helper(cli);
+make_helper(sti);
+make_helper(lahf);
+make_helper(sahf);
+make_helper(hlt);
 make_helper(int3);
 make_helper(lea);
+make_helper(mov_cr2r);
+make_helper(mov_r2cr);
+make_helper(clts);
+make_helper(sgdt);
+make_helper(sidt);
+make_helper(lgdt);
+make_helper(lidt);
+make_helper(smsw);
+make_helper(lmsw);
+make_helper(invlpg);
 
 #endif
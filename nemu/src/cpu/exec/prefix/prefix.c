@@ -1,10 +1,31 @@
 #include "cpu/exec/helper.h"
+#include "cpu/decode/decode-cache.h"
 
 make_helper(exec);
 
 make_helper(operand_size) {
-	ops_decoded.is_operand_size_16 = true;
-	int instr_len = exec(eip + 1);
-	ops_decoded.is_operand_size_16 = false;
-	return instr_len + 1;
+	ops->is_operand_size_16 = true;
+	return exec(eip + 1, ops) + 1;
+}
+
+/* 0x26 es, 0x2e cs, 0x36 ss, 0x3e ds, 0x64 fs and 0x65 gs. The segment
+ * is global state, which a decoded instruction does not remember, so
+ * the instruction is not kept in the decode cache.
+ */
+make_helper(seg_override) {
+	uint8_t opcode = instr_fetch(eip, 1);
+	decode_cache_forbid();
+	current_sreg = (opcode >= 0x64 ? R_FS + (opcode & 0x1) : (opcode >> 3) & 0x3);
+	int len = exec(eip + 1, ops) + 1;
+	current_sreg = R_DS;
+	return len;
+}
+
+/* 0xf0: there is only one processor to lock the bus against. The
+ * decoded record would start at the prefix rather than the opcode,
+ * which the block engine does not expect, so it is not cached either.
+ */
+make_helper(lock) {
+	decode_cache_forbid();
+	return exec(eip + 1, ops) + 1;
 }
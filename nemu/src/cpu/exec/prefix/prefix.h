@@ -2,5 +2,7 @@
 #define __PREFIX_H__
 
 make_helper(operand_size);
+make_helper(seg_override);
+make_helper(lock);
 
 #endif
@@ -1,5 +1,7 @@
 #include "cpu/exec/helper.h"
 #include "monitor/monitor.h"
+#include "monitor/trace.h"
+#include "memory/cache.h"
 
 make_helper(inv) {
 	/* invalid opcode */
@@ -35,6 +37,9 @@ make_helper(nemu_trap) {
 			printf("\33[1;31mnemu: HIT %s TRAP\33[0m at eip = 0x%08x\n\n",
 					(cpu.eax == 0 ? "GOOD" : "BAD"), cpu.eip);
 			nemu_state = END;
+			trace_dump();
+			/* leave the final memory image in DRAM */
+			if(mem_model == MEM_CACHE) { flush_cache(); }
 	}
 
 	return 1;
@@ -0,0 +1,19 @@
+#include "cpu/exec/template-start.h"
+
+#define instr cmps
+
+make_helper(concat(cmps_, SUFFIX)) {
+	DATA_TYPE dest = MEM_R(cpu.esi);
+	DATA_TYPE src = MEM_R(cpu.edi);
+	DATA_TYPE result = dest - src;
+
+	set_lazy_flags(LF_SUB, DATA_BYTE, dest, src, result);
+
+	cpu.esi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+	cpu.edi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+
+	print_asm("cmps" str(SUFFIX) " %%es:(%%edi),%%ds:(%%esi)");
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
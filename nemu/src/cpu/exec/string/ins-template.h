@@ -0,0 +1,11 @@
+#include "cpu/exec/template-start.h"
+
+make_helper(concat(ins_, SUFFIX)) {
+	MEM_W(cpu.edi, pio_read(reg_w(R_DX), DATA_BYTE));
+	cpu.edi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+
+	print_asm("ins" str(SUFFIX) " (%%dx),%%es:(%%edi)");
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
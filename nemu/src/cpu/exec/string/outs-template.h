@@ -0,0 +1,11 @@
+#include "cpu/exec/template-start.h"
+
+make_helper(concat(outs_, SUFFIX)) {
+	pio_write(reg_w(R_DX), DATA_BYTE, MEM_R(cpu.esi));
+	cpu.esi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+
+	print_asm("outs" str(SUFFIX) " %%ds:(%%esi),(%%dx)");
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
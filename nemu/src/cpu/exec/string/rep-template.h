@@ -0,0 +1,165 @@
+#include "cpu/exec/template-start.h"
+
+#define STEP (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE)
+
+/* How many of the next `n' elements from `addr' are in its page. */
+static inline uint32_t concat(page_elems_, SUFFIX) (swaddr_t addr, uint32_t n) {
+	uint32_t off = seg_translate(addr, DATA_BYTE, current_sreg) & 0xfff;
+	if(off + DATA_BYTE > 0x1000) { return 0; }
+	uint32_t k = (cpu.eflags.DF ? off / DATA_BYTE + 1 : (0x1000 - off) / DATA_BYTE);
+	return (k < n ? k : n);
+}
+
+/* The `n' elements from `addr' in host memory, lowest first. Element
+ * `i' in the order of execution is at index `i', or `n - 1 - i' when
+ * DF is set.
+ */
+static inline DATA_TYPE* concat(host_elems_, SUFFIX) (swaddr_t addr, uint32_t n, bool write) {
+	if(n == 0) { return NULL; }
+	if(cpu.eflags.DF) { addr -= (n - 1) * DATA_BYTE; }
+	return swaddr_host(addr, n * DATA_BYTE, write);
+}
+
+#define page_elems concat(page_elems_, SUFFIX)
+#define host_elems concat(host_elems_, SUFFIX)
+#define elem(p, n, i) ((p)[cpu.eflags.DF ? (n) - 1 - (i) : (i)])
+
+static int concat(rep_movs_, SUFFIX) () {
+	int count = 0;
+	while(cpu.ecx) {
+		uint32_t n = page_elems(cpu.edi, page_elems(cpu.esi, cpu.ecx));
+		DATA_TYPE *src = host_elems(cpu.esi, n, false);
+		DATA_TYPE *dest = (src != NULL ? host_elems(cpu.edi, n, true) : NULL);
+		uint32_t i;
+		if(dest == NULL) {
+			MEM_W(cpu.edi, MEM_R(cpu.esi));
+			n = 1;
+		}
+		else if(cpu.eflags.DF ? (dest < src && src < dest + n) : (src < dest && dest < src + n)) {
+			/* the elements are copied one after another, so that a
+			 * destination which overlaps the source repeats it
+			 */
+			for(i = 0; i < n; i ++) { elem(dest, n, i) = elem(src, n, i); }
+		}
+		else {
+			memmove(dest, src, n * DATA_BYTE);
+		}
+		cpu.esi += n * STEP;
+		cpu.edi += n * STEP;
+		cpu.ecx -= n;
+		count += n;
+	}
+
+	print_asm("movs" str(SUFFIX) " %%ds:(%%esi),%%es:(%%edi)");
+	return count;
+}
+
+static int concat(rep_stos_, SUFFIX) () {
+	int count = 0;
+	DATA_TYPE val = REG(R_EAX);
+	while(cpu.ecx) {
+		uint32_t n = page_elems(cpu.edi, cpu.ecx);
+		DATA_TYPE *dest = host_elems(cpu.edi, n, true);
+		if(dest == NULL) {
+			MEM_W(cpu.edi, val);
+			n = 1;
+		}
+		else {
+#if DATA_BYTE == 1
+			memset(dest, val, n);
+#else
+			uint32_t i;
+			for(i = 0; i < n; i ++) { dest[i] = val; }
+#endif
+		}
+		cpu.edi += n * STEP;
+		cpu.ecx -= n;
+		count += n;
+	}
+
+	print_asm("stos" str(SUFFIX) " %%%s,%%es:(%%edi)", REG_NAME(R_EAX));
+	return count;
+}
+
+/* `rep' and `repnz' go on with scas and cmps as long as ZF is `zf'. */
+static int concat(rep_scas_, SUFFIX) (bool zf) {
+	int count = 0;
+	DATA_TYPE dest = REG(R_EAX), src = 0;
+	while(cpu.ecx) {
+		uint32_t n = page_elems(cpu.edi, cpu.ecx);
+		DATA_TYPE *p = host_elems(cpu.edi, n, false);
+		uint32_t i;
+		if(p == NULL) {
+			src = MEM_R(cpu.edi);
+			i = 1;
+		}
+#if DATA_BYTE == 1
+		else if(!zf && !cpu.eflags.DF) {
+			/* repnz scasb, as in strlen() */
+			uint8_t *q = memchr(p, dest, n);
+			i = (q != NULL ? q - p + 1 : n);
+			src = p[i - 1];
+		}
+#endif
+		else {
+			for(i = 0; i < n; ) {
+				src = elem(p, n, i);
+				i ++;
+				if((src == dest) != zf) { break; }
+			}
+		}
+		set_lazy_flags(LF_SUB, DATA_BYTE, dest, src, (DATA_TYPE)(dest - src));
+		cpu.edi += i * STEP;
+		cpu.ecx -= i;
+		count += i;
+		if((src == dest) != zf) { break; }
+	}
+
+	print_asm("scas" str(SUFFIX) " %%es:(%%edi),%%%s", REG_NAME(R_EAX));
+	return count;
+}
+
+static int concat(rep_cmps_, SUFFIX) (bool zf) {
+	int count = 0;
+	DATA_TYPE dest = 0, src = 0;
+	while(cpu.ecx) {
+		uint32_t n = page_elems(cpu.edi, page_elems(cpu.esi, cpu.ecx));
+		DATA_TYPE *p = host_elems(cpu.esi, n, false);
+		DATA_TYPE *q = (p != NULL ? host_elems(cpu.edi, n, false) : NULL);
+		uint32_t i;
+		if(q == NULL) {
+			dest = MEM_R(cpu.esi);
+			src = MEM_R(cpu.edi);
+			i = 1;
+		}
+		else if(zf && memcmp(p, q, n * DATA_BYTE) == 0) {
+			/* repz cmps over equal elements, as in memcmp() */
+			i = n;
+			dest = src = elem(p, n, n - 1);
+		}
+		else {
+			for(i = 0; i < n; ) {
+				dest = elem(p, n, i);
+				src = elem(q, n, i);
+				i ++;
+				if((dest == src) != zf) { break; }
+			}
+		}
+		set_lazy_flags(LF_SUB, DATA_BYTE, dest, src, (DATA_TYPE)(dest - src));
+		cpu.esi += i * STEP;
+		cpu.edi += i * STEP;
+		cpu.ecx -= i;
+		count += i;
+		if((dest == src) != zf) { break; }
+	}
+
+	print_asm("cmps" str(SUFFIX) " %%es:(%%edi),%%ds:(%%esi)");
+	return count;
+}
+
+#undef STEP
+#undef page_elems
+#undef host_elems
+#undef elem
+
+#include "cpu/exec/template-end.h"
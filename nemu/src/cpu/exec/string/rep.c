@@ -1,73 +1,81 @@
 #include "cpu/exec/helper.h"
+#include "memory/memory.h"
 
 make_helper(exec);
+lnaddr_t seg_translate(swaddr_t, size_t, uint8_t);
 
-make_helper(rep) {
-	int len;
-	int count = 0;
-	if(instr_fetch(eip + 1, 1) == 0xc3) {
-		/* repz ret */
-		exec(eip + 1);
-		len = 0;
-	}
-	else {
-		while(cpu.ecx) {
-			exec(eip + 1);
-			count ++;
-			cpu.ecx --;
-			assert(ops_decoded.opcode == 0xa4	// movsb
-				|| ops_decoded.opcode == 0xa5	// movsw
-				|| ops_decoded.opcode == 0xaa	// stosb
-				|| ops_decoded.opcode == 0xab	// stosw
-				|| ops_decoded.opcode == 0xa6	// cmpsb
-				|| ops_decoded.opcode == 0xa7	// cmpsw
-				|| ops_decoded.opcode == 0xae	// scasb
-				|| ops_decoded.opcode == 0xaf	// scasw
-				);
+/* `rep' runs movs, stos, scas and cmps a page at a time on host memory.
+ * Only an element which crosses a page, or one outside RAM, is accessed
+ * through the MMU as the single instruction would.
+ */
 
-			/* TODO: Jump out of the while loop if necessary. */
-			/*if((ops_decoded.opcode == 0xa6	// cmpsb
-						|| ops_decoded.opcode == 0xa7	// cmpsw
-			   ) && !cpu.eflags.ZF) {
-				break;
-			}*/
+#define DATA_BYTE 1
+#include "rep-template.h"
+#undef DATA_BYTE
 
-		}
-		len = 1;
-	}
+#define DATA_BYTE 2
+#include "rep-template.h"
+#undef DATA_BYTE
 
-#ifdef DEBUG
-	char temp[80];
-	sprintf(temp, "rep %s", assembly);
-	sprintf(assembly, "%s[cnt = %d]", temp, count);
-#endif
-	
-	return len + 1;
-}
+#define DATA_BYTE 4
+#include "rep-template.h"
+#undef DATA_BYTE
 
-make_helper(repnz) {
-	int count = 0;
-	while(cpu.ecx) {
-		exec(eip + 1);
-		count ++;
-		cpu.ecx --;
-		assert(ops_decoded.opcode == 0xa6	// cmpsb
-				|| ops_decoded.opcode == 0xa7	// cmpsw
-				|| ops_decoded.opcode == 0xae	// scasb
-				|| ops_decoded.opcode == 0xaf	// scasw
-			  );
+#define rep_call(name, size, ...) \
+	((size) == 1 ? concat(name, _b)(__VA_ARGS__) : \
+	 (size) == 2 ? concat(name, _w)(__VA_ARGS__) : concat(name, _l)(__VA_ARGS__))
 
-		if(cpu.eflags.ZF) {
-			break;
-		}
+/* `zf' is the value of ZF with which scas and cmps go on. */
+static int rep_string(swaddr_t eip, Operands *ops, bool zf, const char *prefix) {
+	int count = 0;
+	int len = 1;
+	bool is_operand_size_16 = ops->is_operand_size_16;
+	uint32_t opcode = instr_fetch(eip + len, 1);
+	if(opcode == 0x66) {
+		is_operand_size_16 = true;
+		len ++;
+		opcode = instr_fetch(eip + len, 1);
+	}
+	int size = (opcode & 0x1 ? (is_operand_size_16 ? 2 : 4) : 1);
 
+	switch(opcode) {
+		case 0xa4: case 0xa5: count = rep_call(rep_movs, size); len ++; break;
+		case 0xaa: case 0xab: count = rep_call(rep_stos, size); len ++; break;
+		case 0xae: case 0xaf: count = rep_call(rep_scas, size, zf); len ++; break;
+		case 0xa6: case 0xa7: count = rep_call(rep_cmps, size, zf); len ++; break;
+		default:
+			len ++;
+			while(cpu.ecx) {
+				exec(eip + 1, ops);
+				count ++;
+				cpu.ecx --;
+				assert(ops->opcode == 0xac	// lodsb
+					|| ops->opcode == 0xad	// lodsw
+					|| (ops->opcode >= 0x6c && ops->opcode <= 0x6f)	// ins, outs
+					);
+			}
 	}
 
 #ifdef DEBUG
 	char temp[80];
-	sprintf(temp, "repnz %s", assembly);
+	sprintf(temp, "%s %s", prefix, assembly);
 	sprintf(assembly, "%s[cnt = %d]", temp, count);
 #endif
 
-	return 1 + 1;
+	return len;
+}
+
+make_helper(rep) {
+	decode_cache_forbid();
+	if(instr_fetch(eip + 1, 1) == 0xc3) {
+		/* repz ret */
+		exec(eip + 1, ops);
+		return 1;
+	}
+	return rep_string(eip, ops, true, "rep");
+}
+
+make_helper(repnz) {
+	decode_cache_forbid();
+	return rep_string(eip, ops, false, "repnz");
 }
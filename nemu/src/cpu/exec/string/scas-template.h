@@ -7,9 +7,7 @@ make_helper(concat(scas_, SUFFIX)) {
 	DATA_TYPE src = MEM_R(cpu.edi);;
 	DATA_TYPE result = dest - src;
 
-	update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-	cpu.eflags.CF = result > dest;
-	cpu.eflags.OF = MSB((dest ^ src) & (dest ^ result));
+	set_lazy_flags(LF_SUB, DATA_BYTE, dest, src, result);
 
 	cpu.edi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
 
@@ -0,0 +1,142 @@
+#include "nemu.h"
+#include "cpu/fpu.h"
+#include <math.h>
+
+/* The guest registers are kept as host `long double's, and the host FPU
+ * computes with them under the rounding and precision control of the
+ * guest. The exceptions it raises are those of the guest instruction,
+ * so they are read back into the status word of the guest.
+ */
+
+#if defined(__i386__) || defined(__x86_64__)
+
+static uint16_t host_cw = 0;
+
+void fpu_host_begin() {
+	/* the host must not trap, whatever the guest unmasks */
+	uint16_t cw = cpu.fpu.cw | FPU_EXCEPTIONS;
+	if(cw != host_cw) {
+		asm volatile ("fldcw %0" : : "m" (cw));
+		host_cw = cw;
+	}
+	asm volatile ("fnclex");
+#ifdef __SSE__
+	/* libm reports some errors, such as sqrtl(-1), through SSE, whose
+	 * exception flags are laid out as those of the x87
+	 */
+	uint32_t csr;
+	asm volatile ("stmxcsr %0" : "=m" (csr));
+	csr &= ~FPU_EXCEPTIONS;
+	asm volatile ("ldmxcsr %0" : : "m" (csr));
+#endif
+}
+
+void fpu_host_end() {
+	uint16_t sw;
+	asm volatile ("fnstsw %0" : "=a" (sw));
+	cpu.fpu.sw |= sw & FPU_EXCEPTIONS;
+#ifdef __SSE__
+	uint32_t csr;
+	asm volatile ("stmxcsr %0" : "=m" (csr));
+	cpu.fpu.sw |= csr & FPU_EXCEPTIONS;
+#endif
+}
+
+/* `long double' is the 80-bit format itself */
+long double fpu_load80(const uint8_t *p) {
+	long double v = 0;
+	memcpy(&v, p, 10);
+	return v;
+}
+
+void fpu_store80(uint8_t *p, long double v) {
+	memcpy(p, &v, 10);
+}
+
+#else
+
+#include <fenv.h>
+
+/* Only the rounding control is passed to the host. */
+void fpu_host_begin() {
+	static const int round[] = { FE_TONEAREST, FE_DOWNWARD, FE_UPWARD, FE_TOWARDZERO };
+	fesetround(round[(cpu.fpu.cw >> 10) & 0x3]);
+	feclearexcept(FE_ALL_EXCEPT);
+}
+
+void fpu_host_end() {
+	int e = fetestexcept(FE_ALL_EXCEPT);
+	if(e & FE_INVALID) { cpu.fpu.sw |= FPU_IE; }
+	if(e & FE_DIVBYZERO) { cpu.fpu.sw |= FPU_ZE; }
+	if(e & FE_OVERFLOW) { cpu.fpu.sw |= FPU_OE; }
+	if(e & FE_UNDERFLOW) { cpu.fpu.sw |= FPU_UE; }
+	if(e & FE_INEXACT) { cpu.fpu.sw |= FPU_PE; }
+}
+
+/* NaN payloads and unnormals do not survive the conversion */
+long double fpu_load80(const uint8_t *p) {
+	uint64_t m;
+	memcpy(&m, p, 8);
+	int e = (p[8] | (p[9] << 8)) & 0x7fff;
+	long double v;
+	if(e == 0x7fff) { v = ((m << 1) == 0 ? INFINITY : NAN); }
+	else { v = ldexpl(m, (e == 0 ? 1 : e) - 16383 - 63); }
+	return ((p[9] & 0x80) ? -v : v);
+}
+
+void fpu_store80(uint8_t *p, long double v) {
+	uint64_t m = 0;
+	int e = 0;
+	if(isnan(v)) { m = 0xc000000000000000ull; e = 0x7fff; }
+	else if(isinf(v)) { m = 0x8000000000000000ull; e = 0x7fff; }
+	else if(v != 0) {
+		frexpl(v, &e);
+		e += 16382;
+		if(e < 0) { e = 0; }
+		m = ldexpl(fabsl(v), 16383 + 63 - (e == 0 ? 1 : e));
+	}
+	memcpy(p, &m, 8);
+	e |= (signbit(v) ? 0x8000 : 0);
+	p[8] = e;
+	p[9] = e >> 8;
+}
+
+#endif
+
+/* the state after fninit */
+void fpu_init() {
+	cpu.fpu.cw = 0x037f;
+	cpu.fpu.sw = 0;
+	cpu.fpu.tw = 0xffff;
+	cpu.fpu.top = 0;
+	cpu.fpu.fop = 0;
+	cpu.fpu.fip = cpu.fpu.fdp = 0;
+}
+
+uint16_t fpu_tag_word() {
+	uint16_t tw = 0;
+	int i;
+	for(i = 0; i < 8; i ++) {
+		int tag = FPU_TAG_EMPTY;
+		if(((cpu.fpu.tw >> (i * 2)) & 0x3) != FPU_TAG_EMPTY) {
+			switch(fpclassify(cpu.fpu.st[i])) {
+				case FP_NORMAL: tag = 0; break;
+				case FP_ZERO: tag = 1; break;
+				default: tag = 2; break;
+			}
+		}
+		tw |= tag << (i * 2);
+	}
+	return tw;
+}
+
+void info_fpu() {
+	int i;
+	for(i = 0; i < 8; i ++) {
+		if(fpu_empty(i)) { printf("$st(%d)\tempty\n", i); }
+		else { printf("$st(%d)\t%.20Lg\n", i, cpu.fpu.st[fpu_phys(i)]); }
+	}
+	printf("$fcw\t0x%04x\n", cpu.fpu.cw);
+	printf("$fsw\t0x%04x\n", fpu_status());
+	printf("$ftw\t0x%04x\n", fpu_tag_word());
+}
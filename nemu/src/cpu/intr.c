@@ -0,0 +1,88 @@
+#include "nemu.h"
+#include "cpu/intr.h"
+#include "cpu/eflags.h"
+#include "monitor/monitor.h"
+#include <setjmp.h>
+
+extern jmp_buf jbuf;
+
+typedef union {
+	struct {
+		uint32_t offset1	:16;
+		uint32_t selector	:16;
+		uint32_t			:8;
+		uint32_t type		:4;
+		uint32_t s			:1;
+		uint32_t dpl		:2;
+		uint32_t p			:1;
+		uint32_t offset2	:16;
+	};
+	uint32_t part[2];
+} Gate_Descriptor;
+
+#define GATE_INTR_32 0xe
+
+/* set while a handler is being entered */
+static bool entering = false;
+
+/* Enter the handler of `NO', pushing `error_code' as well if `has_error_code'. */
+static void enter_handler(uint8_t NO, bool has_error_code, uint32_t error_code) {
+	if(entering) {
+		/* the stack or the IDT is not mapped, which would be a double fault */
+		Assert(nemu_state == RUNNING, "interrupt %d while entering a handler", NO);
+		printf("interrupt %d at eip = 0x%08x while entering a handler\n", NO, cpu.eip);
+		entering = false;
+		nemu_state = END;
+		longjmp(jbuf, 1);
+	}
+
+	if((NO << 3) + 7 > cpu.idtr.limit) {
+		/* no handler, as when the program runs without a kernel */
+		Assert(nemu_state == RUNNING, "interrupt %d at eip = 0x%08x", NO, cpu.eip);
+		printf("interrupt %d at eip = 0x%08x, which the IDT has no gate for", NO, cpu.eip);
+		if(NO == 14) { printf(": address 0x%08x, error code 0x%x", cpu.cr2, error_code); }
+		printf("\n");
+		nemu_state = END;
+		longjmp(jbuf, 1);
+	}
+
+	entering = true;
+	Gate_Descriptor gate;
+	gate.part[0] = lnaddr_read(cpu.idtr.base + (NO << 3), 4);
+	gate.part[1] = lnaddr_read(cpu.idtr.base + (NO << 3) + 4, 4);
+	Assert(gate.p, "the gate of interrupt %d is not present", NO);
+
+	/* the instruction with a segment prefix is abandoned */
+	current_sreg = R_DS;
+
+	/* ESP moves only once the whole frame is written */
+	eflags_sync();
+	uint32_t esp = cpu.esp;
+	swaddr_write(esp - 4, 4, cpu.eflags.val);
+	swaddr_write(esp - 8, 4, cpu.cs.selector);
+	swaddr_write(esp - 12, 4, cpu.eip);
+	if(has_error_code) {
+		swaddr_write(esp - 16, 4, error_code);
+		cpu.esp = esp - 16;
+	}
+	else { cpu.esp = esp - 12; }
+	entering = false;
+
+	/* an interrupt gate masks further interrupts, a trap gate does not */
+	if(gate.type == GATE_INTR_32) { cpu.eflags.IF = 0; }
+	cpu.eflags.TF = 0;
+
+	cpu.cs.selector = gate.selector;
+	sreg_load(R_CS);
+	cpu.eip = gate.offset1 | (gate.offset2 << 16);
+
+	longjmp(jbuf, 1);
+}
+
+void raise_intr(uint8_t NO) {
+	enter_handler(NO, false, 0);
+}
+
+void raise_intr_error(uint8_t NO, uint32_t error_code) {
+	enter_handler(NO, true, error_code);
+}
@@ -0,0 +1,890 @@
+#include "cpu/helper.h"
+#include "cpu/jit.h"
+#include <stddef.h>
+#include <sys/mman.h>
+
+bool jit_check = false;
+
+#ifdef __x86_64__
+
+/* host registers */
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+/* Guest GPRs are kept in host registers. RBP points to `cpu'. Guest
+ * registers mapped to caller-saved host registers are reloaded after
+ * memory helper calls.
+ */
+static const int hreg[8] = { RBX, R8, R9, R12, R13, R14, R10, R15 };
+static const int volatile_gpr[] = { R_ECX, R_EDX, R_ESI };
+#define NR_VOLATILE_GPR (sizeof(volatile_gpr) / sizeof(volatile_gpr[0]))
+
+#define GPR_OFF(i) (offsetof(CPU_state, gpr) + 4 * (i))
+#define EIP_OFF offsetof(CPU_state, eip)
+#define EFLAGS_OFF offsetof(CPU_state, eflags)
+
+/* CF, PF, AF, ZF, SF and OF sit at the same positions in guest and host EFLAGS */
+#define FLAGS_ALL 0x8d5
+#define FLAGS_NO_CF 0x8d4
+#define FLAGS_CF_OF 0x801
+#define FLAGS_AF 0x10
+
+enum { ALU_ADD, ALU_OR, ALU_ADC, ALU_SBB, ALU_AND, ALU_SUB, ALU_XOR, ALU_CMP, ALU_TEST, ALU_MOV };
+
+static uint8_t *code_buf = NULL;
+static uint8_t *code_ptr;
+static uint32_t jit_epoch = 1;
+
+/* Kept in the first page of the code buffer, where the generated code
+ * reaches it RIP-relative. The host would take stores to it for self-
+ * modifying code if it shared a page with code.
+ */
+typedef struct {
+	/* instructions executed since jit_exec() entered the code */
+	uint32_t nr_instr;
+	/* how many chained blocks may execute */
+	uint32_t limit;
+	/* the chain site of the last exit, if it has one */
+	uint8_t *exit_site;
+	/* instructions of the current block before the one which called
+	 * a helper, for a fault which leaves through longjmp()
+	 */
+	uint32_t block_done;
+} Jit_data;
+
+#define JIT_DATA_SIZE 4096
+static Jit_data *jd;
+
+/* the chain site to link to the block at `pending_eip' */
+static uint8_t *pending_site;
+static swaddr_t pending_eip;
+
+/* state of the block being compiled */
+static uint8_t *epilogue;
+static uint8_t *cur_body;
+static swaddr_t cur_eip;
+static int cur_nr_instr;
+/* the index of the instruction being compiled */
+static int cur_idx;
+static uint32_t live_flags;
+static uint32_t cur_gen;
+
+static inline void emit1(uint8_t b) { *code_ptr ++ = b; }
+static inline void emit4(uint32_t v) { memcpy(code_ptr, &v, 4); code_ptr += 4; }
+static inline void emit8(uint64_t v) { memcpy(code_ptr, &v, 8); code_ptr += 8; }
+
+static inline void emit_rex(int w, int r, int x, int b) {
+	uint8_t rex = 0x40 | (w << 3) | ((r >> 3) << 2) | ((x >> 3) << 1) | (b >> 3);
+	if(rex != 0x40) { emit1(rex); }
+}
+
+/* opc r/m32(rm), r32(reg) with register operands */
+static void emit_rr(uint8_t opc, int reg, int rm) {
+	emit_rex(0, reg, 0, rm);
+	emit1(opc);
+	emit1(0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/* opc r32(reg), [rbp + disp32] */
+static void emit_rbp(uint8_t opc, int reg, uint32_t disp) {
+	emit_rex(0, reg, 0, RBP);
+	emit1(opc);
+	emit1(0x80 | ((reg & 7) << 3) | RBP);
+	emit4(disp);
+}
+
+/* 0x81 /n r/m32, imm32 */
+static void emit_ri(int n, int rm, uint32_t imm) {
+	emit_rex(0, 0, 0, rm);
+	emit1(0x81);
+	emit1(0xc0 | (n << 3) | (rm & 7));
+	emit4(imm);
+}
+
+static void emit_mov_ri(int r, uint32_t imm) {
+	emit_rex(0, 0, 0, r);
+	emit1(0xb8 + (r & 7));
+	emit4(imm);
+}
+
+/* lea r32, [base + index * scale + disp32], leaving the host flags alone */
+static void emit_lea(int dst, int base, int index, int scale, int32_t disp) {
+	if(base == -1 && index == -1) {
+		emit_mov_ri(dst, disp);
+		return;
+	}
+	emit_rex(0, dst, (index == -1 ? 0 : index), (base == -1 ? 0 : base));
+	emit1(0x8d);
+	if(base == -1) {
+		emit1(0x04 | ((dst & 7) << 3));
+		emit1((scale << 6) | ((index & 7) << 3) | 5);
+	}
+	else {
+		emit1(0x84 | ((dst & 7) << 3));
+		emit1((scale << 6) | ((index == -1 ? 4 : index & 7) << 3) | (base & 7));
+	}
+	emit4(disp);
+}
+
+/* opc r32(reg), [rip + disp32], followed by `imm_len' bytes of immediate */
+static void emit_rip(uint8_t opc, int reg, void *addr, int imm_len) {
+	emit1(opc);
+	emit1(0x05 | ((reg & 7) << 3));
+	emit4((uint8_t *)addr - (code_ptr + 4 + imm_len));
+}
+
+static void emit_call(void *fn) {
+	emit1(0x48); emit1(0xb8); emit8((uint64_t)fn);	/* mov rax, fn */
+	emit1(0xff); emit1(0xd0);						/* call rax */
+}
+
+/* jump to the shared epilogue */
+static void emit_jmp_epilogue() {
+	emit1(0xe9);
+	emit4(epilogue - (code_ptr + 4));
+}
+
+/* Forward conditional jump with a 32-bit displacement. Return the
+ * location of the displacement for patching.
+ */
+static uint8_t* emit_jcc_fwd(int cc) {
+	emit1(0x0f); emit1(0x80 | cc);
+	emit4(0);
+	return code_ptr - 4;
+}
+
+static void patch_fwd(uint8_t *p) {
+	uint32_t rel = code_ptr - (p + 4);
+	memcpy(p, &rel, 4);
+}
+
+static void spill(const int *gpr, int n) {
+	int i;
+	for(i = 0; i < n; i ++) { emit_rbp(0x89, hreg[gpr[i]], GPR_OFF(gpr[i])); }
+}
+
+static void reload(const int *gpr, int n) {
+	int i;
+	for(i = 0; i < n; i ++) { emit_rbp(0x8b, hreg[gpr[i]], GPR_OFF(gpr[i])); }
+}
+
+static const int all_gpr[8] = { R_EAX, R_ECX, R_EDX, R_EBX, R_ESP, R_EBP, R_ESI, R_EDI };
+
+/* Write the live host flags back to `cpu.eflags'. Clobbers RAX and RCX. */
+static void emit_flush_flags(uint32_t mask) {
+	if(mask == 0) { return; }
+	emit1(0x9c);						/* pushfq */
+	emit1(0x58);						/* pop rax */
+	emit1(0x25); emit4(mask);			/* and eax, mask */
+	emit_rbp(0x8b, RCX, EFLAGS_OFF);	/* mov ecx, [eflags] */
+	emit_ri(4, RCX, ~mask);				/* and ecx, ~mask */
+	emit_rr(0x09, RAX, RCX);			/* or ecx, eax */
+	emit_rbp(0x89, RCX, EFLAGS_OFF);	/* mov [eflags], ecx */
+}
+
+static void flush_flags() {
+	emit_flush_flags(live_flags);
+	live_flags = 0;
+}
+
+/* Load the guest arithmetic flags into the host flags. */
+static void load_flags() {
+	emit_rbp(0x8b, RAX, EFLAGS_OFF);	/* mov eax, [eflags] */
+	emit1(0x25); emit4(FLAGS_ALL);		/* and eax, FLAGS_ALL */
+	emit1(0x50);						/* push rax */
+	emit1(0x9d);						/* popfq */
+	live_flags = FLAGS_ALL;
+}
+
+static void emit_count(int nr_instr) {
+	emit_rip(0x81, 0, &jd->nr_instr, 4); emit4(nr_instr);	/* add dword [nr_instr], imm32 */
+}
+
+/* A chain site jumps to the compiled code of the block it leaves for,
+ * as long as that block fits into the limit. Until it is linked with
+ * chain(), its jump goes to the plain exit which follows.
+ */
+#define CHAIN_LEN_OFF 7
+#define CHAIN_JMP_OFF 24
+
+static void chain(uint8_t *site, uint32_t nr_instr, uint8_t *body) {
+	memcpy(site + CHAIN_LEN_OFF, &nr_instr, 4);
+	uint32_t rel = body - (site + CHAIN_JMP_OFF + 4);
+	memcpy(site + CHAIN_JMP_OFF, &rel, 4);
+}
+
+/* Leave the block after `nr_instr' instructions, continuing at `eip'.
+ * Only an exit to code which is still valid may be chained.
+ */
+static void emit_exit_chain(swaddr_t eip, int nr_instr, bool chainable) {
+	emit_flush_flags(live_flags);
+	emit_count(nr_instr);
+
+	/* --jit-check looks at every block */
+	if(chainable && !jit_check) {
+		uint8_t *site = code_ptr;
+		emit_rip(0x8b, RAX, &jd->nr_instr, 0);		/* mov eax, [nr_instr] */
+		emit1(0x05); emit4(0);						/* add eax, <length of the next block> */
+		emit_rip(0x3b, RAX, &jd->limit, 0);			/* cmp eax, [limit] */
+		uint8_t *over = emit_jcc_fwd(0x7);			/* ja */
+		assert(code_ptr == site + CHAIN_JMP_OFF - 1);
+		emit1(0xe9); emit4(0);						/* jmp <the next block> */
+		patch_fwd(code_ptr - 4);
+		patch_fwd(over);
+		/* a loop in the block itself is linked at once */
+		if(eip == cur_eip) { chain(site, cur_nr_instr, cur_body); }
+
+		emit1(0x48); emit_rip(0x8d, RAX, site, 0);				/* lea rax, [site] */
+		emit1(0x48); emit_rip(0x89, RAX, &jd->exit_site, 0);	/* mov [exit_site], rax */
+	}
+
+	emit1(0xc7); emit1(0x85); emit4(EIP_OFF); emit4(eip);	/* mov dword [rbp + eip], imm32 */
+	emit_jmp_epilogue();
+}
+
+static void emit_exit(swaddr_t eip, int nr_instr) {
+	emit_exit_chain(eip, nr_instr, true);
+}
+
+/* Leave the block if the helper call just made returned non-zero, which
+ * means a control transfer or a store to cached code.
+ */
+static void emit_exit_if_eax(swaddr_t eip, int nr_instr) {
+	emit_rr(0x85, RAX, RAX);			/* test eax, eax */
+	uint8_t *p = emit_jcc_fwd(0x4);		/* jz */
+	if(eip == 0) {
+		/* the helper has set `cpu.eip' */
+		emit_count(nr_instr);
+		emit_jmp_epilogue();
+	}
+	else { emit_exit_chain(eip, nr_instr, false); }
+	patch_fwd(p);
+}
+
+/* helpers called by the generated code */
+
+/* guest memory overwritten by a block, kept for --jit-check: the
+ * contents before the store, and after the compiled code has run
+ */
+#define STORE_LOG_SIZE 4096
+static struct {
+	swaddr_t addr;
+	int len;
+	uint32_t data;
+	uint32_t after;
+} store_log[STORE_LOG_SIZE];
+static int nr_store_log;
+static bool store_log_overflow;
+
+/* Only the bytes which are written are read, since the next ones may
+ * not be mapped.
+ */
+static void log_store(swaddr_t addr, int len) {
+	for(; len > 0; addr += 4, len -= 4) {
+		if(nr_store_log == STORE_LOG_SIZE) {
+			store_log_overflow = true;
+			return;
+		}
+		store_log[nr_store_log].addr = addr;
+		store_log[nr_store_log].len = (len < 4 ? len : 4);
+		store_log[nr_store_log].data = swaddr_read(addr, store_log[nr_store_log].len);
+		nr_store_log ++;
+	}
+}
+
+/* the number of bytes an x87 instruction stores to memory */
+static int fpu_store_len(DC_entry *e) {
+	int reg = (e->ops.src2.imm >> 3) & 0x7;
+	switch(e->ops.opcode) {
+		case 0xd9: return (reg == 2 || reg == 3 ? 4 : reg == 6 ? 28 : reg == 7 ? 2 : 0);
+		case 0xdb: return (reg >= 1 && reg <= 3 ? 4 : reg == 7 ? 10 : 0);
+		case 0xdd: return (reg >= 1 && reg <= 3 ? 8 : reg == 6 ? 108 : reg == 7 ? 2 : 0);
+		case 0xdf: return (reg >= 1 && reg <= 3 ? 2 : reg == 6 ? 10 : reg == 7 ? 8 : 0);
+		default: return 0;
+	}
+}
+
+/* Log the memory which the instruction of `e' is about to write. */
+static void log_entry(DC_entry *e) {
+	uint32_t opcode = e->ops.opcode;
+	if(opcode == 0xc9) {
+		/* leave clears the stack frame */
+		swaddr_t addr;
+		for(addr = reg_l(R_ESP); addr < reg_l(R_EBP); addr += 4) { log_store(addr, 4); }
+		return;
+	}
+
+	if((opcode >= 0x50 && opcode <= 0x57) || opcode == 0x68 || opcode == 0x6a
+			|| opcode == 0x9c || opcode == 0xe8) {
+		log_store(reg_l(R_ESP) - 4, 4);
+	}
+	else if(opcode == 0x8d) {
+		/* lea only computes an address */
+	}
+	else if(e->ops.src.type == OP_TYPE_MEM || e->ops.dest.type == OP_TYPE_MEM
+			|| e->ops.src2.type == OP_TYPE_MEM) {
+		/* otherwise the ModR/M memory operand is the only one an idex() helper writes */
+		swaddr_t addr = e->disp;
+		if(e->base_reg != -1) { addr += reg_l(e->base_reg); }
+		if(e->index_reg != -1) { addr += reg_l(e->index_reg) << e->scale; }
+		if(opcode >= 0xd8 && opcode <= 0xdf) { log_store(addr, fpu_store_len(e)); }
+		else {
+			Operand *op = (e->ops.src.type == OP_TYPE_MEM ? &e->ops.src :
+					e->ops.dest.type == OP_TYPE_MEM ? &e->ops.dest : &e->ops.src2);
+			log_store(addr, op->size);
+		}
+	}
+}
+
+static uint32_t jit_load(swaddr_t addr) {
+	return swaddr_read(addr, 4);
+}
+
+static int jit_store(swaddr_t addr, uint32_t data, uint32_t gen) {
+	if(jit_check) { log_store(addr, 4); }
+	swaddr_write(addr, 4, data);
+	return decode_cache_generation() != gen;
+}
+
+static int jit_fallback(DC_entry *e, uint32_t gen) {
+	if(jit_check) { log_entry(e); }
+
+	cpu.eip = e->eip;
+	cpu.eip += decode_cache_replay(e);
+	/* the generated code keeps the flags in `cpu.eflags' */
+	eflags_sync();
+	return cpu.eip != e->eip + e->len || decode_cache_generation() != gen;
+}
+
+/* RDI = address of the memory operand */
+static void emit_addr(DC_entry *e) {
+	emit_lea(RDI, (e->base_reg == -1 ? -1 : hreg[e->base_reg]),
+			(e->index_reg == -1 ? -1 : hreg[e->index_reg]), e->scale, e->disp);
+}
+
+/* With the fast memory model, loads and stores which hit the soft-TLB
+ * run inline and only misses call the memory helpers. --jit-check logs
+ * every store, so it always calls them.
+ */
+static inline bool inline_mem() {
+	return mem_model == MEM_FAST && !jit_check;
+}
+
+#define SOFT_TLB_OFF(field) offsetof(Soft_TLB, field)
+
+/* opc r32(reg), [rdx + disp8] */
+static void emit_rdx(uint8_t opc, int reg, uint8_t disp) {
+	emit1(opc);
+	emit1(0x40 | ((reg & 7) << 3) | RDX);
+	emit1(disp);
+}
+
+/* Look up the 4 bytes at EDI (a guest address in DS) in the soft-TLB.
+ * On a hit RAX points to them in host memory; a miss jumps to the two
+ * returned locations. Clobbers RCX and RDX, and the host flags.
+ */
+static void emit_soft_tlb(uint8_t tag, uint8_t **miss) {
+	emit_rr(0x89, RDI, RAX);										/* mov eax, edi */
+	if(cpu.cr0.protect_enable) { emit_rbp(0x03, RAX, offsetof(CPU_state, ds.base)); }	/* add eax, [ds.base] */
+	emit_rr(0x89, RAX, RCX);										/* mov ecx, eax */
+	emit1(0xc1); emit1(0xe8 | RCX); emit1(12);						/* shr ecx, 12 */
+	emit_ri(4, RCX, SOFT_TLB_SIZE - 1);								/* and ecx, SOFT_TLB_SIZE - 1 */
+	emit1(0x69); emit1(0xc0 | (RCX << 3) | RCX); emit4(sizeof(Soft_TLB));	/* imul ecx, ecx, sizeof */
+	emit1(0x48); emit1(0xba); emit8((uint64_t)soft_tlb);			/* mov rdx, soft_tlb */
+	emit1(0x48); emit1(0x01); emit1(0xc0 | (RCX << 3) | RDX);		/* add rdx, rcx */
+
+	emit_lea(RCX, RAX, -1, 0, 3);									/* lea ecx, [eax + 3] */
+	emit_ri(4, RCX, ~0xfff);										/* and ecx, ~0xfff */
+	emit_rdx(0x3b, RCX, tag);										/* cmp ecx, [rdx + tag] */
+	miss[0] = emit_jcc_fwd(0x5);									/* jne */
+	/* with paging the TLB model has to see the hit */
+	emit1(0x83); emit1(0x40 | (7 << 3) | RDX); emit1(SOFT_TLB_OFF(tlb_index)); emit1(0xff);	/* cmp dword [rdx + tlb_index], -1 */
+	miss[1] = emit_jcc_fwd(0x5);									/* jne */
+	emit1(0x48); emit_rdx(0x03, RAX, SOFT_TLB_OFF(addend));			/* add rax, [rdx + addend] */
+}
+
+/* The memory helpers may raise a fault, which leaves the block through
+ * longjmp(). Before calling one, put the guest state at the instruction
+ * at `eip' into `cpu'. Clobbers RAX and RCX.
+ */
+static void emit_sync_state(swaddr_t eip) {
+	flush_flags();
+	spill(all_gpr, 8);
+	emit1(0xc7); emit1(0x85); emit4(EIP_OFF); emit4(eip);	/* mov dword [rbp + eip], imm32 */
+	emit_rip(0xc7, 0, &jd->block_done, 4); emit4(cur_idx);	/* mov dword [block_done], imm32 */
+}
+
+/* EAX = the 4 bytes at EDI. `eip' is the instruction. */
+static void emit_load_rdi(swaddr_t eip) {
+	uint8_t *miss[2], *done = NULL;
+	if(inline_mem()) {
+		emit_soft_tlb(SOFT_TLB_OFF(tag_read), miss);
+		emit1(0x8b); emit1(0x00);			/* mov eax, [rax] */
+		emit1(0xe9); emit4(0);				/* jmp done */
+		done = code_ptr - 4;
+		patch_fwd(miss[0]);
+		patch_fwd(miss[1]);
+	}
+
+	emit_sync_state(eip);
+	emit_call(jit_load);
+	reload(volatile_gpr, NR_VOLATILE_GPR);
+	if(done != NULL) { patch_fwd(done); }
+}
+
+/* The 4 bytes at EDI = ESI. EAX is non-zero if the store has
+ * overwritten cached code.
+ */
+static void emit_store_rdi(swaddr_t eip) {
+	uint8_t *miss[3], *done = NULL;
+	if(inline_mem()) {
+		emit_soft_tlb(SOFT_TLB_OFF(tag_write), miss);
+		/* stores to a page with cached code take the helper */
+		emit1(0x48); emit1(0xb9); emit8(-(uint64_t)hw_mem);		/* mov rcx, -hw_mem */
+		emit1(0x48); emit1(0x01); emit1(0xc0 | (RAX << 3) | RCX);	/* add rcx, rax */
+		emit1(0x48); emit1(0xc1); emit1(0xe8 | RCX); emit1(12);		/* shr rcx, 12 */
+		emit1(0x48); emit1(0xba); emit8((uint64_t)decode_cache_code_page());	/* mov rdx, code_page */
+		emit1(0x80); emit1(0x3c); emit1((RCX << 3) | RDX); emit1(0);	/* cmp byte [rdx + rcx], 0 */
+		miss[2] = emit_jcc_fwd(0x5);									/* jne */
+		emit1(0x89); emit1(0x30);			/* mov [rax], esi */
+		emit_rr(0x31, RAX, RAX);			/* xor eax, eax */
+		emit1(0xe9); emit4(0);				/* jmp done */
+		done = code_ptr - 4;
+		patch_fwd(miss[0]);
+		patch_fwd(miss[1]);
+		patch_fwd(miss[2]);
+	}
+
+	emit_sync_state(eip);
+	emit_mov_ri(RDX, cur_gen);
+	emit_call(jit_store);
+	reload(volatile_gpr, NR_VOLATILE_GPR);
+	if(done != NULL) { patch_fwd(done); }
+}
+
+/* EAX = memory operand */
+static void emit_load(DC_entry *e) {
+	flush_flags();
+	emit_addr(e);
+	emit_load_rdi(e->eip);
+}
+
+/* memory operand = ESI */
+static void emit_store(DC_entry *e, int idx) {
+	flush_flags();
+	emit_addr(e);
+	emit_store_rdi(e->eip);
+	emit_exit_if_eax(e->eip + e->len, idx + 1);
+}
+
+static void emit_fallback(DC_entry *e, int idx) {
+	flush_flags();
+	spill(all_gpr, 8);
+	emit_rip(0xc7, 0, &jd->block_done, 4); emit4(idx);	/* mov dword [block_done], imm32 */
+	emit1(0x48); emit1(0xbf); emit8((uint64_t)e);	/* mov rdi, e */
+	emit_mov_ri(RSI, cur_gen);
+	emit_call(jit_fallback);
+	reload(all_gpr, 8);
+	emit_exit_if_eax(0, idx + 1);
+}
+
+static int alu_kind(DC_entry *e) {
+	uint32_t opcode = e->ops.opcode;
+	if(opcode < 0x40 && (opcode & 0x7) <= 5 && (opcode & 0x1)) { return opcode >> 3; }
+	switch(opcode) {
+		case 0x81: case 0x83: return e->ops.group_idx;
+		case 0x85: case 0xa9: return ALU_TEST;
+		case 0xf7: return (e->ops.group_idx == 0 ? ALU_TEST : -1);
+		case 0x89: case 0x8b: case 0xc7: return ALU_MOV;
+		default: return (opcode >= 0xb8 && opcode <= 0xbf ? ALU_MOV : -1);
+	}
+}
+
+static inline bool op_ok(Operand *op) {
+	return op->type == OP_TYPE_IMM || op->size == 4;
+}
+
+/* dest = dest OP src */
+static bool emit_alu(DC_entry *e, int idx) {
+	int kind = alu_kind(e);
+	if(kind == -1 || kind == ALU_ADC || kind == ALU_SBB) { return false; }
+	Operand *dest = &e->ops.dest, *src = &e->ops.src;
+	if(!op_ok(dest) || !op_ok(src) || dest->type == OP_TYPE_IMM) { return false; }
+
+	uint8_t opc_rr = (kind == ALU_TEST ? 0x85 : kind == ALU_MOV ? 0x89 : (kind << 3) | 1);
+	bool writeback = (kind != ALU_CMP && kind != ALU_TEST);
+
+	if(dest->type == OP_TYPE_REG) {
+		int hd = hreg[dest->reg];
+		if(src->type == OP_TYPE_MEM) {
+			emit_load(e);
+			emit_rr(opc_rr, RAX, hd);
+		}
+		else if(src->type == OP_TYPE_REG) { emit_rr(opc_rr, hreg[src->reg], hd); }
+		else if(kind == ALU_MOV) { emit_mov_ri(hd, src->val); }
+		else if(kind == ALU_TEST) {
+			emit_rex(0, 0, 0, hd); emit1(0xf7); emit1(0xc0 | (hd & 7)); emit4(src->val);
+		}
+		else { emit_ri(kind, hd, src->val); }
+		if(kind != ALU_MOV) { live_flags = FLAGS_ALL; }
+		return true;
+	}
+
+	/* memory destination */
+	if(kind == ALU_MOV) {
+		if(src->type == OP_TYPE_REG) { emit_rr(0x89, hreg[src->reg], RSI); }
+		else { emit_mov_ri(RSI, src->val); }
+		emit_store(e, idx);
+		return true;
+	}
+
+	emit_load(e);
+	if(src->type == OP_TYPE_REG) { emit_rr(opc_rr, hreg[src->reg], RAX); }
+	else if(kind == ALU_TEST) { emit1(0xa9); emit4(src->val); }
+	else { emit_ri(kind, RAX, src->val); }
+	live_flags = FLAGS_ALL;
+
+	if(writeback) {
+		emit_rr(0x89, RAX, RSI);
+		emit_store(e, idx);
+	}
+	return true;
+}
+
+/* inc and dec leave CF alone */
+static bool emit_incdec(DC_entry *e, int idx) {
+	uint32_t opcode = e->ops.opcode;
+	int n;
+	if(opcode >= 0x40 && opcode <= 0x4f) { n = (opcode >> 3) & 1; }
+	else if(opcode == 0xff) { n = e->ops.group_idx; }
+	else { return false; }
+
+	Operand *op = &e->ops.src;
+	if(n > 1 || op->size != 4) { return false; }
+
+	uint32_t mask = (live_flags == FLAGS_ALL ? FLAGS_ALL : FLAGS_NO_CF);
+	if(op->type == OP_TYPE_REG) {
+		emit_rex(0, 0, 0, hreg[op->reg]); emit1(0xff); emit1(0xc0 | (n << 3) | (hreg[op->reg] & 7));
+		live_flags = mask;
+		return true;
+	}
+	if(op->type != OP_TYPE_MEM) { return false; }
+
+	emit_load(e);
+	emit1(0xff); emit1(0xc0 | (n << 3) | RAX);
+	live_flags = FLAGS_NO_CF;
+	emit_rr(0x89, RAX, RSI);
+	emit_store(e, idx);
+	return true;
+}
+
+/* lea r32, m */
+static bool emit_lea_instr(DC_entry *e) {
+	if(e->ops.opcode != 0x8d) { return false; }
+	emit_lea(hreg[e->ops.dest.reg], (e->base_reg == -1 ? -1 : hreg[e->base_reg]),
+			(e->index_reg == -1 ? -1 : hreg[e->index_reg]), e->scale, e->disp);
+	return true;
+}
+
+/* imul r32, r/m32 and imul r32, r/m32, imm */
+static bool emit_imul(DC_entry *e) {
+	uint32_t opcode = e->ops.opcode;
+	Operand *rm, *imm = NULL;
+	if(opcode == 0x1af) { rm = &e->ops.src; }
+	else if(opcode == 0x69 || opcode == 0x6b) {
+		rm = &e->ops.src2;
+		imm = &e->ops.src;
+	}
+	else { return false; }
+	if(rm->size != 4) { return false; }
+
+	int hd = hreg[e->ops.dest.reg];
+	int hs = RAX;
+	if(rm->type == OP_TYPE_MEM) { emit_load(e); }
+	else { hs = hreg[rm->reg]; }
+
+	if(imm != NULL) {
+		emit_rex(0, hd, 0, hs); emit1(0x69); emit1(0xc0 | ((hd & 7) << 3) | (hs & 7)); emit4(imm->val);
+	}
+	else {
+		emit_rex(0, hd, 0, hs); emit1(0x0f); emit1(0xaf); emit1(0xc0 | ((hd & 7) << 3) | (hs & 7));
+	}
+
+	/* As the interpreter does, set CF and OF if the product is truncated,
+	 * clear AF, and set SF, ZF and PF by the result.
+	 */
+	emit1(0x0f); emit1(0x92); emit1(0xc0 | RCX);							/* setc cl */
+	emit1(0x81); emit1(0x80 | (4 << 3) | RBP); emit4(EFLAGS_OFF);
+	emit4(~(FLAGS_CF_OF | FLAGS_AF));										/* and dword [eflags], ~(CF | OF | AF) */
+	emit1(0x0f); emit1(0xb6); emit1(0xc0 | (RCX << 3) | RCX);				/* movzx ecx, cl */
+	emit1(0x69); emit1(0xc0 | (RCX << 3) | RCX); emit4(FLAGS_CF_OF);		/* imul ecx, ecx, CF | OF */
+	emit_rbp(0x09, RCX, EFLAGS_OFF);										/* or [eflags], ecx */
+	emit_rr(0x85, hd, hd);													/* test hd, hd */
+	live_flags = FLAGS_ALL & ~(FLAGS_CF_OF | FLAGS_AF);
+	return true;
+}
+
+static bool emit_push_pop(DC_entry *e, int idx) {
+	uint32_t opcode = e->ops.opcode;
+	Operand *op = &e->ops.src;
+	int esp = hreg[R_ESP];
+
+	if(opcode >= 0x58 && opcode <= 0x5f) {
+		/* pop r32 */
+		flush_flags();
+		emit_lea(RDI, esp, -1, 0, 0);
+		emit_load_rdi(e->eip);
+		emit_rr(0x89, RAX, hreg[op->reg]);
+		emit_lea(esp, esp, -1, 0, 4);
+		return true;
+	}
+
+	/* push */
+	if(opcode >= 0x50 && opcode <= 0x57) { emit_rr(0x89, hreg[op->reg], RSI); }
+	else if(opcode == 0x68) { emit_mov_ri(RSI, op->val); }
+	else if(opcode == 0x6a) { emit_mov_ri(RSI, (int8_t)op->val); }
+	else { return false; }
+
+	flush_flags();
+	emit_lea(RDI, esp, -1, 0, -4);
+	emit_store_rdi(e->eip);
+	emit_lea(esp, esp, -1, 0, -4);
+	emit_exit_if_eax(e->eip + e->len, idx + 1);
+	return true;
+}
+
+static bool emit_branch(DC_entry *e, int idx) {
+	uint32_t opcode = e->ops.opcode;
+	swaddr_t next = e->eip + e->len;
+	swaddr_t target = next + e->ops.src.val;
+	int cc;
+
+	if(opcode == 0xeb || opcode == 0xe9) {
+		emit_exit(target, idx + 1);
+		return true;
+	}
+
+	if(opcode >= 0x70 && opcode <= 0x7f) { cc = opcode & 0xf; }
+	else if(opcode >= 0x180 && opcode <= 0x18f) { cc = opcode & 0xf; }
+	else { return false; }
+
+	if(live_flags != FLAGS_ALL) {
+		flush_flags();
+		load_flags();
+	}
+
+	/* skip the exit if the branch is not taken */
+	uint8_t *p = emit_jcc_fwd(cc ^ 1);
+	emit_exit(target, idx + 1);
+	patch_fwd(p);
+	return true;
+}
+
+static bool emit_instr(DC_entry *e, int idx) {
+	if(e->ops.is_operand_size_16) { return false; }
+	return emit_branch(e, idx) || emit_alu(e, idx) || emit_incdec(e, idx) || emit_lea_instr(e)
+		|| emit_imul(e) || emit_push_pop(e, idx);
+}
+
+void init_jit() {
+	if(code_buf == NULL) {
+		code_buf = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		Assert(code_buf != MAP_FAILED, "Can not allocate the JIT code buffer");
+	}
+	jd = (Jit_data *)code_buf;
+	memset(jd, 0, sizeof(*jd));
+	code_ptr = code_buf + JIT_DATA_SIZE;
+	pending_site = NULL;
+	jit_epoch ++;
+}
+
+bool jit_compile(TB *tb) {
+	/* enough for the longest possible block */
+	if(code_ptr + TB_MAX_INSTR * (256 + sizeof(DC_entry)) + 512 > code_buf + JIT_CODE_SIZE) { init_jit(); }
+
+	uint8_t *start = code_ptr;
+
+	/* The fallbacks get a copy of the instructions which lives as long
+	 * as the code. A chained jump may still enter the code after the
+	 * slot of `tb' has been taken by another block.
+	 */
+	code_ptr = (uint8_t *)(((uintptr_t)code_ptr + 7) & ~(uintptr_t)7);
+	DC_entry *instr = (DC_entry *)code_ptr;
+	memcpy(instr, tb->instr, sizeof(DC_entry) * tb->nr_instr);
+	code_ptr += sizeof(DC_entry) * tb->nr_instr;
+
+	cur_gen = tb->gen;
+	cur_eip = tb->eip;
+	cur_nr_instr = tb->nr_instr;
+	live_flags = 0;
+
+	/* epilogue: return the number of instructions executed */
+	epilogue = code_ptr;
+	spill(all_gpr, 8);
+	emit_rip(0x8b, RAX, &jd->nr_instr, 0);	/* mov eax, [nr_instr] */
+	emit1(0x48); emit1(0x83); emit1(0xc4); emit1(0x08);	/* add rsp, 8 */
+	emit1(0x41); emit1(0x5f);	/* pop r15 */
+	emit1(0x41); emit1(0x5e);	/* pop r14 */
+	emit1(0x41); emit1(0x5d);	/* pop r13 */
+	emit1(0x41); emit1(0x5c);	/* pop r12 */
+	emit1(0x5d);				/* pop rbp */
+	emit1(0x5b);				/* pop rbx */
+	emit1(0xc3);				/* ret */
+
+	/* prologue */
+	uint8_t *entry = code_ptr;
+	emit1(0x53);				/* push rbx */
+	emit1(0x55);				/* push rbp */
+	emit1(0x41); emit1(0x54);	/* push r12 */
+	emit1(0x41); emit1(0x55);	/* push r13 */
+	emit1(0x41); emit1(0x56);	/* push r14 */
+	emit1(0x41); emit1(0x57);	/* push r15 */
+	emit1(0x48); emit1(0x83); emit1(0xec); emit1(0x08);	/* sub rsp, 8 */
+	emit1(0x48); emit1(0xbd); emit8((uint64_t)&cpu);	/* mov rbp, &cpu */
+	reload(all_gpr, 8);
+	/* chained blocks jump in here */
+	cur_body = code_ptr;
+
+	int i, nr_native = 0;
+	for(i = 0; i < tb->nr_instr; i ++) {
+		DC_entry *e = &instr[i];
+		cur_idx = i;
+		if(emit_instr(e, i)) { nr_native ++; }
+		else { emit_fallback(e, i); }
+	}
+
+	DC_entry *last = &instr[tb->nr_instr - 1];
+	emit_exit(last->eip + last->len, tb->nr_instr);
+
+	if(nr_native == 0) {
+		code_ptr = start;
+		return false;
+	}
+
+	tb->jit_code = entry;
+	tb->jit_body = cur_body;
+	tb->jit_epoch = jit_epoch;
+	return true;
+}
+
+/* What the compiled code left at the address of the interpreter's
+ * store `k': the contents after a store of the compiled code, or else
+ * the original contents, which the first store to it has logged.
+ */
+static uint32_t jit_after(int k, int nr_jit_log) {
+	int i;
+	for(i = 0; i < k; i ++) {
+		if(store_log[i].addr == store_log[k].addr && store_log[i].len == store_log[k].len) { break; }
+	}
+	return (i < nr_jit_log ? store_log[i].after : store_log[i].data);
+}
+
+/* Run the compiled block once more through the interpreter and compare. */
+static void check_block(TB *tb, CPU_state *before, uint32_t nr_jit) {
+	CPU_state after = cpu;
+	int i;
+
+	/* the block has written too much to be undone */
+	if(store_log_overflow) { return; }
+
+	/* undo the stores of the compiled code */
+	int nr_jit_log = nr_store_log;
+	for(i = 0; i < nr_jit_log; i ++) {
+		store_log[i].after = swaddr_read(store_log[i].addr, store_log[i].len);
+	}
+	for(i = nr_jit_log - 1; i >= 0; i --) {
+		swaddr_write(store_log[i].addr, store_log[i].len, store_log[i].data);
+	}
+
+	cpu = *before;
+	uint32_t nr = 0;
+	for(i = 0; i < tb->nr_instr && cpu.eip == tb->instr[i].eip; i ++) {
+		log_entry(&tb->instr[i]);
+		cpu.eip += decode_cache_replay(&tb->instr[i]);
+		nr ++;
+	}
+	eflags_sync();
+
+	bool ok = (nr == nr_jit && cpu.eip == after.eip &&
+			(cpu.eflags.val & FLAGS_ALL) == (after.eflags.val & FLAGS_ALL));
+	for(i = R_EAX; i <= R_EDI; i ++) {
+		if(reg_l(i) != after.gpr[i]._32) { ok = false; }
+	}
+
+	/* the memory written by either of them */
+	int bad_mem = -1;
+	if(!store_log_overflow) {
+		for(i = nr_jit_log; i < nr_store_log; i ++) {
+			store_log[i].after = jit_after(i, nr_jit_log);
+		}
+		for(i = 0; i < nr_store_log; i ++) {
+			if(swaddr_read(store_log[i].addr, store_log[i].len) != store_log[i].after) {
+				bad_mem = i;
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	if(!ok) {
+		printf("jit: block at 0x%08x differs from the interpreter\n", tb->eip);
+		printf("\t\tjit\t\tinterpreter\n");
+		printf("nr_instr\t%d\t\t%d\n", nr_jit, nr);
+		for(i = R_EAX; i <= R_EDI; i ++) {
+			printf("%s\t\t0x%08x\t0x%08x\n", regsl[i], after.gpr[i]._32, reg_l(i));
+		}
+		printf("eip\t\t0x%08x\t0x%08x\n", after.eip, cpu.eip);
+		printf("eflags\t\t0x%08x\t0x%08x\n", after.eflags.val, cpu.eflags.val);
+		if(bad_mem != -1) {
+			swaddr_t addr = store_log[bad_mem].addr;
+			printf("[0x%08x]\t0x%08x\t0x%08x\n", addr, store_log[bad_mem].after, swaddr_read(addr, store_log[bad_mem].len));
+		}
+		panic("jit check failed");
+	}
+}
+
+uint32_t jit_exec(TB *tb, uint32_t budget) {
+	if(tb->jit_epoch != jit_epoch) { return 0; }
+	jit_fun code = (jit_fun)tb->jit_code;
+	eflags_sync();
+
+	/* the last exit went to this block */
+	if(pending_site != NULL && pending_eip == tb->eip) {
+		chain(pending_site, tb->nr_instr, tb->jit_body);
+	}
+	pending_site = NULL;
+
+	jd->nr_instr = 0;
+	jd->limit = (budget < JIT_CHAIN_MAX ? budget : JIT_CHAIN_MAX);
+	jd->exit_site = NULL;
+
+	if(!jit_check) {
+		uint32_t nr = code();
+		if(jd->exit_site != NULL) {
+			pending_site = jd->exit_site;
+			pending_eip = cpu.eip;
+		}
+		return nr;
+	}
+
+	CPU_state before = cpu;
+	nr_store_log = 0;
+	store_log_overflow = false;
+	uint32_t nr = code();
+	check_block(tb, &before, nr);
+	return nr;
+}
+
+/* the instructions finished before a fault left the code */
+uint32_t jit_abort() {
+	return jd->nr_instr + jd->block_done;
+}
+
+#else
+
+void init_jit() { }
+bool jit_compile(TB *tb) { return false; }
+uint32_t jit_exec(TB *tb, uint32_t budget) { return 0; }
+uint32_t jit_abort() { return 0; }
+
+#endif
@@ -1,4 +1,5 @@
 #include "nemu.h"
+#include "cpu/decode/decode-cache.h"
 #include <stdlib.h>
 #include <time.h>
 
@@ -42,3 +43,29 @@ void reg_test() {
 	assert(eip_sample == cpu.eip);
 }
 
+
+/* Without protection a segment starts at 16 times its selector. With it,
+ * the selector picks a descriptor in the GDT.
+ */
+void sreg_load(uint8_t sreg) {
+	Segment_Reg *s = &cpu.sreg[sreg];
+	uint32_t base = s->base;
+	if(cpu.cr0.protect_enable == 0) {
+		s->base = s->selector << 4;
+		s->limit = 0xffff;
+	}
+	else {
+		uint32_t index = s->selector >> 3;
+		Assert((index << 3) + 7 <= cpu.gdtr.limit, "selector 0x%x is beyond the GDT", s->selector);
+		Sreg_Descriptor desc;
+		desc.part1 = lnaddr_read(cpu.gdtr.base + (index << 3), 4);
+		desc.part2 = lnaddr_read(cpu.gdtr.base + (index << 3) + 4, 4);
+		s->base = desc.base1 | (desc.base2 << 16) | (desc.base3 << 24);
+		s->limit = desc.limit1 | (desc.limit2 << 16);
+		if(desc.g) { s->limit = (s->limit << 12) | 0xfff; }
+		s->attribute = (desc.part2 >> 8) & 0xffff;
+	}
+
+	/* the decoded instructions are looked up by offset in CS */
+	if(sreg == R_CS && s->base != base) { flush_decode_cache(); }
+}
@@ -1,12 +1,21 @@
 #include "common.h"
 #ifdef HAS_DEVICE
 
+#include "monitor/checkpoint.h"
+
 void init_serial();
 void init_timer();
 void init_vga();
 void init_i8042();
 void init_ide();
 
+void pio_ckpt(Ckpt *);
+void mmio_ckpt(Ckpt *);
+void i8259_ckpt(Ckpt *);
+void vga_ckpt(Ckpt *);
+void i8042_ckpt(Ckpt *);
+void ide_ckpt(Ckpt *);
+
 void init_device() {
 	init_serial();
 	init_timer();
@@ -15,4 +24,13 @@ void init_device() {
 	init_ide();
 }
 
+void device_ckpt(Ckpt *c) {
+	pio_ckpt(c);
+	mmio_ckpt(c);
+	i8259_ckpt(c);
+	vga_ckpt(c);
+	i8042_ckpt(c);
+	ide_ckpt(c);
+}
+
 #endif
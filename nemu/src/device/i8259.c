@@ -1,5 +1,6 @@
 #include "common.h"
 #include "cpu/reg.h"
+#include "monitor/checkpoint.h"
 
 #define IRQ_BASE 32
 #define NO_INTR -1
@@ -39,11 +40,7 @@ static const char ffo_table[] = {
 static void do_i8259() {
 	int8_t master_irq = master.highest_irq;
 	if(master_irq == NO_INTR) {
-		/* TODO: Uncomment the following line after the `INTR' member
-		 * is added to the CPU_state structure.
-		 */
-		// cpu.INTR = false;
-		panic("uncomment the line above");
+		cpu.INTR = false;
 		return;
 	}
 	else if(master_irq == 2) {
@@ -52,11 +49,7 @@ static void do_i8259() {
 	}
 
 	intr_NO = master_irq + IRQ_BASE;
-	/* TODO: Uncomment the following line after the `INTR' member
-	 * is added to the CPU_state structure.
-	 */
-	// cpu.INTR = true;
-	panic("uncomment the line above");
+	cpu.INTR = true;
 }
 
 /* device interface */
@@ -104,3 +97,9 @@ void i8259_ack_intr() {
 
 	do_i8259();
 }
+
+void i8259_ckpt(Ckpt *c) {
+	ckpt_data(c, &master, sizeof(master));
+	ckpt_data(c, &slave, sizeof(slave));
+	ckpt_data(c, &intr_NO, sizeof(intr_NO));
+}
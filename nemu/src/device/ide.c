@@ -1,7 +1,9 @@
 #include "common.h"
 #include "memory/memory.h"
+#include "memory/dirty.h"
 #include "device/port-io.h"
 #include "device/i8259.h"
+#include "monitor/checkpoint.h"
 
 #define IDE_CTRL_PORT 0x3F6
 #define IDE_PORT 0x1F0
@@ -105,6 +107,7 @@ void bmr_io_handler(ioaddr_t addr, size_t len, bool is_write) {
 
 					ret = fread((void *)hwa_to_va(addr), byte_cnt, 1, disk_fp);
 					assert(ret == 1 || feof(disk_fp));
+					dirty_mark(addr, byte_cnt);
 
 					/* We only implement PRDT of single entry. */
 					assert(hi_entry & 0x80000000);
@@ -133,3 +136,11 @@ void init_ide() {
 	disk_fp = fopen(exec_file, "r+");
 	Assert(disk_fp, "Can not open '%s'", exec_file);
 }
+
+/* The disk image itself is not saved, it is opened by init_ide(). */
+void ide_ckpt(Ckpt *c) {
+	ckpt_data(c, &sector, sizeof(sector));
+	ckpt_data(c, &disk_idx, sizeof(disk_idx));
+	ckpt_data(c, &byte_cnt, sizeof(byte_cnt));
+	ckpt_data(c, &ide_write, sizeof(ide_write));
+}
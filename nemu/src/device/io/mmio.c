@@ -1,6 +1,8 @@
 #include "common.h"
 #include "device/mmio.h"
 #include "misc.h"
+#include "memory/memory.h"
+#include "monitor/checkpoint.h"
 
 #define MMIO_SPACE_MAX (256 * 1024)
 #define NR_MAP 8
@@ -30,6 +32,9 @@ void* add_mmio_map(hwaddr_t addr, size_t len, mmio_callback_t callback) {
 	maps[nr_map].callback = callback;
 	nr_map ++;
 	mmio_space_free_index += len;
+
+	/* pages of the new space may have been mapped to host memory */
+	soft_tlb_flush();
 	return space_base;
 }
 
@@ -44,6 +49,18 @@ int is_mmio(hwaddr_t addr) {
 	return -1;
 }
 
+/* Does any MMIO space overlap the page at `addr'? */
+bool is_mmio_page(hwaddr_t addr) {
+	hwaddr_t low = addr & ~0xfff, high = low + 0xfff;
+	int i;
+	for(i = 0; i < nr_map; i ++) {
+		if(maps[i].low <= high && low <= maps[i].high) {
+			return true;
+		}
+	}
+	return false;
+}
+
 uint32_t mmio_read(hwaddr_t addr, size_t len, int map_NO) {
 	assert(len == 1 || len == 2 || len == 4);
 	MMIO_t *map = &maps[map_NO];
@@ -60,3 +77,8 @@ void mmio_write(hwaddr_t addr, size_t len, uint32_t data, int map_NO) {
 	memcpy_with_mask(map->mmio_space + (addr - map->low), &data, len, (void *)&mask);
 	maps[map_NO].callback(addr, len, true);
 }
+
+void mmio_ckpt(Ckpt *c) {
+	ckpt_check(c, mmio_space_free_index, "MMIO space");
+	ckpt_data(c, mmio_space_pool, mmio_space_free_index);
+}
@@ -1,5 +1,6 @@
 #include "common.h"
 #include "device/port-io.h"
+#include "monitor/checkpoint.h"
 
 #define PORT_IO_SPACE_MAX 65536
 #define NR_MAP 8
@@ -54,3 +55,7 @@ void pio_write(ioaddr_t addr, size_t len, uint32_t data) {
 	pio_callback(addr, len, true);
 }
 
+/* The registers of the devices; the maps are set up by their init_*(). */
+void pio_ckpt(Ckpt *c) {
+	ckpt_data(c, pio_space, sizeof(pio_space));
+}
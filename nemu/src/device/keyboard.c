@@ -1,6 +1,7 @@
 #include "device/port-io.h"
 #include "device/i8259.h"
 #include "monitor/monitor.h"
+#include "monitor/checkpoint.h"
 
 #define I8042_DATA_PORT 0x60
 #define KEYBOARD_IRQ 1
@@ -27,3 +28,6 @@ void init_i8042() {
 	newkey = false;
 }
 
+void i8042_ckpt(Ckpt *c) {
+	ckpt_data(c, &newkey, sizeof(newkey));
+}
@@ -6,6 +6,7 @@
 #include "device/port-io.h"
 #include "device/mmio.h"
 #include "device/i8259.h"
+#include "monitor/checkpoint.h"
 
 enum {Horizontal_Total_Register, End_Horizontal_Display_Register, 
 	Start_Horizontal_Blanking_Register, End_Horizontal_Blanking_Register,
@@ -110,4 +111,15 @@ void init_vga() {
 	vga_crtc_port_base = add_pio_map(VGA_CRTC_INDEX, 2, vga_crtc_io_handler);
 	vmem_base = add_mmio_map(0xa0000, 0x20000, vga_vmem_io_handler);
 }
+
+/* The video memory is saved with the MMIO space. Redraw the whole
+ * screen from it after loading.
+ */
+void vga_ckpt(Ckpt *c) {
+	ckpt_data(c, vga_crtc_regs, sizeof(vga_crtc_regs));
+	if(c->load) {
+		vmem_dirty = true;
+		memset(line_dirty, true, sizeof(line_dirty));
+	}
+}
 #endif	/* HAS_DEVICE */
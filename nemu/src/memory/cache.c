@@ -1,139 +1,463 @@
 #include "nemu.h"
 #include "memory/cache.h"
-#include <time.h>
 #include "burst.h"
+#include "monitor/timing.h"
+#include "memory/stats.h"
 #include <stdlib.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
 
-void init_cache() {
-  int i;
-  for (i = 0; i < CACHE_L1_SET_NUM * CACHE_L1_WAY_NUM; i++) {
-    cache_L1[i].validVal = false;
+/* Dirty data moves down one level at a time: a dirty L1 victim is
+ * written into L2, and only an L2 victim is written to DRAM. An L1 miss
+ * on an exclusive L2 moves the line up, and the L1 victim takes its
+ * place in L2.
+ */
+
+int cache_L2_mode = CACHE_INCLUSIVE;
+
+Cache_config cache_config[NR_CACHE_LEVEL] = {
+  { 64 * 1024, 8, 64, CACHE_WB },
+  { 4 * 1024 * 1024, 16, 64, CACHE_WB },
+};
+
+Cache caches[NR_CACHE_LEVEL];
+
+#define L1 (&caches[LEVEL_L1])
+#define L2 (&caches[LEVEL_L2])
+
+static const char *level_name[NR_CACHE_LEVEL] = { "l1", "l2" };
+
+void ddr3_read_me(hwaddr_t addr, void* data);
+void ddr3_write_me(hwaddr_t addr, void* data, uint8_t* mask);
+void dram_write(hwaddr_t addr, size_t len, uint32_t data);
+
+static inline uint32_t set_of(Cache *c, hwaddr_t addr) {
+  return (addr >> c->line_bit) & (c->nr_set - 1);
+}
+
+static inline uint32_t tag_of(Cache *c, hwaddr_t addr) {
+  return addr >> (c->line_bit + c->set_bit);
+}
+
+static inline uint8_t* line_of(Cache *c, int wayIndex) {
+  return c->data + (wayIndex << c->line_bit);
+}
+
+// the address of the block held by a way
+static inline hwaddr_t addr_of(Cache *c, int wayIndex) {
+  return (c->tag[wayIndex] << (c->set_bit + c->line_bit)) | ((wayIndex >> c->way_bit) << c->line_bit);
+}
+
+static inline bool is_pow2(uint32_t x) {
+  return x != 0 && (x & (x - 1)) == 0;
+}
+
+static inline int log2_of(uint32_t x) {
+  int b = 0;
+  while ((1u << b) < x) b++;
+  return b;
+}
+
+/* Parse `LEVEL:KEY=VAL,...' as given to `--cache'. Sizes may end with
+ * k or m.
+ */
+bool cache_parse(const char *arg) {
+  const char *colon = strchr(arg, ':');
+  if (colon == NULL) return false;
+  int level;
+  for (level = 0; level < NR_CACHE_LEVEL; level++) {
+    if (strlen(level_name[level]) == colon - arg && strncmp(arg, level_name[level], colon - arg) == 0) break;
+  }
+  if (level == NR_CACHE_LEVEL) return false;
+
+  Cache_config *cfg = &cache_config[level];
+  char buf[128];
+  snprintf(buf, sizeof(buf), "%s", colon + 1);
+  char *save, *kv;
+  for (kv = strtok_r(buf, ",", &save); kv != NULL; kv = strtok_r(NULL, ",", &save)) {
+    char *val = strchr(kv, '=');
+    if (val == NULL) return false;
+    *val++ = '\0';
+    if (strcmp(kv, "write") == 0) {
+      if (strcmp(val, "wb") == 0) cfg->write = CACHE_WB;
+      else if (strcmp(val, "wt") == 0) cfg->write = CACHE_WT;
+      else return false;
+      continue;
+    }
+    if (strcmp(kv, "repl") == 0) {
+      char repl[32];
+      snprintf(repl, sizeof(repl), "%s=%s", level_name[level], val);
+      if (!repl_parse(repl)) return false;
+      continue;
+    }
+
+    char *end;
+    unsigned long n = strtoul(val, &end, 0);
+    if (end == val) return false;
+    if (*end == 'k' || *end == 'K') { n <<= 10; end++; }
+    else if (*end == 'm' || *end == 'M') { n <<= 20; end++; }
+    if (*end != '\0') return false;
+
+    if (strcmp(kv, "size") == 0) cfg->size = n;
+    else if (strcmp(kv, "ways") == 0) cfg->nr_way = n;
+    else if (strcmp(kv, "line") == 0) cfg->line_size = n;
+    else return false;
   }
-  for (i = 0; i < CACHE_L2_SET_NUM * CACHE_L2_WAY_NUM; i++) {
-    cache_L2[i].dirtyVal = false;
-    cache_L2[i].validVal = false;
+  return true;
+}
+
+#define ARENA_ALIGN 64
+#define align_up(x) (((x) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static void init_level(Cache *c, int level) {
+  Cache_config *cfg = &cache_config[level];
+  Assert(is_pow2(cfg->size) && is_pow2(cfg->nr_way) && is_pow2(cfg->line_size),
+      "%s: size, ways and line must be powers of 2", level_name[level]);
+  Assert(cfg->line_size >= BURST_LEN, "%s: the line must hold a DRAM burst of %d bytes", level_name[level], BURST_LEN);
+  Assert(cfg->nr_way <= 32, "%s: at most 32 ways", level_name[level]);
+  Assert(cfg->size >= cfg->nr_way * cfg->line_size, "%s: %u bytes are less than one set", level_name[level], cfg->size);
+
+  uint32_t nr_line = cfg->size / cfg->line_size;
+  if (c->arena == NULL || c->nr_set * c->nr_way != nr_line || c->line_size != cfg->line_size) {
+    free(c->arena);
+    size_t data_size = align_up((size_t)cfg->size);
+    size_t tag_size = align_up(sizeof(uint32_t) * nr_line);
+    int ret = posix_memalign(&c->arena, ARENA_ALIGN, data_size + tag_size + nr_line);
+    Assert(ret == 0, "%s: can not allocate %u bytes", level_name[level], cfg->size);
+    c->data = c->arena;
+    c->tag = (void *)((uint8_t *)c->arena + data_size);
+    c->dirty = (uint8_t *)c->arena + data_size + tag_size;
   }
+
+  c->level = level;
+  c->nr_way = cfg->nr_way;
+  c->way_bit = log2_of(c->nr_way);
+  c->nr_set = nr_line / cfg->nr_way;
+  c->line_size = cfg->line_size;
+  c->line_bit = log2_of(c->line_size);
+  c->set_bit = log2_of(c->nr_set);
+  c->write = cfg->write;
+
+  uint32_t i;
+  for (i = 0; i < nr_line; i++) {
+    c->tag[i] = CACHE_TAG_INVALID;
+    c->dirty[i] = false;
+  }
+  repl_init(&c->repl, repl_policy[REPL_L1 + level], c->nr_set, c->nr_way);
+}
+
+void init_cache() {
+  Assert(cache_config[LEVEL_L1].line_size == cache_config[LEVEL_L2].line_size,
+      "L1 and L2 must have the same line size");
+  init_level(L1, LEVEL_L1);
+  init_level(L2, LEVEL_L2);
   return;
 }
 
-void ddr3_read_me(hwaddr_t addr, void* data);
+/* Save or load the lines of both levels. A checkpoint only loads into
+ * caches of the same configuration.
+ */
+void cache_ckpt(Ckpt *c) {
+  int l;
+  ckpt_check(c, cache_L2_mode, "L2 mode");
+  for (l = 0; l < NR_CACHE_LEVEL; l++) {
+    Cache *ca = &caches[l];
+    uint32_t nr_line = ca->nr_set * ca->nr_way;
+    ckpt_check(c, ca->nr_set, "number of cache sets");
+    ckpt_check(c, ca->nr_way, "number of cache ways");
+    ckpt_check(c, ca->line_size, "cache line size");
+    ckpt_check(c, ca->write, "cache write policy");
+    ckpt_data(c, ca->data, nr_line * ca->line_size);
+    ckpt_data(c, ca->tag, nr_line * sizeof(uint32_t));
+    ckpt_data(c, ca->dirty, nr_line);
+    repl_ckpt(c, &ca->repl);
+  }
+}
 
-// return whole index of way in cacheL1
-int read_cache_L1(hwaddr_t addr) {
-  uint32_t setIndex = ((addr >> CACHE_BLOCK_BIT) & (CACHE_L1_SET_NUM - 1));
-  uint32_t tag = (addr >> (CACHE_BLOCK_BIT + CACHE_L1_SET_BIT));
-  // uint32_t block_start = ((addr >> CACHE_BLOCK_BIT) << CACHE_BLOCK_BIT);
-
-  int wayIndex;
-  int whole_begin_wayIndex = setIndex * CACHE_L1_WAY_NUM;
-  int whole_end_wayIndex = (setIndex + 1) * CACHE_L1_WAY_NUM;
-  for (wayIndex = whole_begin_wayIndex; wayIndex < whole_end_wayIndex; wayIndex++)
-    if (cache_L1[wayIndex].validVal && cache_L1[wayIndex].tag == tag) // Hit!
-      return wayIndex;
-  // Hit loss!
-  // go to cacheL2
-  srand(time(0));
-  int wayIndex_L2 = read_cache_L2(addr);
-  wayIndex = whole_begin_wayIndex + rand() % CACHE_L1_WAY_NUM;
-  memcpy(cache_L1[wayIndex].data, cache_L2[wayIndex_L2].data, CACHE_BLOCK_SIZE);
+static void dram_read_block(Cache *c, hwaddr_t block_start, uint8_t *data) {
+  uint32_t i;
+  for (i = 0; i < c->line_size / BURST_LEN; i++) {
+    ddr3_read_me(block_start + BURST_LEN * i, data + BURST_LEN * i);
+  }
+}
+
+static void dram_write_block(Cache *c, hwaddr_t block_start, uint8_t *data) {
+  uint8_t mask[BURST_LEN << 1];
+  memset(mask, 1, sizeof(mask));
+  uint32_t i;
+  for (i = 0; i < c->line_size / BURST_LEN; i++) {
+    ddr3_write_me(block_start + BURST_LEN * i, data + BURST_LEN * i, mask);
+  }
+}
 
-  cache_L1[wayIndex].validVal = true;
-  cache_L1[wayIndex].tag = tag;
+/* Return the first way of the set whose tag is `tag', or -1. The tags
+ * of a set are compared 8 or 4 at a time. A set with at least 4 ways
+ * starts on a 16-byte boundary of the arena, one with 16 ways fills a
+ * host cache line.
+ */
+static inline int match_way(const uint32_t *t, uint32_t nr_way, uint32_t tag) {
+  uint32_t way = 0;
+#ifdef __AVX2__
+  if (nr_way >= 8) {
+    __m256i key = _mm256_set1_epi32(tag);
+    for (; way < nr_way; way += 8) {
+      __m256i eq = _mm256_cmpeq_epi32(_mm256_load_si256((const __m256i *)(t + way)), key);
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+      if (mask) return way + __builtin_ctz(mask);
+    }
+    return -1;
+  }
+#endif
+#ifdef __SSE2__
+  if (nr_way >= 4) {
+    __m128i key = _mm_set1_epi32(tag);
+    for (; way < nr_way; way += 4) {
+      __m128i eq = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)(t + way)), key);
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+      if (mask) return way + __builtin_ctz(mask);
+    }
+    return -1;
+  }
+#endif
+  for (; way < nr_way; way++)
+    if (t[way] == tag) return way;
+  return -1;
+}
+
+// return whole index of way, or -1
+static int find(Cache *c, hwaddr_t addr) {
+  uint32_t setIndex = set_of(c, addr);
+  int way = match_way(c->tag + setIndex * c->nr_way, c->nr_way, tag_of(c, addr));
+  return (way == -1 ? -1 : setIndex * c->nr_way + way);
+}
+
+// an invalid way of the set if there is one, otherwise the policy decides
+static int victim(Cache *c, uint32_t setIndex) {
+  int way = match_way(c->tag + setIndex * c->nr_way, c->nr_way, CACHE_TAG_INVALID);
+  if (way == -1) way = repl_victim(&c->repl, setIndex);
+  return setIndex * c->nr_way + way;
+}
+
+static inline void touch(Cache *c, int wayIndex) {
+  repl_touch(&c->repl, wayIndex >> c->way_bit, wayIndex & (c->nr_way - 1));
+}
+
+static inline void install(Cache *c, int wayIndex, hwaddr_t block_start, bool dirty) {
+  c->tag[wayIndex] = tag_of(c, block_start);
+  c->dirty[wayIndex] = dirty;
+  repl_fill(&c->repl, wayIndex >> c->way_bit, wayIndex & (c->nr_way - 1));
+}
+
+/* Store a whole line which L2 holds in `wayIndex'. */
+static void write_line_L2(int wayIndex, uint8_t *data) {
+  memcpy(line_of(L2, wayIndex), data, L2->line_size);
+  if (L2->write == CACHE_WB) L2->dirty[wayIndex] = true;
+  else dram_write_block(L2, addr_of(L2, wayIndex), data);
+}
+
+/* Drop an L2 line, writing it to DRAM if dirty. An inclusive L2 takes
+ * the L1 copy with it, whose data may be newer.
+ */
+static void evict_L2(int wayIndex) {
+  if (L2->tag[wayIndex] == CACHE_TAG_INVALID) return;
+  hwaddr_t block_start = addr_of(L2, wayIndex);
+  if (cache_L2_mode == CACHE_INCLUSIVE) {
+    int wayIndex_L1 = find(L1, block_start);
+    if (wayIndex_L1 != -1) {
+      stat_evict(S_L1, L1->dirty[wayIndex_L1]);
+      if (L1->dirty[wayIndex_L1]) {
+        memcpy(line_of(L2, wayIndex), line_of(L1, wayIndex_L1), L2->line_size);
+        L2->dirty[wayIndex] = true;
+      }
+      L1->tag[wayIndex_L1] = CACHE_TAG_INVALID;
+    }
+  }
+  stat_evict(S_L2, L2->dirty[wayIndex]);
+  if (L2->dirty[wayIndex]) dram_write_block(L2, block_start, line_of(L2, wayIndex));
+  L2->tag[wayIndex] = CACHE_TAG_INVALID;
+}
+
+/* Put a block which is not in L2 into it. Without `data' the block is
+ * read from DRAM.
+ */
+static int fill_L2(hwaddr_t block_start, uint8_t *data, bool dirty) {
+  int wayIndex = victim(L2, set_of(L2, block_start));
+  evict_L2(wayIndex);
+  if (data == NULL) dram_read_block(L2, block_start, line_of(L2, wayIndex));
+  else memcpy(line_of(L2, wayIndex), data, L2->line_size);
+  if (dirty && L2->write == CACHE_WT) {
+    dram_write_block(L2, block_start, data);
+    dirty = false;
+  }
+  install(L2, wayIndex, block_start, dirty);
   return wayIndex;
 }
 
-void ddr3_write_me(hwaddr_t addr, void* data, uint8_t* mask);
+/* Drop an L1 line. This is the only place where L1 data is written
+ * down: into the inclusive copy if dirty, or as a new exclusive line.
+ */
+static void evict_L1(int wayIndex) {
+  if (L1->tag[wayIndex] == CACHE_TAG_INVALID) return;
+  stat_evict(S_L1, L1->dirty[wayIndex]);
+  hwaddr_t block_start = addr_of(L1, wayIndex);
+  if (cache_L2_mode == CACHE_INCLUSIVE) {
+    if (L1->dirty[wayIndex]) {
+      int wayIndex_L2 = find(L2, block_start);
+      assert(wayIndex_L2 != -1);
+      write_line_L2(wayIndex_L2, line_of(L1, wayIndex));
+    }
+  } else {
+    fill_L2(block_start, line_of(L1, wayIndex), L1->dirty[wayIndex]);
+  }
+  L1->tag[wayIndex] = CACHE_TAG_INVALID;
+}
 
-// return whole index of way in cacheL2
-int read_cache_L2(hwaddr_t addr) {
-  uint32_t setIndex = ((addr >> CACHE_BLOCK_BIT) & (CACHE_L2_SET_NUM - 1));
-  uint32_t tag = (addr >> (CACHE_BLOCK_BIT + CACHE_L2_SET_BIT));
-  uint32_t block_start = ((addr >> CACHE_BLOCK_BIT) << CACHE_BLOCK_BIT);
-
-  int wayIndex;
-  int whole_begin_wayIndex = setIndex * CACHE_L2_WAY_NUM;
-  int whole_end_wayIndex = (setIndex + 1) * CACHE_L2_WAY_NUM;
-  for (wayIndex = whole_begin_wayIndex; wayIndex < whole_end_wayIndex; wayIndex++)
-    if (cache_L2[wayIndex].validVal && cache_L2[wayIndex].tag == tag) return wayIndex; // Hit!
+// return whole index of way in cacheL2, used when L2 is inclusive
+static int read_cache_L2(hwaddr_t block_start) {
+  int wayIndex = find(L2, block_start);
+  if (wayIndex != -1) { // Hit!
+    timing_event(T_L2_HIT);
+    stat_hit(S_L2);
+    touch(L2, wayIndex);
+    return wayIndex;
+  }
   // Hit loss!
-  srand(time(0));
-  wayIndex = whole_begin_wayIndex + rand() % CACHE_L2_WAY_NUM;
-  int i;
-  if (cache_L2[wayIndex].validVal && cache_L2[wayIndex].dirtyVal) {
-    // write down
-    uint8_t tmp[BURST_LEN << 1];
-    memset(tmp, 1, sizeof(tmp));
-    uint32_t block_start_x = (cache_L2[wayIndex].tag << (CACHE_L2_SET_BIT + CACHE_BLOCK_BIT)) | (setIndex << CACHE_BLOCK_BIT);
-    for (i = 0; i < CACHE_BLOCK_SIZE / BURST_LEN; i++) {
-      ddr3_write_me(block_start_x + BURST_LEN * i, cache_L2[wayIndex].data + BURST_LEN * i, tmp);
+  timing_event(T_L2_MISS);
+  stat_miss(S_L2);
+  return fill_L2(block_start, NULL, false);
+}
+
+// return whole index of way in cacheL1
+static int read_cache_L1(hwaddr_t addr) {
+  int wayIndex = find(L1, addr);
+  if (wayIndex != -1) { // Hit!
+    timing_event(T_L1_HIT);
+    stat_hit(S_L1);
+    touch(L1, wayIndex);
+    return wayIndex;
+  }
+  // Hit loss!
+  timing_event(T_L1_MISS);
+  stat_miss(S_L1);
+  // go to cacheL2
+  hwaddr_t block_start = addr & ~(L1->line_size - 1);
+  uint8_t block[L1->line_size];
+  bool dirty = false;
+  if (cache_L2_mode == CACHE_INCLUSIVE) {
+    memcpy(block, line_of(L2, read_cache_L2(block_start)), L1->line_size);
+  } else {
+    // take the line out of L2 before the L1 victim may replace it
+    int wayIndex_L2 = find(L2, block_start);
+    if (wayIndex_L2 != -1) {
+      timing_event(T_L2_HIT);
+      stat_hit(S_L2);
+      memcpy(block, line_of(L2, wayIndex_L2), L1->line_size);
+      dirty = L2->dirty[wayIndex_L2];
+      L2->tag[wayIndex_L2] = CACHE_TAG_INVALID;
+    } else {
+      timing_event(T_L2_MISS);
+      stat_miss(S_L2);
+      dram_read_block(L1, block_start, block);
     }
   }
-  for (i = 0; i < CACHE_BLOCK_SIZE / BURST_LEN; i++) {
-    ddr3_read_me(block_start + BURST_LEN * i, cache_L2[wayIndex].data + BURST_LEN * i);
+
+  wayIndex = victim(L1, set_of(L1, addr));
+  evict_L1(wayIndex);
+  memcpy(line_of(L1, wayIndex), block, L1->line_size);
+  if (dirty && L1->write == CACHE_WT) {
+    // the line comes from an exclusive L2 with data DRAM does not have yet
+    dram_write_block(L1, block_start, block);
+    dirty = false;
   }
-  cache_L2[wayIndex].validVal = true;
-  cache_L2[wayIndex].dirtyVal = false;
-  cache_L2[wayIndex].tag = tag;
+  install(L1, wayIndex, block_start, dirty);
   return wayIndex;
 }
 
-void dram_write(hwaddr_t addr, size_t len, uint32_t data);
+/* An access which crosses a line takes the bytes of the first line
+ * before the second line is brought in, which may evict the first.
+ */
+static uint32_t read_cache_cross(hwaddr_t addr, size_t len) {
+  size_t len1 = L1->line_size - (addr & (L1->line_size - 1));
+  uint32_t lo = 0, hi = 0;
+  memcpy(&lo, line_of(L1, read_cache_L1(addr)) + (addr & (L1->line_size - 1)), len1);
+  memcpy(&hi, line_of(L1, read_cache_L1(addr + len1)), len - len1);
+  return (hi << (len1 << 3)) | lo;
+}
 
-void write_cache_L1(hwaddr_t addr, size_t len, uint32_t data) {
-  uint32_t setIndex = ((addr >> CACHE_BLOCK_BIT) & (CACHE_L1_SET_NUM - 1));
-  uint32_t tag = (addr >> (CACHE_BLOCK_BIT + CACHE_L1_SET_BIT));
-  uint32_t block_bias = addr & (CACHE_BLOCK_SIZE - 1);
-  int wayIndex;
-  int whole_begin_wayIndex = setIndex * CACHE_L1_WAY_NUM;
-  int whole_end_wayIndex = (setIndex + 1) * CACHE_L1_WAY_NUM;
-  for (wayIndex = whole_begin_wayIndex; wayIndex < whole_end_wayIndex; wayIndex++) {
-    if (cache_L1[wayIndex].validVal && cache_L1[wayIndex].tag == tag) {
-      // Hit!
-      // write through
-      if (block_bias + len > CACHE_BLOCK_SIZE) {
-        dram_write(addr, CACHE_BLOCK_SIZE - block_bias, data);
-        memcpy(cache_L1[wayIndex].data + block_bias, &data, CACHE_BLOCK_SIZE - block_bias);
-        write_cache_L2(addr, CACHE_BLOCK_SIZE - block_bias, data);
-        write_cache_L1(addr + CACHE_BLOCK_SIZE - block_bias, len - (CACHE_BLOCK_SIZE - block_bias), data >> (CACHE_BLOCK_SIZE - block_bias));
-      } else {
-        dram_write(addr, len, data);
-        memcpy(cache_L1[wayIndex].data + block_bias, &data, len);
-        write_cache_L2(addr, len, data);
-      }
-      return;
-    }
+uint32_t read_cache(hwaddr_t addr, size_t len) {
+  uint32_t block_bias = addr & (L1->line_size - 1);
+  if (block_bias + len > L1->line_size) return read_cache_cross(addr, len);
+  uint8_t *p = line_of(L1, read_cache_L1(addr)) + block_bias;
+  if (len == 3) {
+    uint32_t data = 0;
+    memcpy(&data, p, 3);
+    return data;
   }
-  //  Hit loss!
-  // not write allocate
-  write_cache_L2(addr, len, data);
-  return;
+  return host_read(p, len);
 }
 
-void write_cache_L2(hwaddr_t addr, size_t len, uint32_t data) {
-  uint32_t setIndex = ((addr >> CACHE_BLOCK_BIT) & (CACHE_L2_SET_NUM - 1));
-  uint32_t tag = (addr >> (CACHE_BLOCK_BIT + CACHE_L2_SET_BIT));
-  uint32_t block_bias = addr & (CACHE_BLOCK_SIZE - 1);
-  int wayIndex;
-  int whole_begin_wayIndex = setIndex * CACHE_L2_WAY_NUM;
-  int whole_end_wayIndex = (setIndex + 1) * CACHE_L2_WAY_NUM;
-  for (wayIndex = whole_begin_wayIndex; wayIndex < whole_end_wayIndex; wayIndex++) {
-    if (cache_L2[wayIndex].validVal && cache_L2[wayIndex].tag == tag) {
-      // Hit!
-      // write back
-      cache_L2[wayIndex].dirtyVal = true;
-      if (block_bias + len > CACHE_BLOCK_SIZE) {
-        memcpy(cache_L2[wayIndex].data + block_bias, &data, CACHE_BLOCK_SIZE - block_bias);
-        write_cache_L2(addr + CACHE_BLOCK_SIZE - block_bias, len - (CACHE_BLOCK_SIZE - block_bias), data >> (CACHE_BLOCK_SIZE - block_bias));
-      } else {
-        memcpy(cache_L2[wayIndex].data + block_bias, &data, len);
-      }
-      return;
-    }
+/* A write-through L1 passes the store on to L2 without allocating. */
+static void write_through_L1(hwaddr_t addr, size_t len, uint32_t data) {
+  int wayIndex = find(L2, addr);
+  if (wayIndex == -1) {
+    timing_event(T_L2_MISS);
+    stat_miss(S_L2);
+    dram_write(addr, len, data);
+    return;
   }
-  //  Hit loss!
+  timing_event(T_L2_HIT);
+  stat_hit(S_L2);
+  touch(L2, wayIndex);
+  memcpy(line_of(L2, wayIndex) + (addr & (L2->line_size - 1)), &data, len);
+  if (L2->write == CACHE_WB) L2->dirty[wayIndex] = true;
+  else dram_write(addr, len, data);
+}
+
+/* Store `len' bytes which lie in one line. */
+static void write_cache_line(hwaddr_t addr, size_t len, uint32_t data) {
   // write allocate
-  wayIndex = read_cache_L2(addr);
-  cache_L2[wayIndex].dirtyVal = true;
-  memcpy(cache_L2[wayIndex].data + block_bias, &data, len);
-  return;
+  int wayIndex = read_cache_L1(addr);
+  uint8_t *p = line_of(L1, wayIndex) + (addr & (L1->line_size - 1));
+  if (len == 3) memcpy(p, &data, 3);
+  else host_write(p, len, data);
+  if (L1->write == CACHE_WB) L1->dirty[wayIndex] = true;
+  else write_through_L1(addr, len, data);
+}
+
+void write_cache(hwaddr_t addr, size_t len, uint32_t data) {
+  uint32_t block_bias = addr & (L1->line_size - 1);
+  if (block_bias + len > L1->line_size) {
+    size_t len1 = L1->line_size - block_bias;
+    write_cache_line(addr, len1, data);
+    write_cache_line(addr + len1, len - len1, data >> (len1 << 3));
+  }
+  else write_cache_line(addr, len, data);
+}
+
+/* Write all dirty lines down, so that DRAM holds the current contents
+ * of memory. The lines stay cached.
+ */
+void flush_cache() {
+  // not part of the program's time
+  timing_mute++;
+  uint32_t i;
+  for (i = 0; i < L1->nr_set * L1->nr_way; i++) {
+    if (L1->tag[i] == CACHE_TAG_INVALID || !L1->dirty[i]) continue;
+    if (cache_L2_mode == CACHE_INCLUSIVE) {
+      int wayIndex_L2 = find(L2, addr_of(L1, i));
+      assert(wayIndex_L2 != -1);
+      write_line_L2(wayIndex_L2, line_of(L1, i));
+    } else {
+      dram_write_block(L1, addr_of(L1, i), line_of(L1, i));
+    }
+    L1->dirty[i] = false;
+  }
+  for (i = 0; i < L2->nr_set * L2->nr_way; i++) {
+    if (L2->tag[i] != CACHE_TAG_INVALID && L2->dirty[i]) {
+      dram_write_block(L2, addr_of(L2, i), line_of(L2, i));
+      L2->dirty[i] = false;
+    }
+  }
+  timing_mute--;
 }
@@ -0,0 +1,42 @@
+#include "common.h"
+#include "memory/dirty.h"
+#include "memory/memory.h"
+#include <stdlib.h>
+
+#define NR_PAGE (HW_MEM_SIZE >> 12)
+#define NR_WORD ((NR_PAGE + 63) / 64)
+
+uint64_t *dirty_bitmap = NULL;
+
+/* the page numbers returned by the last dirty_collect() */
+static uint32_t *dirty_list = NULL;
+
+void init_dirty() {
+	free(dirty_bitmap);
+	free(dirty_list);
+	dirty_bitmap = calloc(NR_WORD, sizeof(uint64_t));
+	dirty_list = malloc(NR_PAGE * sizeof(uint32_t));
+	Assert(dirty_bitmap && dirty_list, "Can not allocate the dirty page bitmap");
+}
+
+/* Return the number of pages written since the last call, and point
+ * `pages' to their numbers in increasing order. The array stays valid
+ * until the next call. The set starts empty again.
+ */
+uint32_t dirty_collect(const uint32_t **pages) {
+	uint32_t nr = 0, i;
+	for(i = 0; i < NR_WORD; i ++) {
+		uint64_t w = dirty_bitmap[i];
+		dirty_bitmap[i] = 0;
+		while(w != 0) {
+			dirty_list[nr ++] = (i << 6) + __builtin_ctzll(w);
+			w &= w - 1;
+		}
+	}
+
+	/* writable soft-TLB entries must mark their pages again */
+	soft_tlb_flush();
+
+	*pages = dirty_list;
+	return nr;
+}
@@ -1,6 +1,15 @@
 #include "common.h"
 #include "burst.h"
 #include "misc.h"
+#include "memory/memory.h"
+#include "memory/dirty.h"
+#include "monitor/timing.h"
+#include "monitor/checkpoint.h"
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /* Simulate the (main) behavor of DRAM.
  * Although this will lower the performace of NEMU, it makes
@@ -11,7 +20,7 @@
 #define COL_WIDTH 10
 #define ROW_WIDTH 10
 #define BANK_WIDTH 3
-#define RANK_WIDTH (27 - COL_WIDTH - ROW_WIDTH - BANK_WIDTH)
+#define RANK_WIDTH (32 - COL_WIDTH - ROW_WIDTH - BANK_WIDTH)
 
 typedef union {
 	struct {
@@ -27,12 +36,39 @@ typedef union {
 #define NR_COL (1 << COL_WIDTH)
 #define NR_ROW (1 << ROW_WIDTH)
 #define NR_BANK (1 << BANK_WIDTH)
-#define NR_RANK (1 << RANK_WIDTH)
+#define RANK_SIZE (1 << (COL_WIDTH + ROW_WIDTH + BANK_WIDTH))
 
-#define HW_MEM_SIZE (1 << (COL_WIDTH + ROW_WIDTH + BANK_WIDTH + RANK_WIDTH))
+uint8_t *hw_mem = NULL;
+uint32_t hw_mem_size = 128 * 1024 * 1024;
+char *hw_mem_file = NULL;
 
-uint8_t dram[NR_RANK][NR_BANK][NR_ROW][NR_COL];
-uint8_t *hw_mem = (void *)dram;
+/* the row `row' of a bank as it is stored in `hw_mem' */
+#define dram_row(rank, bank, row) \
+	(hw_mem + (((((rank) << BANK_WIDTH) | (bank)) << ROW_WIDTH | (row)) << COL_WIDTH))
+
+/* Guest memory is an anonymous private mapping, so a page costs host
+ * memory only once the guest touches it. With `--mem-file' the start
+ * of it maps the file copy-on-write instead, and NEMU processes which
+ * load the same image share its pages until they write to them.
+ */
+void init_hw_mem() {
+	/* called again, this replaces the old contents at the same address */
+	int fixed = (hw_mem != NULL ? MAP_FIXED : 0);
+	hw_mem = mmap(hw_mem, hw_mem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | fixed, -1, 0);
+	Assert(hw_mem != MAP_FAILED, "Can not map %u bytes of guest memory", hw_mem_size);
+	if(hw_mem_file == NULL) { return; }
+
+	int fd = open(hw_mem_file, O_RDONLY);
+	Assert(fd >= 0, "Can not open '%s'", hw_mem_file);
+	struct stat st;
+	Assert(fstat(fd, &st) == 0, "Can not stat '%s'", hw_mem_file);
+	Assert(st.st_size <= hw_mem_size, "'%s' is larger than the guest memory", hw_mem_file);
+	if(st.st_size > 0) {
+		void *p = mmap(hw_mem, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+		Assert(p == hw_mem, "Can not map '%s'", hw_mem_file);
+	}
+	close(fd);
+}
 
 typedef struct {
 	uint8_t buf[NR_COL];
@@ -40,15 +76,19 @@ typedef struct {
 	bool valid;
 } RB;
 
-RB rowbufs[NR_RANK][NR_BANK];
+/* one row buffer per bank of each rank that holds guest memory */
+static RB (*rowbufs)[NR_BANK] = NULL;
 
 void init_ddr3() {
-	int i, j;
-	for(i = 0; i < NR_RANK; i ++) {
-		for(j = 0; j < NR_BANK; j ++) {
-			rowbufs[i][j].valid = false;
-		}
-	}
+	int nr_rank = (hw_mem_size + RANK_SIZE - 1) / RANK_SIZE;
+	free(rowbufs);
+	rowbufs = calloc(nr_rank, sizeof(*rowbufs));
+	Assert(rowbufs, "Can not allocate the row buffers");
+}
+
+void ddr3_ckpt(Ckpt *c) {
+	int nr_rank = (hw_mem_size + RANK_SIZE - 1) / RANK_SIZE;
+	ckpt_data(c, rowbufs, nr_rank * sizeof(*rowbufs));
 }
 
 static void ddr3_read(hwaddr_t addr, void *data) {
@@ -63,10 +103,12 @@ static void ddr3_read(hwaddr_t addr, void *data) {
 
 	if(!(rowbufs[rank][bank].valid && rowbufs[rank][bank].row_idx == row) ) {
 		/* read a row into row buffer */
-		memcpy(rowbufs[rank][bank].buf, dram[rank][bank][row], NR_COL);
+		timing_event(T_ROW_MISS);
+		memcpy(rowbufs[rank][bank].buf, dram_row(rank, bank, row), NR_COL);
 		rowbufs[rank][bank].row_idx = row;
 		rowbufs[rank][bank].valid = true;
 	}
+	else { timing_event(T_ROW_HIT); }
 
 	/* burst read */
 	memcpy(data, rowbufs[rank][bank].buf + col, BURST_LEN);
@@ -84,16 +126,19 @@ static void ddr3_write(hwaddr_t addr, void *data, uint8_t *mask) {
 
 	if(!(rowbufs[rank][bank].valid && rowbufs[rank][bank].row_idx == row) ) {
 		/* read a row into row buffer */
-		memcpy(rowbufs[rank][bank].buf, dram[rank][bank][row], NR_COL);
+		timing_event(T_ROW_MISS);
+		memcpy(rowbufs[rank][bank].buf, dram_row(rank, bank, row), NR_COL);
 		rowbufs[rank][bank].row_idx = row;
 		rowbufs[rank][bank].valid = true;
 	}
+	else { timing_event(T_ROW_HIT); }
 
 	/* burst write */
 	memcpy_with_mask(rowbufs[rank][bank].buf + col, data, BURST_LEN, mask);
 
 	/* write back to dram */
-	memcpy(dram[rank][bank][row], rowbufs[rank][bank].buf, NR_COL);
+	memcpy(dram_row(rank, bank, row), rowbufs[rank][bank].buf, NR_COL);
+	dirty_mark(addr & ~BURST_MASK, BURST_LEN);
 }
 
 uint32_t dram_read(hwaddr_t addr, size_t len) {
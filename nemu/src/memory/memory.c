@@ -3,6 +3,13 @@
 #include "memory/cache.h"
 #include "nemu.h"
 #include "burst.h"
+#include "cpu/decode/decode-cache.h"
+#include "device/mmio.h"
+#include "monitor/timing.h"
+#include "memory/stats.h"
+#include "memory/dirty.h"
+#include "monitor/monitor.h"
+#include "cpu/intr.h"
 
 uint32_t dram_read(hwaddr_t, size_t);
 void dram_write(hwaddr_t, size_t, uint32_t);
@@ -14,89 +21,304 @@ lnaddr_t seg_translate(swaddr_t addr, size_t len, uint8_t sreg_id) {
   }
 }
 
-hwaddr_t page_translate(lnaddr_t addr) {
-  if (cpu.cr0.protect_enable == 1 && cpu.cr0.paging == 1) {
-    uint32_t dir = addr >> 22;
-    uint32_t page = (addr >> 12) & 0x3ff;
-    uint32_t bias = addr & 0xfff;
+/* the TLB entry used by the last page_translate(), -1 without paging */
+static int last_tlb_index;
 
-    int i = read_tlb(addr);
-    if (i != -1) return (tlb[i].page_num << 12) + bias;
+/* page fault error code */
+#define PF_PROTECT 0x1
+#define PF_WRITE 0x2
+
+/* A page fault sets CR2 and enters the handler of exception 14, which
+ * returns to the faulting instruction. The monitor's own accesses have
+ * no program to take them.
+ */
+static void page_fault(lnaddr_t addr, uint32_t error_code) {
+  Assert(nemu_state == RUNNING, "page fault at address 0x%08x, error code 0x%x", addr, error_code);
+  cpu.cr2 = addr;
+  raise_intr_error(14, error_code);
+}
+
+/* Set the accessed bit, and the dirty bit for a write, of the entry at
+ * `entry_addr' if it does not have them yet.
+ */
+static inline void update_ad(hwaddr_t entry_addr, Page_Descriptor *entry, bool write) {
+  if (entry->a && (entry->d || !write)) return;
+  entry->a = 1;
+  if (write) entry->d = 1;
+  hwaddr_write(entry_addr, 4, entry->val);
+}
 
-    uint32_t dir_start = cpu.cr3.page_directory_base;
-    uint32_t dir_position = (dir_start << 12) + (dir << 2);
-    Page_Descriptor first_content;
+/* Walk the page tables for a TLB miss, or for the first write through a
+ * TLB entry whose page is not dirty yet. Page directory entries which
+ * point to page tables come from the page-walk cache when they can.
+ */
+static hwaddr_t page_walk(lnaddr_t addr, bool write) {
+  uint32_t dir = addr >> 22;
+  uint32_t page = (addr >> 12) & 0x3ff;
+  hwaddr_t dir_position = (cpu.cr3.page_directory_base << 12) + (dir << 2);
+  bool wp = cpu.cr0.write_protect;
+
+  /* the G bit of an entry means nothing unless CR4.PGE is set */
+  bool pge = cpu.cr4.page_global_enable;
+
+  Page_Descriptor first_content;
+  if (!read_pwc(dir, &first_content.val)) {
     first_content.val = hwaddr_read(dir_position, 4);
-    Assert(first_content.p == 1, "Page unavailable");
-    uint32_t page_start = first_content.addr;
-    uint32_t page_pos = (page_start << 12) + (page << 2);
-    Page_Descriptor second_content;
-    second_content.val =  hwaddr_read(page_pos, 4);
-    Assert(second_content.p == 1, "Page unavailable");
-    uint32_t addr_start = second_content.addr;
-    hwaddr_t hwaddr = (addr_start << 12) + bias;
-    write_tlb(addr, hwaddr);
+    timing_event(T_WALK);
+    if (first_content.p == 0) page_fault(addr, (write ? PF_WRITE : 0));
+
+    if (!(first_content.ps && cpu.cr4.page_size_ext)) {
+      update_ad(dir_position, &first_content, false);
+      write_pwc(dir, first_content.val);
+    }
+  }
+
+  if (first_content.ps && cpu.cr4.page_size_ext) {
+    /* a 4MB page */
+    if (write && wp && first_content.rw == 0) page_fault(addr, PF_PROTECT | PF_WRITE);
+    update_ad(dir_position, &first_content, write);
+    hwaddr_t hwaddr = (first_content.val & ~0x3fffff) | (addr & 0x3fffff);
+    last_tlb_index = write_tlb(addr, hwaddr, pge && first_content.g, true, first_content.d);
     return hwaddr;
+  }
+
+  hwaddr_t page_pos = (first_content.addr << 12) + (page << 2);
+  Page_Descriptor second_content;
+  second_content.val = hwaddr_read(page_pos, 4);
+  timing_event(T_WALK);
+  if (second_content.p == 0) page_fault(addr, (write ? PF_WRITE : 0));
+  if (write && wp && (first_content.rw == 0 || second_content.rw == 0)) page_fault(addr, PF_PROTECT | PF_WRITE);
+  update_ad(page_pos, &second_content, write);
+
+  hwaddr_t hwaddr = (second_content.addr << 12) + (addr & 0xfff);
+  last_tlb_index = write_tlb(addr, hwaddr, pge && second_content.g, false, second_content.d);
+  return hwaddr;
+}
+
+hwaddr_t page_translate(lnaddr_t addr, bool write) {
+  if (cpu.cr0.protect_enable == 1 && cpu.cr0.paging == 1) {
+    int i = read_tlb(addr);
+    if (i != -1 && (tlb[i].dirty || !write)) {
+      last_tlb_index = i;
+      return tlb_translate(i, addr);
+    }
+
+    if (i == -1) {
+      timing_event(T_TLB_MISS);
+      return page_walk(addr, write);
+    }
+
+    /* the walk refreshes the entry that was hit */
+    tlb[i].valid_value = false;
+    return page_walk(addr, write);
   } else {
+    last_tlb_index = -1;
     return addr;
   }
 }
 
 
+int mem_model = MEM_FAST;
+
 /* Memory accessing interfaces */
 
+#define check_hwaddr(addr, len) \
+  Assert(addr <= HW_MEM_SIZE - len, "physical address(0x%08x) is out of bound", addr)
+
 uint32_t hwaddr_read(hwaddr_t addr, size_t len) {
-  int cache_L1_way_1_index = read_cache_L1(addr);
-  uint32_t block_bias = addr & (CACHE_BLOCK_SIZE - 1);
-  uint8_t ret[BURST_LEN << 1];
-  //printf("%d\n", block_bias);
-  if (block_bias + len > CACHE_BLOCK_SIZE) {
-    int cache_L1_way_2_index = read_cache_L1(addr + CACHE_BLOCK_SIZE - block_bias);
-    memcpy(ret, cache_L1[cache_L1_way_1_index].data + block_bias, CACHE_BLOCK_SIZE - block_bias);
-    memcpy(ret  + CACHE_BLOCK_SIZE - block_bias, cache_L1[cache_L1_way_2_index].data, len - (CACHE_BLOCK_SIZE - block_bias));
-  } else {
-    memcpy(ret, cache_L1[cache_L1_way_1_index].data + block_bias, len);
-  }
-  int tmp = 0;
-  uint32_t ans = unalign_rw(ret + tmp, 4) & (~0u >> ((4 - len) << 3));
-  return ans;
+  if (mem_model == MEM_CACHE) return read_cache(addr, len);
+
+  check_hwaddr(addr, len);
+  return host_read(hwa_to_va(addr), len);
 }
 
 void hwaddr_write(hwaddr_t addr, size_t len, uint32_t data) {
-  write_cache_L1(addr, len, data);
+  decode_cache_check_write(addr, len);
+  if (mem_model == MEM_CACHE) {
+    write_cache(addr, len, data);
+    dirty_mark(addr, len);
+    return;
+  }
+
+  check_hwaddr(addr, len);
+  host_write(hwa_to_va(addr), len, data);
+  dirty_mark(addr, len);
 }
 
-uint32_t lnaddr_read(lnaddr_t addr, size_t len) {
-  assert(len == 1 || len == 2 || len == 4);
-  uint32_t cur_bias = addr & 0xfff;
-  if (cur_bias + len - 1 > 0xfff) {
-    //assert(0); depend on the mechine
-    size_t len1 = 0xfff - cur_bias + 1;
-    size_t len2 = len - len1;
-    uint32_t addr_len1 = lnaddr_read(addr, len1);
-    uint32_t addr_len2 = lnaddr_read(addr + len1, len2);
-    uint32_t value = (addr_len2 << (len1 << 3)) | addr_len1;
-    return value;
+/* The pieces of an access which crosses a page may be 3 bytes long. */
+static uint32_t hwaddr_read_piece(hwaddr_t addr, size_t len) {
+  if (len == 3) return hwaddr_read(addr, 2) | (hwaddr_read(addr + 2, 1) << 16);
+  return hwaddr_read(addr, len);
+}
 
-  } else {
-    hwaddr_t hwaddr = page_translate(addr);
-    return hwaddr_read(hwaddr, len);
+static void hwaddr_write_piece(hwaddr_t addr, size_t len, uint32_t data) {
+  if (len == 3) {
+    hwaddr_write(addr, 2, data);
+    hwaddr_write(addr + 2, 1, data >> 16);
   }
+  else hwaddr_write(addr, len, data);
+}
+
+/* An access which crosses a page translates both pages before touching
+ * memory, so that a fault on the second page leaves the first one alone.
+ */
+static uint32_t lnaddr_read_cross(lnaddr_t addr, size_t len) {
+  size_t len1 = 0x1000 - (addr & 0xfff);
+  hwaddr_t hwaddr1 = page_translate(addr, false);
+  hwaddr_t hwaddr2 = page_translate(addr + len1, false);
+  uint32_t lo = hwaddr_read_piece(hwaddr1, len1);
+  uint32_t hi = hwaddr_read_piece(hwaddr2, len - len1);
+  return (hi << (len1 << 3)) | lo;
+}
+
+static void lnaddr_write_cross(lnaddr_t addr, size_t len, uint32_t data) {
+  size_t len1 = 0x1000 - (addr & 0xfff);
+  hwaddr_t hwaddr1 = page_translate(addr, true);
+  hwaddr_t hwaddr2 = page_translate(addr + len1, true);
+  hwaddr_write_piece(hwaddr1, len1, data);
+  hwaddr_write_piece(hwaddr2, len - len1, data >> (len1 << 3));
+}
+
+uint32_t lnaddr_read(lnaddr_t addr, size_t len) {
+  assert(len == 1 || len == 2 || len == 4);
+  if ((addr & 0xfff) + len > 0x1000) return lnaddr_read_cross(addr, len);
+  return hwaddr_read(page_translate(addr, false), len);
 }
 
 void lnaddr_write(lnaddr_t addr, size_t len, uint32_t data) {
   assert(len == 1 || len == 2 || len == 4);
-  uint32_t cur_bias = addr & 0xfff;
-  if (cur_bias + len - 1 > 0xfff) {
-    //assert(0); depend on the mechine
-    size_t len1 = 0xfff - cur_bias + 1;
-    size_t len2 = len - len1;
-    lnaddr_write(addr, len1, data & ((1 << (len1 << 3)) - 1));
-    lnaddr_write(addr + len1, len2, data >> (len1 << 3));
-  } else {
-    hwaddr_t hwaddr = page_translate(addr);
-    hwaddr_write(hwaddr, len, data);
+  if ((addr & 0xfff) + len > 0x1000) lnaddr_write_cross(addr, len, data);
+  else hwaddr_write(page_translate(addr, true), len, data);
+}
+
+/* Soft-TLB, see memory/memory.h */
+
+#define SOFT_TLB_INVALID 1u
+
+Soft_TLB soft_tlb[SOFT_TLB_SIZE];
+
+static inline void soft_tlb_clear(Soft_TLB *e) {
+  e->tag_read = e->tag_write = e->tag_fetch = e->page = SOFT_TLB_INVALID;
+}
+
+Instr_window instr_window;
+
+void soft_tlb_flush() {
+  int i;
+  for (i = 0; i < SOFT_TLB_SIZE; i++) {
+    soft_tlb_clear(&soft_tlb[i]);
+  }
+  /* the translation of the window may be changing */
+  instr_window.len = 0;
+}
+
+static inline Soft_TLB* soft_tlb_entry(lnaddr_t addr) {
+  return &soft_tlb[(addr >> 12) & (SOFT_TLB_SIZE - 1)];
+}
+
+/* Called when the TLB model evicts the page at `addr'. */
+void soft_tlb_invalidate(lnaddr_t addr) {
+  Soft_TLB *e = soft_tlb_entry(addr);
+  if (e->page == (addr & ~0xfff)) soft_tlb_clear(e);
+}
+
+/* Translate the page of `addr' and fill its entry if the access does
+ * not cross the page. Return false if the page can not be accessed
+ * through a host pointer.
+ */
+static bool soft_tlb_fill(Soft_TLB *e, lnaddr_t addr, size_t len, bool write, lnaddr_t *tag) {
+  lnaddr_t page = addr & ~0xfff;
+  if (((addr + len - 1) & ~0xfff) != page) return false;
+
+  /* translate `addr' itself, so that a page fault reports it in CR2 */
+  hwaddr_t hwpage = page_translate(addr, write) & ~0xfff;
+  if (hwpage >= HW_MEM_SIZE || is_mmio_page(hwpage)) return false;
+
+  if (e->page != page) {
+    soft_tlb_clear(e);
+    e->page = page;
+  }
+  e->addend = (uintptr_t)hwa_to_va(hwpage) - page;
+  /* stores through the entry are not marked one by one */
+  if (write) dirty_mark_page(hwpage >> 12);
+  e->tlb_index = last_tlb_index;
+  *tag = page;
+  return true;
+}
+
+/* An access through an entry stays inside one page of RAM, so the fast
+ * model loads and stores through the host pointer without a bounds
+ * check. With the cache model the data still goes through hwaddr_read
+ * and hwaddr_write, since the caches may hold newer contents than
+ * `hw_mem'.
+ */
+#define soft_tlb_hwaddr(e, addr) va_to_hwa((uint8_t *)((e)->addend + (addr)))
+
+static inline uint32_t soft_tlb_read(Soft_TLB *e, lnaddr_t addr, size_t len) {
+  if (mem_model == MEM_FAST) return host_read((void *)(e->addend + addr), len);
+  return hwaddr_read(soft_tlb_hwaddr(e, addr), len);
+}
+
+static inline void soft_tlb_write(Soft_TLB *e, lnaddr_t addr, size_t len, uint32_t data) {
+  if (mem_model == MEM_FAST) {
+    decode_cache_check_write(soft_tlb_hwaddr(e, addr), len);
+    host_write((void *)(e->addend + addr), len, data);
   }
+  else hwaddr_write(soft_tlb_hwaddr(e, addr), len, data);
+}
+
+/* keep the TLB model informed about hits */
+#define soft_tlb_hit(e) do { if ((e)->tlb_index != -1) touch_tlb((e)->tlb_index); } while (0)
+
+static inline uint32_t fetch(swaddr_t addr, size_t len) {
+  lnaddr_t lnaddr = seg_translate(addr, len, R_CS);
+  Soft_TLB *e = soft_tlb_entry(lnaddr);
+  if (e->tag_fetch == ((lnaddr + len - 1) & ~0xfff)) {
+    soft_tlb_hit(e);
+    return soft_tlb_read(e, lnaddr, len);
+  }
+  if (soft_tlb_fill(e, lnaddr, len, false, &e->tag_fetch)) return soft_tlb_read(e, lnaddr, len);
+  return lnaddr_read(lnaddr, len);
+}
+
+void instr_window_fetch(swaddr_t eip) {
+  instr_window.eip = eip;
+  instr_window.len = 0;
+  /* the caches may hold newer code than `hw_mem' */
+  if (mem_model != MEM_FAST) return;
+
+  lnaddr_t lnaddr = seg_translate(eip, 1, R_CS);
+  Soft_TLB *e = soft_tlb_entry(lnaddr);
+  if (e->tag_fetch == (lnaddr & ~0xfff)) soft_tlb_hit(e);
+  else if (!soft_tlb_fill(e, lnaddr, 1, false, &e->tag_fetch)) return;
+
+  uint32_t left = 0x1000 - (lnaddr & 0xfff);
+  instr_window.host = (const uint8_t *)(e->addend + lnaddr);
+  instr_window.len = (left < INSTR_WINDOW_SIZE ? left : INSTR_WINDOW_SIZE);
+}
+
+uint32_t swaddr_fetch(swaddr_t addr, size_t len) {
+  /* the timing model charges whole instructions in timing_fetch() */
+  if (timing_on) timing_mute++;
+  access_kind = ACC_FETCH;
+  uint32_t ret = fetch(addr, len);
+  access_kind = ACC_DATA;
+  if (timing_on) timing_mute--;
+  return ret;
+}
+
+/* Fetch the instruction at `eip' once more for the timing model, with
+ * one access to each cache line it covers. Its misses are attributed
+ * to `eip' rather than the next instruction.
+ */
+void timing_fetch(swaddr_t eip, int len) {
+  swaddr_t eip_next = cpu.eip;
+  cpu.eip = eip;
+  access_kind = ACC_FETCH;
+  fetch(eip, 1);
+  if ((eip ^ (eip + len - 1)) & ~(caches[LEVEL_L1].line_size - 1)) fetch(eip + len - 1, 1);
+  access_kind = ACC_DATA;
+  cpu.eip = eip_next;
 }
 
 uint32_t swaddr_read(swaddr_t addr, size_t len) {
@@ -104,6 +326,12 @@ uint32_t swaddr_read(swaddr_t addr, size_t len) {
   assert(len == 1 || len == 2 || len == 4);
 #endif
   lnaddr_t lnaddr = seg_translate(addr, len, current_sreg);
+  Soft_TLB *e = soft_tlb_entry(lnaddr);
+  if (e->tag_read == ((lnaddr + len - 1) & ~0xfff)) {
+    soft_tlb_hit(e);
+    return soft_tlb_read(e, lnaddr, len);
+  }
+  if (soft_tlb_fill(e, lnaddr, len, false, &e->tag_read)) return soft_tlb_read(e, lnaddr, len);
   return lnaddr_read(lnaddr, len);
 }
 
@@ -112,5 +340,24 @@ void swaddr_write(swaddr_t addr, size_t len, uint32_t data) {
   assert(len == 1 || len == 2 || len == 4);
 #endif
   lnaddr_t lnaddr = seg_translate(addr, len, current_sreg);
-  lnaddr_write(lnaddr, len, data);
-}
\ No newline at end of file
+  Soft_TLB *e = soft_tlb_entry(lnaddr);
+  if (e->tag_write == ((lnaddr + len - 1) & ~0xfff)) {
+    soft_tlb_hit(e);
+    soft_tlb_write(e, lnaddr, len, data);
+  }
+  else if (soft_tlb_fill(e, lnaddr, len, true, &e->tag_write)) soft_tlb_write(e, lnaddr, len, data);
+  else lnaddr_write(lnaddr, len, data);
+}
+
+void* swaddr_host(swaddr_t addr, size_t len, bool write) {
+  if (mem_model != MEM_FAST) return NULL;
+  lnaddr_t lnaddr = seg_translate(addr, len, current_sreg);
+  Soft_TLB *e = soft_tlb_entry(lnaddr);
+  lnaddr_t *tag = (write ? &e->tag_write : &e->tag_read);
+  if (*tag == ((lnaddr + len - 1) & ~0xfff)) soft_tlb_hit(e);
+  else if (!soft_tlb_fill(e, lnaddr, len, write, tag)) return NULL;
+
+  /* the caller is going to store to all of the bytes */
+  if (write) decode_cache_check_write(soft_tlb_hwaddr(e, lnaddr), len);
+  return (void *)(e->addend + lnaddr);
+}
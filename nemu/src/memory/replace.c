@@ -0,0 +1,94 @@
+#include "memory/replace.h"
+#include <stdlib.h>
+
+int repl_policy[NR_REPL_STRUCT] = { REPL_PLRU, REPL_PLRU, REPL_PLRU };
+uint64_t repl_seed = 0x2545f4914f6cdd1dull;
+const char *repl_name[NR_REPL_POLICY] = { "plru", "lru", "srrip", "random" };
+
+static const char *struct_name[NR_REPL_STRUCT] = { "l1", "l2", "tlb" };
+
+void repl_init(Repl *r, int policy, int nr_set, int nr_way) {
+	assert((nr_way & (nr_way - 1)) == 0 && nr_way <= 32);
+	r->policy = policy;
+	r->nr_set = nr_set;
+	r->nr_way = nr_way;
+	for(r->way_bit = 0; (1 << r->way_bit) < nr_way; r->way_bit ++);
+
+	free(r->state);
+	r->state = malloc(sizeof(uint64_t) * nr_set * nr_way);
+	assert(r->state);
+	int i;
+	for(i = 0; i < nr_set * nr_way; i ++) {
+		r->state[i] = (policy == REPL_SRRIP ? SRRIP_MAX : 0);
+	}
+	r->clock = 0;
+	/* xorshift must not start from 0 */
+	r->rand = (repl_seed != 0 ? repl_seed : 1);
+}
+
+/* The geometry is given by the owner, which has checked it already. */
+void repl_ckpt(Ckpt *c, Repl *r) {
+	ckpt_check(c, r->policy, "replacement policy");
+	ckpt_data(c, r->state, sizeof(uint64_t) * r->nr_set * r->nr_way);
+	ckpt_data(c, &r->clock, sizeof(r->clock));
+	ckpt_data(c, &r->rand, sizeof(r->rand));
+}
+
+static inline uint64_t xorshift64(uint64_t *x) {
+	*x ^= *x << 13;
+	*x ^= *x >> 7;
+	*x ^= *x << 17;
+	return *x;
+}
+
+int repl_victim(Repl *r, int set) {
+	uint64_t *s = r->state + set * r->nr_way;
+	int i, node, victim;
+	switch(r->policy) {
+		case REPL_PLRU:
+			for(node = 1, i = 0; i < r->way_bit; i ++) {
+				node = (node << 1) | ((s[0] >> node) & 1);
+			}
+			return node - r->nr_way;
+		case REPL_LRU:
+			for(victim = 0, i = 1; i < r->nr_way; i ++) {
+				if(s[i] < s[victim]) { victim = i; }
+			}
+			return victim;
+		case REPL_SRRIP:
+			while(1) {
+				for(i = 0; i < r->nr_way; i ++) {
+					if(s[i] == SRRIP_MAX) { return i; }
+				}
+				for(i = 0; i < r->nr_way; i ++) { s[i] ++; }
+			}
+		default:
+			return xorshift64(&r->rand) & (r->nr_way - 1);
+	}
+}
+
+void repl_fill(Repl *r, int set, int way) {
+	if(r->policy == REPL_SRRIP) {
+		/* insert with a long re-reference interval */
+		r->state[set * r->nr_way + way] = SRRIP_MAX - 1;
+	}
+	else { repl_touch(r, set, way); }
+}
+
+/* Parse `STRUCT=POLICY' as given to `--repl'. */
+bool repl_parse(const char *arg) {
+	const char *eq = strchr(arg, '=');
+	if(eq == NULL) { return false; }
+	int i, j;
+	for(i = 0; i < NR_REPL_STRUCT; i ++) {
+		if(strlen(struct_name[i]) == eq - arg && strncmp(arg, struct_name[i], eq - arg) == 0) {
+			for(j = 0; j < NR_REPL_POLICY; j ++) {
+				if(strcmp(eq + 1, repl_name[j]) == 0) {
+					repl_policy[i] = j;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
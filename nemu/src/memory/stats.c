@@ -0,0 +1,226 @@
+#include "nemu.h"
+#include "memory/stats.h"
+#include "memory/cache.h"
+#include "memory/tlb.h"
+#include "memory/replace.h"
+#include "monitor/elf.h"
+#include <stdlib.h>
+
+Mem_stat mem_stat[NR_S_LEVEL][NR_ACC];
+int access_kind = ACC_DATA;
+const char *stats_file = NULL;
+
+static const char *level_name[NR_S_LEVEL] = { "L1", "L2", "TLB" };
+static const char *kind_name[NR_ACC] = { "data", "fetch" };
+
+/* misses per EIP, in an open addressing hash table */
+typedef struct {
+	swaddr_t eip;
+	bool used;
+	uint64_t miss[NR_S_LEVEL];
+} PC_stat;
+
+#define PC_TABLE_INIT_BIT 10
+
+static PC_stat *pc_table;
+static uint32_t pc_table_size, nr_pc;
+
+static inline uint32_t pc_hash(swaddr_t eip) {
+	return (eip * 2654435761u) & (pc_table_size - 1);
+}
+
+static PC_stat* pc_find(swaddr_t eip) {
+	uint32_t i = pc_hash(eip);
+	while(pc_table[i].used && pc_table[i].eip != eip) {
+		i = (i + 1) & (pc_table_size - 1);
+	}
+	return &pc_table[i];
+}
+
+static void pc_table_init(uint32_t size) {
+	pc_table_size = size;
+	pc_table = calloc(size, sizeof(PC_stat));
+	assert(pc_table);
+}
+
+static void pc_table_grow() {
+	PC_stat *old = pc_table;
+	uint32_t old_size = pc_table_size, i;
+	pc_table_init(old_size * 2);
+	for(i = 0; i < old_size; i ++) {
+		if(old[i].used) { *pc_find(old[i].eip) = old[i]; }
+	}
+	free(old);
+}
+
+void stat_miss(int level) {
+	if(timing_mute != 0) { return; }
+	mem_stat[level][access_kind].miss ++;
+
+	PC_stat *p = pc_find(cpu.eip);
+	if(!p->used) {
+		p->used = true;
+		p->eip = cpu.eip;
+		if(++ nr_pc * 2 > pc_table_size) {
+			pc_table_grow();
+			p = pc_find(cpu.eip);
+		}
+	}
+	p->miss[level] ++;
+}
+
+typedef struct {
+	int sym;
+	uint64_t miss[NR_S_LEVEL];
+} Func_stat;
+
+static uint64_t total_miss(const uint64_t *miss) {
+	return miss[S_L1] + miss[S_L2] + miss[S_TLB];
+}
+
+static int cmp_pc(const void *a, const void *b) {
+	uint64_t x = total_miss(((const PC_stat *)a)->miss), y = total_miss(((const PC_stat *)b)->miss);
+	return (x < y) - (x > y);
+}
+
+static int cmp_func(const void *a, const void *b) {
+	uint64_t x = total_miss(((const Func_stat *)a)->miss), y = total_miss(((const Func_stat *)b)->miss);
+	return (x < y) - (x > y);
+}
+
+/* the EIPs with misses, most misses first */
+static PC_stat* sorted_pc() {
+	PC_stat *pc = malloc(sizeof(PC_stat) * (nr_pc + 1));
+	assert(pc);
+	uint32_t i, n = 0;
+	for(i = 0; i < pc_table_size; i ++) {
+		if(pc_table[i].used) { pc[n ++] = pc_table[i]; }
+	}
+	qsort(pc, nr_pc, sizeof(PC_stat), cmp_pc);
+	return pc;
+}
+
+/* The misses summed up per function, most misses first. The slot with
+ * `sym' == nr_symbol() is for code outside any function.
+ */
+static Func_stat* sorted_func(PC_stat *pc) {
+	int nr_func = nr_symbol();
+	Func_stat *func = calloc(nr_func + 1, sizeof(Func_stat));
+	assert(func);
+	int f, l;
+	for(f = 0; f <= nr_func; f ++) { func[f].sym = f; }
+	uint32_t i;
+	for(i = 0; i < nr_pc; i ++) {
+		swaddr_t start, end;
+		f = find_function(pc[i].eip, &start, &end);
+		if(f == -1) { f = nr_func; }
+		for(l = 0; l < NR_S_LEVEL; l ++) { func[f].miss[l] += pc[i].miss[l]; }
+	}
+	qsort(func, nr_func + 1, sizeof(Func_stat), cmp_func);
+	return func;
+}
+
+static const char* func_name(int sym) {
+	return (sym == nr_symbol() ? "?" : symbol_name(sym));
+}
+
+static const char* pc_func_name(swaddr_t eip) {
+	swaddr_t start, end;
+	int f = find_function(eip, &start, &end);
+	return (f == -1 ? "?" : symbol_name(f));
+}
+
+#define llu(x) ((unsigned long long)(x))
+
+#define NR_TOP 10
+
+void info_cache() {
+	int l, k, i;
+	if(mem_model != MEM_CACHE) { printf("The caches are not simulated, run with --mem=cache\n"); }
+	else {
+		for(l = LEVEL_L1; l < NR_CACHE_LEVEL; l ++) {
+			Cache *c = &caches[l];
+			printf("%s: %u KiB, %u sets x %u ways x %u bytes, %s, %s", level_name[l],
+					c->nr_set * c->nr_way * c->line_size / 1024, c->nr_set, c->nr_way, c->line_size,
+					repl_name[c->repl.policy], (c->write == CACHE_WB ? "write-back" : "write-through"));
+			if(l == LEVEL_L2) { printf(", %s", (cache_L2_mode == CACHE_INCLUSIVE ? "inclusive" : "exclusive")); }
+			printf("\n");
+		}
+	}
+
+	printf("\n\t\thit\t\tmiss\t\tevict\t\twriteback\thit rate\n");
+	for(l = 0; l < NR_S_LEVEL; l ++) {
+		for(k = 0; k < NR_ACC; k ++) {
+			Mem_stat *s = &mem_stat[l][k];
+			printf("%-3s %-5s\t%-12llu\t%-12llu\t%-12llu\t%-12llu\t", level_name[l], kind_name[k],
+					llu(s->hit), llu(s->miss), llu(s->evict), llu(s->writeback));
+			if(s->hit + s->miss != 0) { printf("%.2f%%\n", 100.0 * s->hit / (s->hit + s->miss)); }
+			else { printf("-\n"); }
+		}
+	}
+	if(nr_pc == 0) { return; }
+
+	PC_stat *pc = sorted_pc();
+	Func_stat *func = sorted_func(pc);
+	printf("\nfunction\t\tL1 miss\t\tL2 miss\t\tTLB miss\n");
+	for(i = 0; i <= nr_symbol() && i < NR_TOP && total_miss(func[i].miss) != 0; i ++) {
+		printf("%-16s\t%-12llu\t%-12llu\t%-12llu\n", func_name(func[i].sym),
+				llu(func[i].miss[S_L1]), llu(func[i].miss[S_L2]), llu(func[i].miss[S_TLB]));
+	}
+	printf("\neip\t\tfunction\t\tL1 miss\t\tL2 miss\t\tTLB miss\n");
+	for(i = 0; i < nr_pc && i < NR_TOP; i ++) {
+		printf("0x%08x\t%-16s\t%-12llu\t%-12llu\t%-12llu\n", pc[i].eip, pc_func_name(pc[i].eip),
+				llu(pc[i].miss[S_L1]), llu(pc[i].miss[S_L2]), llu(pc[i].miss[S_TLB]));
+	}
+	free(func);
+	free(pc);
+}
+
+/* Write the statistics to `stats_file', one record per line:
+ *   LEVEL KIND hit miss evict writeback
+ *   pc EIP FUNCTION l1_miss l2_miss tlb_miss
+ *   func FUNCTION l1_miss l2_miss tlb_miss
+ */
+static void stats_dump() {
+	FILE *fp = fopen(stats_file, "w");
+	if(fp == NULL) {
+		fprintf(stderr, "Can not open '%s'\n", stats_file);
+		return;
+	}
+	int l, k;
+	uint32_t i;
+	for(l = 0; l < NR_S_LEVEL; l ++) {
+		for(k = 0; k < NR_ACC; k ++) {
+			Mem_stat *s = &mem_stat[l][k];
+			fprintf(fp, "%s %s %llu %llu %llu %llu\n", level_name[l], kind_name[k],
+					llu(s->hit), llu(s->miss), llu(s->evict), llu(s->writeback));
+		}
+	}
+	PC_stat *pc = sorted_pc();
+	Func_stat *func = sorted_func(pc);
+	for(i = 0; i < nr_pc; i ++) {
+		fprintf(fp, "pc 0x%08x %s %llu %llu %llu\n", pc[i].eip, pc_func_name(pc[i].eip),
+				llu(pc[i].miss[S_L1]), llu(pc[i].miss[S_L2]), llu(pc[i].miss[S_TLB]));
+	}
+	for(i = 0; i <= nr_symbol() && total_miss(func[i].miss) != 0; i ++) {
+		fprintf(fp, "func %s %llu %llu %llu\n", func_name(func[i].sym),
+				llu(func[i].miss[S_L1]), llu(func[i].miss[S_L2]), llu(func[i].miss[S_TLB]));
+	}
+	free(func);
+	free(pc);
+	fclose(fp);
+}
+
+void init_stats() {
+	memset(mem_stat, 0, sizeof(mem_stat));
+	access_kind = ACC_DATA;
+	free(pc_table);
+	pc_table_init(1 << PC_TABLE_INIT_BIT);
+	nr_pc = 0;
+
+	static bool dump_at_exit = false;
+	if(stats_file != NULL && !dump_at_exit) {
+		atexit(stats_dump);
+		dump_at_exit = true;
+	}
+}
@@ -1,44 +1,174 @@
 #include "common.h"
 #include "memory/tlb.h"
-#include <time.h>
 #include <stdio.h>
-#include <stdlib.h>
 #include "burst.h"
+#include "memory/memory.h"
+#include "nemu.h"
+#include "memory/replace.h"
+#include "memory/stats.h"
+
+static Repl repl, large_repl;
+
+typedef struct {
+  bool valid;
+  uint32_t dir, pde;
+} PWC;
+
+static PWC pwc[PWC_NUM];
+static uint64_t pwc_hit, pwc_miss;
+
+static void pwc_flush() {
+  int i;
+  for (i = 0; i < PWC_NUM; i++) {
+    pwc[i].valid = false;
+  }
+}
 
 void init_tlb() {
   int i;
-  for (i = 0; i < TLB_SIZE; i++) {
+  for (i = 0; i < TLB_SIZE + TLB_LARGE_NUM; i++) {
     tlb[i].valid_value = false;
   }
+  repl_init(&repl, repl_policy[REPL_TLB], TLB_SET_NUM, TLB_WAY_NUM);
+  repl_init(&large_repl, repl_policy[REPL_TLB], 1, TLB_LARGE_NUM);
+  pwc_flush();
+  pwc_hit = pwc_miss = 0;
+  soft_tlb_flush();
   return ;
 }
 
+/* Drop all entries, which is what a CR0 or CR4 write does. */
+void tlb_flush() {
+  int i;
+  for (i = 0; i < TLB_SIZE + TLB_LARGE_NUM; i++) {
+    tlb[i].valid_value = false;
+  }
+  pwc_flush();
+  soft_tlb_flush();
+}
+
+/* Drop all entries except global pages, which are only kept while
+ * CR4.PGE is set. */
+void tlb_flush_nonglobal() {
+  bool pge = cpu.cr4.page_global_enable;
+  int i;
+  for (i = 0; i < TLB_SIZE + TLB_LARGE_NUM; i++) {
+    if (!(pge && tlb[i].global)) tlb[i].valid_value = false;
+  }
+  pwc_flush();
+  soft_tlb_flush();
+}
+
+void tlb_ckpt(Ckpt *c) {
+  ckpt_data(c, tlb, sizeof(tlb));
+  repl_ckpt(c, &repl);
+  repl_ckpt(c, &large_repl);
+  ckpt_data(c, pwc, sizeof(pwc));
+}
+
 int read_tlb(uint32_t addr) {
-  int dir = addr >> 12;
+  uint32_t vpn = addr >> 12;
+  int set = vpn & (TLB_SET_NUM - 1);
   int i;
-  for (i = 0; i < TLB_SIZE; i++) {
-    if (tlb[i].tag == dir && tlb[i].valid_value) {
+  for (i = set * TLB_WAY_NUM; i < (set + 1) * TLB_WAY_NUM; i++) {
+    if (tlb[i].tag == vpn && tlb[i].valid_value) {
+      stat_hit(S_TLB);
+      repl_touch(&repl, set, i - set * TLB_WAY_NUM);
+      return i;
+    }
+  }
+  for (i = TLB_SIZE; i < TLB_SIZE + TLB_LARGE_NUM; i++) {
+    if (tlb[i].tag == (addr >> 22) && tlb[i].valid_value) {
+      stat_hit(S_TLB);
+      repl_touch(&large_repl, 0, i - TLB_SIZE);
       return i;
     }
   }
+  stat_miss(S_TLB);
   return -1;
 }
 
-void write_tlb(uint32_t lnaddr, uint32_t hwaddr_t) {
-  int dir = lnaddr >> 12, page_num = hwaddr_t >> 12;
+/* A hit found by the soft-TLB on behalf of the TLB. */
+void touch_tlb(int index) {
+  stat_hit(S_TLB);
+  if (tlb_is_large(index)) repl_touch(&large_repl, 0, index - TLB_SIZE);
+  else repl_touch(&repl, index / TLB_WAY_NUM, index % TLB_WAY_NUM);
+}
+
+static int write_large_tlb(uint32_t lnaddr) {
+  int i;
+  for (i = TLB_SIZE; i < TLB_SIZE + TLB_LARGE_NUM; i++) {
+    if (!tlb[i].valid_value) break;
+  }
+  if (i == TLB_SIZE + TLB_LARGE_NUM) {
+    i = TLB_SIZE + repl_victim(&large_repl, 0);
+    stat_evict(S_TLB, false);
+    /* the soft-TLB may hold any 4KB page of it */
+    soft_tlb_flush();
+  }
+  tlb[i].tag = lnaddr >> 22;
+  repl_fill(&large_repl, 0, i - TLB_SIZE);
+  return i;
+}
+
+int write_tlb(uint32_t lnaddr, uint32_t hwaddr_t, bool global, bool large, bool dirty) {
   int i;
-  for (i = 0; i < TLB_SIZE; i++) {
-    if (!tlb[i].valid_value) {
-      tlb[i].valid_value = true;
-      tlb[i].tag = dir;
-      tlb[i].page_num = page_num;
-      return ;
+  if (large) {
+    i = write_large_tlb(lnaddr);
+    hwaddr_t &= ~0x3fffff;
+  }
+  else {
+    uint32_t vpn = lnaddr >> 12;
+    int set = vpn & (TLB_SET_NUM - 1);
+    for (i = set * TLB_WAY_NUM; i < (set + 1) * TLB_WAY_NUM; i++) {
+      if (!tlb[i].valid_value) break;
+    }
+    if (i == (set + 1) * TLB_WAY_NUM) {
+      i = set * TLB_WAY_NUM + repl_victim(&repl, set);
+      stat_evict(S_TLB, false);
+      /* the soft-TLB only holds pages which are in the TLB */
+      soft_tlb_invalidate(tlb[i].tag << 12);
     }
+    tlb[i].tag = vpn;
+    repl_fill(&repl, set, i - set * TLB_WAY_NUM);
   }
-  srand(time(0));
-  i = rand() % TLB_SIZE;
   tlb[i].valid_value = true;
-  tlb[i].tag = dir;
-  tlb[i].page_num = page_num;
-  return ;
-}
\ No newline at end of file
+  tlb[i].global = global;
+  tlb[i].dirty = dirty;
+  tlb[i].page_num = hwaddr_t >> 12;
+  return i;
+}
+
+bool read_pwc(uint32_t dir, uint32_t *pde) {
+  PWC *e = &pwc[dir & (PWC_NUM - 1)];
+  if (e->valid && e->dir == dir) {
+    pwc_hit++;
+    *pde = e->pde;
+    return true;
+  }
+  pwc_miss++;
+  return false;
+}
+
+void write_pwc(uint32_t dir, uint32_t pde) {
+  PWC *e = &pwc[dir & (PWC_NUM - 1)];
+  e->valid = true;
+  e->dir = dir;
+  e->pde = pde;
+}
+
+void info_tlb() {
+  uint64_t hit = 0, miss = 0, evict = 0;
+  int k;
+  for (k = 0; k < NR_ACC; k++) {
+    hit += mem_stat[S_TLB][k].hit;
+    miss += mem_stat[S_TLB][k].miss;
+    evict += mem_stat[S_TLB][k].evict;
+  }
+  printf("TLB: %d sets x %d ways + %d 4MB entries, %s\n", TLB_SET_NUM, TLB_WAY_NUM, TLB_LARGE_NUM, repl_name[repl.policy]);
+  printf("hit\t%llu\nmiss\t%llu\nevict\t%llu\n",
+      (unsigned long long)hit, (unsigned long long)miss, (unsigned long long)evict);
+  if (hit + miss != 0) printf("hit rate\t%.2f%%\n", 100.0 * hit / (hit + miss));
+  printf("page-walk cache: %d entries\nhit\t%llu\nmiss\t%llu\n", PWC_NUM,
+      (unsigned long long)pwc_hit, (unsigned long long)pwc_miss);
+}
@@ -0,0 +1,392 @@
+#include "nemu.h"
+#include "monitor/checkpoint.h"
+#include "memory/memory.h"
+#include "memory/dirty.h"
+#include "memory/cache.h"
+#include "cpu/decode/decode-cache.h"
+#include "cpu/block.h"
+#include "cpu/jit.h"
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* The file starts with a header, the paths of the parent and of the
+ * memory image, and the numbers of the saved pages in increasing order.
+ * The sections follow, each a name and a length. The pages start at the
+ * next 4KB boundary of the file, so they can be mapped from it.
+ */
+
+#define CKPT_MAGIC "NEMUCKPT"
+#define CKPT_VERSION 4
+#define CKPT_PAGE 4096
+#define CKPT_NAME_LEN 16
+#define CKPT_MAX_DEPTH 256
+/* more runs of pages are copied instead of mapped, to spare VMAs */
+#define CKPT_MAX_MAP 16384
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t mem_size;
+	uint32_t nr_page;
+	uint32_t pad;
+	uint64_t page_offset;
+} Header;
+
+char *load_file = NULL;
+char *entry_file = NULL;
+
+/* the checkpoints which the memory is based on, the last one saved or
+ * loaded at the end, which is the parent of the next one saved */
+static char *chain[CKPT_MAX_DEPTH];
+static int nr_chain = 0;
+
+void init_ddr3();
+void init_cache();
+void init_tlb();
+void tlb_ckpt(Ckpt *);
+void cache_ckpt(Ckpt *);
+void ddr3_ckpt(Ckpt *);
+#ifdef HAS_DEVICE
+void device_ckpt(Ckpt *);
+#endif
+
+static void cpu_ckpt(Ckpt *c) {
+	ckpt_data(c, &cpu, sizeof(cpu));
+}
+
+static void mem_cache_ckpt(Ckpt *c) {
+	cache_ckpt(c);
+	ddr3_ckpt(c);
+}
+
+static bool always() { return true; }
+static bool with_cache() { return mem_model == MEM_CACHE; }
+
+static struct {
+	const char *name;
+	void (*ckpt) (Ckpt *);
+	/* whether this NEMU keeps the state of the section */
+	bool (*used) ();
+} section_table [] = {
+	{ "cpu", cpu_ckpt, always },
+	{ "tlb", tlb_ckpt, always },
+	{ "cache", mem_cache_ckpt, with_cache },
+#ifdef HAS_DEVICE
+	{ "device", device_ckpt, always },
+#endif
+};
+
+#define NR_SECTION (sizeof(section_table) / sizeof(section_table[0]))
+
+void ckpt_data(Ckpt *c, void *data, size_t len) {
+	uint32_t size = len;
+	if(c->load) {
+		Assert(fread(&size, sizeof(size), 1, c->fp) == 1 && size == len,
+				"checkpoint: %u bytes where %zu are expected", size, len);
+		Assert(fread(data, len, 1, c->fp) == 1 || len == 0, "checkpoint: file is truncated");
+	}
+	else {
+		fwrite(&size, sizeof(size), 1, c->fp);
+		fwrite(data, len, 1, c->fp);
+	}
+}
+
+void ckpt_check(Ckpt *c, uint32_t val, const char *what) {
+	uint32_t saved = val;
+	ckpt_data(c, &saved, sizeof(saved));
+	if(saved != val) {
+		panic("checkpoint: saved with %s %u, but this NEMU uses %u", what, saved, val);
+	}
+}
+
+static void write_str(FILE *fp, const char *str) {
+	uint32_t len = (str == NULL ? 0 : strlen(str));
+	fwrite(&len, sizeof(len), 1, fp);
+	fwrite(str, len, 1, fp);
+}
+
+/* Return a string allocated with malloc(), or NULL for the empty one. */
+static bool read_str(FILE *fp, char **str) {
+	uint32_t len;
+	*str = NULL;
+	if(fread(&len, sizeof(len), 1, fp) != 1 || len > PATH_MAX) { return false; }
+	if(len == 0) { return true; }
+	*str = malloc(len + 1);
+	assert(*str);
+	if(fread(*str, len, 1, fp) != 1) { return false; }
+	(*str)[len] = '\0';
+	return true;
+}
+
+static void write_section(Ckpt *c, int i) {
+	char name[CKPT_NAME_LEN] = {};
+	strncpy(name, section_table[i].name, CKPT_NAME_LEN - 1);
+	uint32_t len = 0;
+	fwrite(name, sizeof(name), 1, c->fp);
+	c->section = ftell(c->fp);
+	fwrite(&len, sizeof(len), 1, c->fp);
+
+	section_table[i].ckpt(c);
+
+	long end = ftell(c->fp);
+	len = end - c->section - sizeof(len);
+	fseek(c->fp, c->section, SEEK_SET);
+	fwrite(&len, sizeof(len), 1, c->fp);
+	fseek(c->fp, end, SEEK_SET);
+}
+
+/* Load the sections used here and skip the others. */
+static void read_sections(Ckpt *c) {
+	char name[CKPT_NAME_LEN];
+	uint32_t len;
+	while(fread(name, sizeof(name), 1, c->fp) == 1) {
+		name[CKPT_NAME_LEN - 1] = '\0';
+		if(strcmp(name, "end") == 0) { return; }
+		c->section = ftell(c->fp);
+		Assert(fread(&len, sizeof(len), 1, c->fp) == 1, "checkpoint: file is truncated");
+
+		int i;
+		for(i = 0; i < NR_SECTION; i ++) {
+			if(strcmp(name, section_table[i].name) == 0) { break; }
+		}
+		if(i < NR_SECTION && section_table[i].used()) {
+			section_table[i].ckpt(c);
+			Assert(ftell(c->fp) == c->section + sizeof(len) + len, "checkpoint: section '%s' is malformed", name);
+		}
+		else {
+			fseek(c->fp, c->section + sizeof(len) + len, SEEK_SET);
+		}
+	}
+	panic("checkpoint: file is truncated");
+}
+
+static bool in_chain(const char *path) {
+	int i;
+	for(i = 0; i < nr_chain; i ++) {
+		if(strcmp(chain[i], path) == 0) { return true; }
+	}
+	return false;
+}
+
+static void clear_chain() {
+	for(; nr_chain > 0; nr_chain --) {
+		free(chain[nr_chain - 1]);
+	}
+}
+
+/* Save the state and the pages written since the last checkpoint. */
+bool checkpoint_save(const char *file) {
+	char path[PATH_MAX];
+	if(realpath(file, path) != NULL && in_chain(path)) {
+		printf("'%s' is a parent of the current state and can not be overwritten\n", file);
+		return false;
+	}
+	if(nr_chain == CKPT_MAX_DEPTH) {
+		printf("Too many incremental checkpoints, load one to start over\n");
+		return false;
+	}
+
+	char tmp[PATH_MAX + 8];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+	FILE *fp = fopen(tmp, "wb");
+	if(fp == NULL) {
+		printf("Can not open '%s'\n", tmp);
+		return false;
+	}
+
+	/* DRAM must hold the current contents of memory */
+	if(mem_model == MEM_CACHE) { flush_cache(); }
+
+	const uint32_t *pages;
+	uint32_t nr_page = dirty_collect(&pages);
+
+	Header h = { .version = CKPT_VERSION, .mem_size = hw_mem_size, .nr_page = nr_page };
+	memcpy(h.magic, CKPT_MAGIC, sizeof(h.magic));
+	fwrite(&h, sizeof(h), 1, fp);
+
+	char image[PATH_MAX];
+	write_str(fp, nr_chain > 0 ? chain[nr_chain - 1] : NULL);
+	write_str(fp, hw_mem_file != NULL && realpath(hw_mem_file, image) != NULL ? image : hw_mem_file);
+	fwrite(pages, sizeof(uint32_t), nr_page, fp);
+
+	Ckpt c = { .fp = fp, .load = false };
+	int i;
+	for(i = 0; i < NR_SECTION; i ++) {
+		if(section_table[i].used()) { write_section(&c, i); }
+	}
+	char end[CKPT_NAME_LEN] = "end";
+	fwrite(end, sizeof(end), 1, fp);
+
+	h.page_offset = (ftell(fp) + CKPT_PAGE - 1) & ~(uint64_t)(CKPT_PAGE - 1);
+	fseek(fp, h.page_offset, SEEK_SET);
+	uint32_t k;
+	for(k = 0; k < nr_page; k ++) {
+		fwrite(hw_mem + ((size_t)pages[k] << 12), CKPT_PAGE, 1, fp);
+	}
+	fseek(fp, 0, SEEK_SET);
+	fwrite(&h, sizeof(h), 1, fp);
+
+	bool ok = !ferror(fp);
+	ok = (fclose(fp) == 0) && ok;
+	ok = ok && rename(tmp, file) == 0 && realpath(file, path) != NULL;
+	if(!ok) {
+		remove(tmp);
+		/* the pages are still to be saved by the next checkpoint */
+		for(k = 0; k < nr_page; k ++) { dirty_mark_page(pages[k]); }
+		printf("Can not write '%s'\n", file);
+		return false;
+	}
+
+	chain[nr_chain ++] = strdup(path);
+	printf("Saved %u pages to '%s'\n", nr_page, file);
+	return true;
+}
+
+void checkpoint_entry() {
+	Assert(checkpoint_save(entry_file), "Can not save '%s'", entry_file);
+	entry_file = NULL;
+}
+
+typedef struct {
+	FILE *fp;
+	Header h;
+	char *parent, *image;
+	uint32_t *pages;
+} Link;
+
+static void close_link(Link *l) {
+	if(l->fp != NULL) { fclose(l->fp); }
+	free(l->parent);
+	free(l->image);
+	free(l->pages);
+}
+
+/* Open a checkpoint and read everything before its sections. */
+static bool open_link(Link *l, const char *file) {
+	memset(l, 0, sizeof(*l));
+	l->fp = fopen(file, "rb");
+	if(l->fp == NULL) {
+		printf("Can not open '%s'\n", file);
+		return false;
+	}
+	if(fread(&l->h, sizeof(l->h), 1, l->fp) != 1 || memcmp(l->h.magic, CKPT_MAGIC, sizeof(l->h.magic)) != 0) {
+		printf("'%s' is not a checkpoint\n", file);
+		return false;
+	}
+	if(l->h.version != CKPT_VERSION) {
+		printf("'%s' has version %u, but this NEMU reads version %d\n", file, l->h.version, CKPT_VERSION);
+		return false;
+	}
+	if(l->h.mem_size != hw_mem_size) {
+		printf("'%s' was saved with %u bytes of memory, use --mem-size=%u\n", file, l->h.mem_size, l->h.mem_size);
+		return false;
+	}
+	if(!read_str(l->fp, &l->parent) || !read_str(l->fp, &l->image)) {
+		printf("'%s' is truncated\n", file);
+		return false;
+	}
+
+	uint32_t nr_page = l->h.nr_page, k;
+	bool ok = (nr_page <= hw_mem_size / CKPT_PAGE) && (l->h.page_offset & (CKPT_PAGE - 1)) == 0;
+	if(ok) {
+		l->pages = malloc(nr_page * sizeof(uint32_t) + 1);
+		assert(l->pages);
+		ok = fread(l->pages, sizeof(uint32_t), nr_page, l->fp) == nr_page;
+	}
+	for(k = 0; ok && k < nr_page; k ++) {
+		ok = l->pages[k] < hw_mem_size / CKPT_PAGE && (k == 0 || l->pages[k] > l->pages[k - 1]);
+	}
+	if(!ok) {
+		printf("'%s' is corrupted\n", file);
+		return false;
+	}
+	return true;
+}
+
+/* Map the pages of a checkpoint over the guest memory, copy-on-write. */
+static void map_link(Link *l, int *nr_map) {
+	int fd = fileno(l->fp);
+	uint32_t i, j;
+	for(i = 0; i < l->h.nr_page; i = j) {
+		for(j = i + 1; j < l->h.nr_page && l->pages[j] == l->pages[j - 1] + 1; j ++);
+		uint8_t *dst = hw_mem + ((size_t)l->pages[i] << 12);
+		size_t len = (size_t)(j - i) << 12;
+		off_t off = l->h.page_offset + ((off_t)i << 12);
+		if(*nr_map < CKPT_MAX_MAP) {
+			void *p = mmap(dst, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, off);
+			Assert(p == dst, "checkpoint: can not map the pages");
+			(*nr_map) ++;
+		}
+		else {
+			Assert(pread(fd, dst, len, off) == len, "checkpoint: can not read the pages");
+		}
+	}
+}
+
+/* Restore the state saved in `file'. Nothing is changed if the file or
+ * one of its parents can not be used.
+ */
+bool checkpoint_load(const char *file) {
+	static Link links[CKPT_MAX_DEPTH];
+	static char path[CKPT_MAX_DEPTH][PATH_MAX];
+	int nr_link = 0, i;
+	const char *next = file;
+	bool ok = true;
+
+	/* the checkpoint itself comes first, then its parents */
+	while(next != NULL) {
+		if(nr_link == CKPT_MAX_DEPTH) {
+			printf("'%s' has too many parents\n", file);
+			ok = false;
+			break;
+		}
+		Link *l = &links[nr_link];
+		ok = open_link(l, next) && realpath(next, path[nr_link]) != NULL;
+		nr_link ++;
+		if(!ok) { break; }
+		next = l->parent;
+	}
+
+	if(ok) {
+		/* the image path of the command line is not ours to free */
+		static char *image = NULL;
+		free(image);
+		image = (links[0].image != NULL ? strdup(links[0].image) : NULL);
+		hw_mem_file = image;
+		init_hw_mem();
+		int nr_map = 0;
+		for(i = nr_link - 1; i >= 0; i --) {
+			map_link(&links[i], &nr_map);
+		}
+
+		/* without the cache section, the caches start cold */
+		if(mem_model == MEM_CACHE) {
+			init_cache();
+			init_ddr3();
+		}
+		init_tlb();
+
+		Ckpt c = { .fp = links[0].fp, .load = true };
+		read_sections(&c);
+
+		/* the memory now holds what the chain holds */
+		const uint32_t *pages;
+		dirty_collect(&pages);
+		flush_decode_cache();
+		init_block();
+		init_jit();
+
+		clear_chain();
+		for(i = nr_link - 1; i >= 0; i --) {
+			chain[nr_chain ++] = strdup(path[i]);
+		}
+		printf("Loaded '%s' at eip = 0x%08x\n", file, cpu.eip);
+	}
+
+	for(i = 0; i < nr_link; i ++) {
+		close_link(&links[i]);
+	}
+	return ok;
+}
@@ -2,6 +2,13 @@
 #include "cpu/helper.h"
 #include <setjmp.h>
 #include "monitor/watchpoint.h"
+#include "cpu/block.h"
+#include "monitor/trace.h"
+#include "monitor/timing.h"
+#include "cpu/intr.h"
+#include "device/i8259.h"
+#include "monitor/elf.h"
+#include "monitor/checkpoint.h"
 
 /* The assembly code of instructions executed is only output to the screen
  * when the number of instructions executed is less than this value.
@@ -11,8 +18,7 @@
 #define MAX_INSTR_TO_PRINT 10
 
 int nemu_state = STOP;
-
-int exec(swaddr_t);
+int exec_engine = ENGINE_INTERP;
 
 char assembly[80];
 char asm_buf[128];
@@ -22,11 +28,13 @@ jmp_buf jbuf;
 
 void print_bin_instr(swaddr_t eip, int len) {
 	int i;
+	timing_mute ++;
 	int l = sprintf(asm_buf, "%8x:   ", eip);
 	for(i = 0; i < len; i ++) {
 		l += sprintf(asm_buf + l, "%02x ", instr_fetch(eip + i, 1));
 	}
 	sprintf(asm_buf + l, "%*.s", 50 - (12 + 3 * len), "");
+	timing_mute --;
 }
 
 /* This function will be called when an `int3' instruction is being executed. */
@@ -35,6 +43,33 @@ void do_int3() {
 	nemu_state = STOP;
 }
 
+/* Called after each instruction when tracing or timing. */
+static void hook_instr(swaddr_t eip, int len) {
+	if(trace_on) { trace_record(eip, len); }
+	if(timing_on) { timing_instr(eip, len); }
+}
+
+#ifdef DEBUG
+/* Log the instruction just executed. */
+static void trace_instr(swaddr_t eip, int len) {
+	print_bin_instr(eip, len);
+	strcat(asm_buf, assembly);
+	Log_write("%s\n", asm_buf);
+	hook_instr(eip, len);
+}
+#endif
+
+#ifdef HAS_DEVICE
+/* Take the interrupt raised by the i8259 if the guest accepts it. */
+static void check_intr() {
+	if(cpu.INTR && cpu.eflags.IF) {
+		uint8_t intr_no = i8259_query_intr();
+		i8259_ack_intr();
+		raise_intr(intr_no);
+	}
+}
+#endif
+
 /* Simulate how the CPU works. */
 void cpu_exec(volatile uint32_t n) {
 	if(nemu_state == END) {
@@ -45,13 +80,55 @@ void cpu_exec(volatile uint32_t n) {
 
 #ifdef DEBUG
 	volatile uint32_t n_temp = n;
+	void (*trace)(swaddr_t, int) = trace_instr;
+#else
+	void (*trace)(swaddr_t, int) = (trace_on || timing_on ? hook_instr : NULL);
 #endif
 
-	setjmp(jbuf);
+	/* Single-stepping and watchpoints need the interpreter to stop
+	 * after every instruction, so translated blocks are only used
+	 * for long runs.
+	 */
+	volatile bool use_block = (exec_engine != ENGINE_INTERP && n >= MAX_INSTR_TO_PRINT && !has_wp());
+
+	/* an exception comes back here */
+	if(setjmp(jbuf) != 0) {
+		uint32_t nr_done = block_abort();
+		if(nemu_state != RUNNING) { return; }
+		/* a block may have finished some instructions before it */
+		n -= nr_done;
+	}
 
 	for(; n > 0; n --) {
+		/* The entry is first reached from code which can not be
+		 * chained to it yet, so it is seen here with any engine.
+		 */
+		if(entry_file != NULL && cpu.eip == elf_entry) { checkpoint_entry(); }
+
+		if(use_block) {
+			uint32_t nr_instr = block_exec(n, trace);
+			if(nr_instr > 0) {
 #ifdef DEBUG
+				if((n >> 16) != ((n - nr_instr) >> 16)) { fputc('.', stderr); }
+#endif
+				/* the last one is counted by the loop */
+				n -= nr_instr - 1;
+
+#ifdef HAS_DEVICE
+				extern void device_update();
+				device_update();
+#endif
+
+				if(nemu_state != RUNNING) { return; }
+#ifdef HAS_DEVICE
+				check_intr();
+#endif
+				continue;
+			}
+		}
+
 		swaddr_t eip_temp = cpu.eip;
+#ifdef DEBUG
 		if((n & 0xffff) == 0) {
 			/* Output some dots while executing the program. */
 			fputc('.', stderr);
@@ -60,21 +137,24 @@ void cpu_exec(volatile uint32_t n) {
 
 		/* Execute one instruction, including instruction fetch,
 		 * instruction decode, and the actual execution. */
-		int instr_len = exec(cpu.eip);
+		int instr_len = decode_cache_exec(cpu.eip);
 
 		cpu.eip += instr_len;
 
+		if(use_block) { block_record(eip_temp, instr_len); }
+
+		if(trace != NULL) { trace(eip_temp, instr_len); }
 #ifdef DEBUG
-		print_bin_instr(eip_temp, instr_len);
-		strcat(asm_buf, assembly);
-		Log_write("%s\n", asm_buf);
 		if(n_temp < MAX_INSTR_TO_PRINT) {
 			printf("%s\n", asm_buf);
 		}
 #endif
 
 		/* TODO: check watchpoints here. */
+		/* watchpoint reads are not part of the program's time */
+		timing_mute ++;
 		bool jug = check_wp();
+		timing_mute --;
 		if ( !jug ) nemu_state = STOP;
 
 #ifdef HAS_DEVICE
@@ -83,6 +163,9 @@ void cpu_exec(volatile uint32_t n) {
 #endif
 
 		if(nemu_state != RUNNING) { return; }
+#ifdef HAS_DEVICE
+		check_intr();
+#endif
 	}
 
 	if(nemu_state == RUNNING) { nemu_state = STOP; }
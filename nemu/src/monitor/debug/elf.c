@@ -5,6 +5,7 @@
 #include <elf.h>
 
 char *exec_file = NULL;
+swaddr_t elf_entry;
 
 static char *strtab = NULL;
 static Elf32_Sym *symtab = NULL;
@@ -58,9 +59,33 @@ int getVariable(char* name, bool* success){
   return 0;
 }
 
+int nr_symbol() {
+	return nr_symtab_entry;
+}
+
+const char *symbol_name(int i) {
+	return strtab + symtab[i].st_name;
+}
+
+/* Return the index of the function symbol containing `addr' and set
+ * [start, end) to its range, or return -1.
+ */
+int find_function(swaddr_t addr, swaddr_t *start, swaddr_t *end) {
+	int i;
+	for(i = 0; i < nr_symtab_entry; i ++) {
+		if((symtab[i].st_info & 0xf) == STT_FUNC &&
+				symtab[i].st_value <= addr && addr < symtab[i].st_value + symtab[i].st_size) {
+			*start = symtab[i].st_value;
+			*end = symtab[i].st_value + symtab[i].st_size;
+			return i;
+		}
+	}
+	return -1;
+}
+
 void load_elf_tables(int argc, char *argv[]) {
 	int ret;
-	Assert(argc == 2, "run NEMU with format 'nemu [program]'");
+	Assert(argc == 2, "run NEMU with format 'nemu [options] [program]'");
 	exec_file = argv[1];
 
 	FILE *fp = fopen(exec_file, "rb");
@@ -79,6 +104,7 @@ void load_elf_tables(int argc, char *argv[]) {
 	assert(elf->e_ident[EI_CLASS] == ELFCLASS32);		// 32-bit architecture
 	assert(elf->e_ident[EI_DATA] == ELFDATA2LSB);		// littel-endian
 	assert(elf->e_ident[EI_VERSION] == EV_CURRENT);		// current version
+	elf_entry = elf->e_entry;
 	assert(elf->e_ident[EI_OSABI] == ELFOSABI_SYSV || 	// UNIX System V ABI
 			elf->e_ident[EI_OSABI] == ELFOSABI_LINUX); 	// UNIX - GNU
 	assert(elf->e_ident[EI_ABIVERSION] == 0);			// should be 0
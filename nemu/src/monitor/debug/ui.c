@@ -3,6 +3,12 @@
 #include "monitor/watchpoint.h"
 #include "monitor/elf.h"
 #include "nemu.h"
+#include "cpu/eflags.h"
+#include "memory/tlb.h"
+#include "monitor/timing.h"
+#include "memory/stats.h"
+#include "monitor/checkpoint.h"
+#include "cpu/fpu.h"
 
 #include <stdlib.h>
 #include <readline/readline.h>
@@ -66,8 +72,16 @@ static int cmd_info(char *args) {
                 printf( "$%s\t0x%08x\t%d\n", regsl[i], reg_l(i), reg_l(i));
             }
             printf( "$eip\t0x%08x\t%d\n", cpu.eip, cpu.eip );
+            eflags_sync();
+            printf( "$eflags\t0x%08x\t[%s%s%s%s%s ]\n", cpu.eflags.val,
+                    cpu.eflags.CF ? " CF" : "", cpu.eflags.PF ? " PF" : "", cpu.eflags.ZF ? " ZF" : "",
+                    cpu.eflags.SF ? " SF" : "", cpu.eflags.OF ? " OF" : "");
         }
             //或者一个一个打出来也可以
+        else if( strcmp(args, "tlb") == 0 ) info_tlb();
+        else if( strcmp(args, "timing") == 0 ) info_timing();
+        else if( strcmp(args, "cache") == 0 ) info_cache();
+        else if( strcmp(args, "fpu") == 0 ) info_fpu();
         else if( args[0] == 'w' ) info_wp();
     }
     else printf("Invalid Command\n");
@@ -142,6 +156,24 @@ static int cmd_bt(char *args) {
     return 0;
 }
 
+static int cmd_save(char *args) {
+	if(args == NULL) {
+		printf("Argument lost, you may mean\n\tsave [file]\n");
+		return 0;
+	}
+	checkpoint_save(args);
+	return 0;
+}
+
+static int cmd_load(char *args) {
+	if(args == NULL) {
+		printf("Argument lost, you may mean\n\tload [file]\n");
+		return 0;
+	}
+	if(checkpoint_load(args) && nemu_state == END) { nemu_state = STOP; }
+	return 0;
+}
+
 static int cmd_help(char *args);
 
 static struct {
@@ -153,12 +185,14 @@ static struct {
 	{ "c", "Continue the execution of the program", cmd_c },
 	{ "q", "Exit NEMU", cmd_q },
     { "si", "Continue the excution for peticular steps(-num), default as 1", cmd_si },
-    { "info", "Print the value of registers, watchpoints", cmd_info },
+    { "info", "Print the value of registers, watchpoints, TLB statistics(info tlb), cache statistics(info cache), timing model(info timing), x87 registers(info fpu)", cmd_info },
     { "x", "Print the address of memory", cmd_x},
     { "p", "Calculate given expression", cmd_p},
     { "w", "Set watch point", cmd_w},
     { "d", "Delete watchpoints", cmd_d},
     { "bt", "Print the stack information", cmd_bt},
+	{ "save", "Save a checkpoint of the machine, incremental to the last one saved or loaded", cmd_save },
+	{ "load", "Restore the machine from a checkpoint", cmd_load },
 
 	/* TODO: Add more commands */
 
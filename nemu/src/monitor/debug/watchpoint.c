@@ -74,6 +74,10 @@ bool check_wp(){
     return key;
 }
 
+bool has_wp(){
+    return head != NULL;
+}
+
 void delete_wp(int num){
     WP *p = head;
 	while(p -> next && p -> NO != num){
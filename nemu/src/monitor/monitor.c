@@ -1,5 +1,18 @@
 #include "nemu.h"
 #include "memory/tlb.h"
+#include "monitor/monitor.h"
+#include "cpu/jit.h"
+#include "cpu/eflags.h"
+#include "monitor/trace.h"
+#include "memory/replace.h"
+#include "memory/cache.h"
+#include "monitor/timing.h"
+#include "memory/stats.h"
+#include "memory/dirty.h"
+#include "monitor/checkpoint.h"
+#include "cpu/fpu.h"
+#include <stdlib.h>
+#include <getopt.h>
 
 #define ENTRY_START 0x100000
 
@@ -13,6 +26,8 @@ void init_wp_pool();
 void init_ddr3();
 void init_cache();
 void init_tlb();
+void init_decode_cache();
+void init_block();
 FILE *log_fp = NULL;
 
 static void init_log() {
@@ -26,14 +41,111 @@ printf("-----------------------------------------------------------------------\
 			exec_file);
 }
 
+/* SIZE is a number of bytes with an optional K, M or G suffix. */
+static bool parse_mem_size(const char *str) {
+	char *end;
+	unsigned long long size = strtoull(str, &end, 0);
+	switch(*end) {
+		case 'K': case 'k': size <<= 10; end ++; break;
+		case 'M': case 'm': size <<= 20; end ++; break;
+		case 'G': case 'g': size <<= 30; end ++; break;
+	}
+	if(*end != '\0' || size == 0 || size > HW_MEM_SIZE_MAX || (size & 0xfff) != 0) { return false; }
+	hw_mem_size = size;
+	return true;
+}
+
+/* Parse the options before the program name and return the index of it. */
+static int parse_args(int argc, char *argv[]) {
+	const struct option table[] = {
+		{"engine", required_argument, NULL, 'e'},
+		{"jit-check", no_argument, NULL, 'c'},
+		{"trace", no_argument, NULL, 't'},
+		{"trace-file", required_argument, NULL, 'f'},
+		{"trace-regs", no_argument, NULL, 'r'},
+		{"repl", required_argument, NULL, 'p'},
+		{"seed", required_argument, NULL, 's'},
+		{"mem", required_argument, NULL, 'm'},
+		{"l2", required_argument, NULL, 'l'},
+		{"cache", required_argument, NULL, 'C'},
+		{"timing", no_argument, NULL, 'T'},
+		{"lat", required_argument, NULL, 'L'},
+		{"stats", required_argument, NULL, 'S'},
+		{"mem-size", required_argument, NULL, 'z'},
+		{"mem-file", required_argument, NULL, 'i'},
+		{"load", required_argument, NULL, 'k'},
+		{"save-at-entry", required_argument, NULL, 'a'},
+		{0, 0, NULL, 0}
+	};
+	int o;
+	while((o = getopt_long(argc, argv, "+e:", table, NULL)) != -1) {
+		switch(o) {
+			case 'e':
+				if(strcmp(optarg, "interp") == 0) { exec_engine = ENGINE_INTERP; }
+				else if(strcmp(optarg, "block") == 0) { exec_engine = ENGINE_BLOCK; }
+				else if(strcmp(optarg, "jit") == 0) { exec_engine = ENGINE_JIT; }
+				else { panic("unknown execution engine '%s'", optarg); }
+				break;
+			case 'c': jit_check = true; break;
+			case 't': trace_on = true; break;
+			case 'f': trace_file = optarg; break;
+			case 'r': trace_regs = true; break;
+			case 'p':
+				if(!repl_parse(optarg)) { panic("bad replacement policy '%s', use l1|l2|tlb=plru|lru|srrip|random", optarg); }
+				break;
+			case 's': repl_seed = strtoull(optarg, NULL, 0); break;
+			case 'm':
+				if(strcmp(optarg, "fast") == 0) { mem_model = MEM_FAST; }
+				else if(strcmp(optarg, "cache") == 0) { mem_model = MEM_CACHE; }
+				else { panic("unknown memory model '%s'", optarg); }
+				break;
+			case 'l':
+				if(strcmp(optarg, "inclusive") == 0) { cache_L2_mode = CACHE_INCLUSIVE; }
+				else if(strcmp(optarg, "exclusive") == 0) { cache_L2_mode = CACHE_EXCLUSIVE; }
+				else { panic("unknown L2 mode '%s'", optarg); }
+				break;
+			case 'C':
+				if(!cache_parse(optarg)) { panic("bad cache configuration '%s', use l1|l2:size=N,ways=N,line=N,write=wb|wt,repl=POLICY", optarg); }
+				break;
+			case 'T': timing_on = true; break;
+			case 'S': stats_file = optarg; break;
+			case 'z':
+				if(!parse_mem_size(optarg)) { panic("bad memory size '%s', use a multiple of 4K up to 3G, such as 512M", optarg); }
+				break;
+			case 'i': hw_mem_file = optarg; break;
+			case 'k': load_file = optarg; break;
+			case 'a': entry_file = optarg; break;
+			case 'L':
+				if(!timing_parse(optarg)) { panic("bad latency '%s', use instr|l1|l2|row-hit|row-miss|tlb-miss|walk=CYCLES", optarg); }
+				break;
+			default:
+				panic("usage: nemu [--engine=interp|block|jit] [--jit-check] "
+						"[--trace] [--trace-file=FILE [--trace-regs]] "
+						"[--mem=fast|cache [--cache=l1|l2:KEY=VAL,...]... [--l2=inclusive|exclusive] [--timing [--lat=NAME=CYCLES]...]] [--mem-size=SIZE] [--mem-file=FILE] [--load=CHECKPOINT] [--save-at-entry=CHECKPOINT] [--stats=FILE] [--repl=l1|l2|tlb=POLICY]... [--seed=N] [program]");
+		}
+	}
+	if(timing_on && mem_model != MEM_CACHE) { panic("--timing needs --mem=cache"); }
+	return optind;
+}
+
 void init_monitor(int argc, char *argv[]) {
 	/* Perform some global initialization */
 
+	/* Parse the command line options. */
+	int argi = parse_args(argc, argv);
+
+	/* Map the guest memory and start tracking writes to it. */
+	init_hw_mem();
+	init_dirty();
+
 	/* Open the log file. */
 	init_log();
 
+	/* Set up the instruction trace ring buffer. */
+	init_trace();
+
 	/* Load the string table and symbol table from the ELF file for future use. */
-	load_elf_tables(argc, argv);
+	load_elf_tables(argc - argi + 1, argv + argi - 1);
 
 	/* Compile the regular expressions. */
 	init_regex();
@@ -59,6 +171,7 @@ static void init_ramdisk() {
 	fseek(fp, 0, SEEK_SET);
 	ret = fread(hwa_to_va(0), file_size, 1, fp);
 	assert(ret == 1);
+	dirty_mark(0, file_size);
 	fclose(fp);
 }
 #endif
@@ -74,6 +187,7 @@ static void load_entry() {
 	fseek(fp, 0, SEEK_SET);
 	ret = fread(hwa_to_va(ENTRY_START), file_size, 1, fp);
 	assert(ret == 1);
+	dirty_mark(ENTRY_START, file_size);
 	fclose(fp);
 }
 
@@ -90,21 +204,45 @@ void restart() {
 	/* Set the initial instruction pointer. */
 	cpu.eip = ENTRY_START;
   cpu.eflags.val = 0x00000002;
+  cpu.lf.op = LF_NONE;
 
   /* Initialize the cahce */
-  init_cache();
+  if (mem_model == MEM_CACHE) init_cache();
 
   /* Initialize the TLB*/
   init_tlb();
 
+  /* Initialize the timing model and the cache statistics */
+  init_timing();
+  init_stats();
+
+  /* Initialize the decoded-instruction cache */
+  init_decode_cache();
+
+  /* Initialize the translated blocks */
+  init_block();
+  init_jit();
+
   /* Initialize the Segment Register*/
   cpu.cr0.protect_enable = 0;
   cpu.cr0.paging = 0;
+  cpu.cr4.val = 0;
 
   /* Initialize CS Register */
   cpu.cs.base = 0;
   cpu.cs.limit = 0xffffffff;
+  current_sreg = R_DS;
+  cpu.idtr.limit = 0;
+  cpu.INTR = false;
+
+  /* Initialize the FPU as fninit does */
+  fpu_init();
 
 	/* Initialize DRAM. */
-	init_ddr3();
+	if(mem_model == MEM_CACHE) { init_ddr3(); }
+
+	/* Continue from the checkpoint given on the command line. */
+	if(load_file != NULL) {
+		Assert(checkpoint_load(load_file), "Can not load '%s'", load_file);
+	}
 }
@@ -0,0 +1,162 @@
+#include "nemu.h"
+#include "monitor/timing.h"
+#include "monitor/elf.h"
+#include <stdlib.h>
+
+bool timing_on = false;
+int timing_mute = 0;
+
+uint32_t timing_lat[NR_LAT] = { 1, 1, 10, 4, 40, 8, 20 };
+static const char *lat_name[NR_LAT] = { "instr", "l1", "l2", "row-hit", "row-miss", "tlb-miss", "walk" };
+
+const int timing_event_lat[NR_T_EVENT] = {
+	LAT_L1, LAT_L1, LAT_L2, LAT_L2, LAT_ROW_HIT, LAT_ROW_MISS, LAT_TLB_MISS, LAT_WALK
+};
+uint64_t timing_count[NR_T_EVENT];
+uint64_t timing_pending;
+
+/* Instructions are classified by what they did: a control transfer
+ * which was taken, a data access, or neither.
+ */
+enum { CLASS_ALU, CLASS_MEM, CLASS_CONTROL, NR_CLASS };
+static const char *class_name[NR_CLASS] = { "alu", "memory", "control" };
+static uint64_t class_instr[NR_CLASS], class_cycles[NR_CLASS];
+
+/* per function symbol, the last slot is for code outside any function */
+static uint64_t *func_instr, *func_cycles;
+static int nr_func;
+
+/* the function of the last instruction */
+static int cur_func;
+static swaddr_t cur_start, cur_end;
+
+/* L1 accesses when the last instruction was accounted */
+static uint64_t last_l1;
+
+void init_timing() {
+	memset(timing_count, 0, sizeof(timing_count));
+	timing_pending = 0;
+	memset(class_instr, 0, sizeof(class_instr));
+	memset(class_cycles, 0, sizeof(class_cycles));
+
+	nr_func = nr_symbol();
+	free(func_instr);
+	free(func_cycles);
+	func_instr = calloc(nr_func + 1, sizeof(uint64_t));
+	func_cycles = calloc(nr_func + 1, sizeof(uint64_t));
+	assert(func_instr && func_cycles);
+	cur_start = cur_end = 0;
+	last_l1 = 0;
+}
+
+/* Parse `NAME=CYCLES' as given to `--lat'. */
+bool timing_parse(const char *arg) {
+	const char *eq = strchr(arg, '=');
+	if(eq == NULL) { return false; }
+	int i;
+	for(i = 0; i < NR_LAT; i ++) {
+		if(strlen(lat_name[i]) == eq - arg && strncmp(arg, lat_name[i], eq - arg) == 0) {
+			char *end;
+			unsigned long val = strtoul(eq + 1, &end, 0);
+			if(eq[1] == '\0' || *end != '\0') { return false; }
+			timing_lat[i] = val;
+			return true;
+		}
+	}
+	return false;
+}
+
+static inline uint64_t l1_accesses() {
+	return timing_count[T_L1_HIT] + timing_count[T_L1_MISS];
+}
+
+/* Called after the instruction at `eip' with length `len' has been
+ * executed. Charge its fetch and account its cycles.
+ */
+void timing_instr(swaddr_t eip, int len) {
+	int c = CLASS_ALU;
+	if(cpu.eip != eip + len) { c = CLASS_CONTROL; }
+	else if(l1_accesses() != last_l1) { c = CLASS_MEM; }
+
+	timing_fetch(eip, len);
+	last_l1 = l1_accesses();
+
+	uint64_t cycles = timing_lat[LAT_INSTR] + timing_pending;
+	timing_pending = 0;
+	class_instr[c] ++;
+	class_cycles[c] += cycles;
+
+	if(eip < cur_start || eip >= cur_end) {
+		cur_func = find_function(eip, &cur_start, &cur_end);
+		if(cur_func == -1) {
+			cur_func = nr_func;
+			cur_start = eip;
+			cur_end = eip + 1;
+		}
+	}
+	func_instr[cur_func] ++;
+	func_cycles[cur_func] += cycles;
+}
+
+static int cmp_func(const void *a, const void *b) {
+	uint64_t x = func_cycles[*(const int *)a], y = func_cycles[*(const int *)b];
+	return (x < y) - (x > y);
+}
+
+#define llu(x) ((unsigned long long)(x))
+
+void info_timing() {
+	if(!timing_on) {
+		printf("Timing is off, run with --mem=cache --timing\n");
+		return;
+	}
+
+	int i;
+	uint64_t instr = 0, cycles = 0;
+	for(i = 0; i < NR_CLASS; i ++) {
+		instr += class_instr[i];
+		cycles += class_cycles[i];
+	}
+	printf("latency");
+	for(i = 0; i < NR_LAT; i ++) { printf(" %s=%u", lat_name[i], timing_lat[i]); }
+	printf("\ninstructions\t%llu\ncycles\t\t%llu\n", llu(instr), llu(cycles));
+	if(instr == 0) { return; }
+	printf("CPI\t\t%.3f\n", (double)cycles / instr);
+
+	printf("\nclass\tinstrs\t\tcycles\t\tCPI\n");
+	for(i = 0; i < NR_CLASS; i ++) {
+		if(class_instr[i] == 0) { continue; }
+		printf("%s\t%-12llu\t%-12llu\t%.3f\n", class_name[i], llu(class_instr[i]), llu(class_cycles[i]),
+				(double)class_cycles[i] / class_instr[i]);
+	}
+
+	/* AMAT = L1 time + L1 miss rate * (L2 time + L2 miss rate * DRAM cycles per L2 miss),
+	 * where the DRAM cycles include the write-backs */
+	uint64_t *n = timing_count;
+	uint64_t l1 = n[T_L1_HIT] + n[T_L1_MISS], l2 = n[T_L2_HIT] + n[T_L2_MISS];
+	uint64_t dram = n[T_ROW_HIT] * timing_lat[LAT_ROW_HIT] + n[T_ROW_MISS] * timing_lat[LAT_ROW_MISS];
+	double m1 = (l1 ? (double)n[T_L1_MISS] / l1 : 0);
+	double m2 = (l2 ? (double)n[T_L2_MISS] / l2 : 0);
+	double penalty = (n[T_L2_MISS] ? (double)dram / n[T_L2_MISS] : 0);
+	printf("\nAMAT\t%.3f = %u + %.4f * (%u + %.4f * %.1f)\n",
+			timing_lat[LAT_L1] + m1 * (timing_lat[LAT_L2] + m2 * penalty),
+			timing_lat[LAT_L1], m1, timing_lat[LAT_L2], m2, penalty);
+	printf("L1\t%llu accesses, %llu misses\n", llu(l1), llu(n[T_L1_MISS]));
+	printf("L2\t%llu accesses, %llu misses\n", llu(l2), llu(n[T_L2_MISS]));
+	printf("DRAM\t%llu bursts, %llu row misses, %llu cycles\n",
+			llu(n[T_ROW_HIT] + n[T_ROW_MISS]), llu(n[T_ROW_MISS]), llu(dram));
+	printf("TLB\t%llu misses, %llu walk reads\n", llu(n[T_TLB_MISS]), llu(n[T_WALK]));
+
+	int *order = malloc(sizeof(int) * (nr_func + 1));
+	assert(order);
+	for(i = 0; i <= nr_func; i ++) { order[i] = i; }
+	qsort(order, nr_func + 1, sizeof(int), cmp_func);
+	printf("\nfunction\t\tinstrs\t\tcycles\t\tCPI\t%%cycles\n");
+	for(i = 0; i <= nr_func && func_cycles[order[i]] != 0; i ++) {
+		int f = order[i];
+		printf("%-16s\t%-12llu\t%-12llu\t%.3f\t%.2f%%\n", (f == nr_func ? "?" : symbol_name(f)),
+				llu(func_instr[f]), llu(func_cycles[f]), (double)func_cycles[f] / func_instr[f],
+				100.0 * func_cycles[f] / cycles);
+	}
+	free(order);
+}
@@ -0,0 +1,154 @@
+#include "cpu/helper.h"
+#include "monitor/trace.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+bool trace_on = false;
+bool trace_regs = false;
+const char *trace_file = NULL;
+
+static struct {
+	swaddr_t eip;
+	uint32_t len;
+} ring[TRACE_RING_SIZE];
+static uint32_t ring_head = 0;
+
+/* the binary trace file */
+static int trace_fd = -1;
+static uint8_t *buf;
+static uint32_t buf_len;
+static swaddr_t next_eip;
+static uint32_t last_gpr[8];
+
+#ifdef DEBUG
+extern char assembly[];
+#endif
+
+static void trace_flush() {
+	uint32_t off = 0;
+	while(off < buf_len) {
+		ssize_t ret = write(trace_fd, buf + off, buf_len - off);
+		Assert(ret > 0, "Can not write to '%s'", trace_file);
+		off += ret;
+	}
+	buf_len = 0;
+}
+
+static void trace_close() {
+	if(trace_fd == -1) { return; }
+	trace_flush();
+	close(trace_fd);
+	trace_fd = -1;
+}
+
+static void trace_write(swaddr_t eip, int len) {
+	if(buf_len + TRACE_REC_MAX > TRACE_BUF_SIZE) { trace_flush(); }
+
+	uint8_t *p = buf + buf_len;
+	uint8_t *tag = p ++;
+	*tag = len;
+	if(eip != next_eip) {
+		*tag |= TRACE_TAG_EIP;
+		memcpy(p, &eip, 4);
+		p += 4;
+	}
+
+	/* the bytes the decoder read, not fetched again */
+	memcpy(p, decode_cache_bytes(), len);
+	p += len;
+
+#ifdef DEBUG
+	int l = strnlen(assembly, TRACE_ASM_MAX - 1);
+	memcpy(p, assembly, l);
+	p += l;
+	*p ++ = '\0';
+#endif
+
+	int i;
+
+	if(trace_regs) {
+		uint8_t *mask = p ++;
+		*mask = 0;
+		for(i = R_EAX; i <= R_EDI; i ++) {
+			if(reg_l(i) != last_gpr[i]) {
+				*mask |= 1 << i;
+				last_gpr[i] = reg_l(i);
+				memcpy(p, &last_gpr[i], 4);
+				p += 4;
+			}
+		}
+	}
+
+	next_eip = eip + len;
+	buf_len = p - buf;
+}
+
+void trace_record(swaddr_t eip, int len) {
+	ring[ring_head & (TRACE_RING_SIZE - 1)].eip = eip;
+	ring[ring_head & (TRACE_RING_SIZE - 1)].len = len;
+	ring_head ++;
+
+	if(trace_fd != -1) { trace_write(eip, len); }
+}
+
+/* Write the instructions in the ring buffer to the log file, oldest
+ * first. With a trace file, just write out what is buffered.
+ */
+void trace_dump() {
+	if(!trace_on) { return; }
+
+	if(trace_fd != -1) {
+		trace_flush();
+		return;
+	}
+
+	/* the instruction bytes are fetched again now, without a trace */
+	trace_on = false;
+
+	void print_bin_instr(swaddr_t, int);
+	extern char asm_buf[];
+	uint32_t i = (ring_head > TRACE_RING_SIZE ? ring_head - TRACE_RING_SIZE : 0);
+	fprintf(log_fp, "---- last %u instructions ----\n", ring_head - i);
+	for(; i != ring_head; i ++) {
+		print_bin_instr(ring[i & (TRACE_RING_SIZE - 1)].eip, ring[i & (TRACE_RING_SIZE - 1)].len);
+		fprintf(log_fp, "%s\n", asm_buf);
+	}
+	fflush(log_fp);
+}
+
+static void crash_handler(int sig) {
+	trace_dump();
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+void init_trace() {
+	if(trace_file != NULL) {
+		trace_on = true;
+		trace_fd = open(trace_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		Assert(trace_fd != -1, "Can not open '%s'", trace_file);
+
+		buf = malloc(TRACE_BUF_SIZE);
+		assert(buf);
+		memcpy(buf, TRACE_MAGIC, TRACE_MAGIC_LEN);
+		uint32_t flags = (trace_regs ? TRACE_F_REGS : 0);
+#ifdef DEBUG
+		flags |= TRACE_F_ASM;
+#endif
+		memcpy(buf + TRACE_MAGIC_LEN, &flags, 4);
+		buf_len = TRACE_MAGIC_LEN + 4;
+
+		/* the first record always carries its EIP */
+		next_eip = ~0;
+		memset(last_gpr, 0, sizeof(last_gpr));
+		atexit(trace_close);
+	}
+
+	if(!trace_on) { return; }
+	ring_head = 0;
+	signal(SIGABRT, crash_handler);
+	signal(SIGSEGV, crash_handler);
+	signal(SIGFPE, crash_handler);
+}
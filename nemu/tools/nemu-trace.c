@@ -0,0 +1,87 @@
+#include "monitor/trace.h"
+#include <stdlib.h>
+
+/* Print a binary trace written by `nemu --trace-file=FILE' in the format
+ * of the DEBUG log. The assembly column is only in traces written by the
+ * DEBUG build, whose execute helpers print it. The registers written by
+ * each instruction follow it when the trace has them.
+ */
+
+static const char *regsl[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
+
+static FILE *fp;
+
+static void truncated() {
+	fprintf(stderr, "nemu-trace: truncated trace\n");
+	exit(1);
+}
+
+static void read_or_die(void *p, size_t len) {
+	if(fread(p, len, 1, fp) != 1) { truncated(); }
+}
+
+int main(int argc, char *argv[]) {
+	if(argc != 2) {
+		fprintf(stderr, "usage: nemu-trace FILE\n");
+		return 1;
+	}
+	fp = fopen(argv[1], "rb");
+	if(fp == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	char magic[TRACE_MAGIC_LEN];
+	uint32_t flags;
+	read_or_die(magic, TRACE_MAGIC_LEN);
+	if(memcmp(magic, TRACE_MAGIC, TRACE_MAGIC_LEN) != 0) {
+		fprintf(stderr, "nemu-trace: %s is not a NEMU trace\n", argv[1]);
+		return 1;
+	}
+	read_or_die(&flags, 4);
+
+	swaddr_t eip = 0;
+	int c;
+	while((c = fgetc(fp)) != EOF) {
+		uint8_t tag = c;
+		int len = tag & TRACE_TAG_LEN;
+		if(tag & TRACE_TAG_EIP) { read_or_die(&eip, 4); }
+
+		uint8_t bytes[TRACE_TAG_LEN];
+		read_or_die(bytes, len);
+
+		char line[512];
+		int i, l = sprintf(line, "%8x:   ", eip);
+		for(i = 0; i < len; i ++) {
+			l += sprintf(line + l, "%02x ", bytes[i]);
+		}
+		l += sprintf(line + l, "%*.s", 50 - (12 + 3 * len), "");
+
+		if(flags & TRACE_F_ASM) {
+			for(i = 0; (c = fgetc(fp)) > 0; i ++) {
+				if(i < TRACE_ASM_MAX) { line[l ++] = c; }
+			}
+			if(c == EOF) { truncated(); }
+			line[l] = '\0';
+			if(flags & TRACE_F_REGS) { l += sprintf(line + l, " "); }
+		}
+
+		if(flags & TRACE_F_REGS) {
+			uint8_t mask;
+			read_or_die(&mask, 1);
+			for(i = 0; i < 8; i ++) {
+				if(mask & (1 << i)) {
+					uint32_t val;
+					read_or_die(&val, 4);
+					l += sprintf(line + l, "%s=0x%08x ", regsl[i], val);
+				}
+			}
+		}
+
+		puts(line);
+		eip += len;
+	}
+
+	fclose(fp);
+	return 0;
+}
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Check the dirty-page tracking through incremental checkpoints: stop
+# obj/testcase/dirty after each phase to save a checkpoint, then run it
+# on from the second one in a new NEMU, which must end as the first one
+# does. The memory the program wrote is dumped when the second
+# checkpoint is saved and again right after it is loaded, and the dumps
+# must agree: a page restored from the first checkpoint can still end
+# well, if the stale stack returns into the second phase to write it
+# again. Any arguments are passed to NEMU, e.g. --mem=cache.
+
+nemu=obj/nemu/nemu
+file=obj/testcase/dirty
+dir=`mktemp -d`
+
+addr() {
+	nm $file | awk -v s=$1 '$3 == s { print "0x" $1 }'
+}
+
+# the 48 pages of `buf' and the top of the stack, which starts at 128MB
+dump="x 12288 `addr buf`\nx 64 0x7ffff00"
+
+cmd="w \$eip == `addr phase1_done`\nc\nd 0\nsave $dir/a\nw \$eip == `addr phase2_done`\nc\nd 1\nsave $dir/b\n$dump\nc\nq"
+echo -e $cmd | $nemu $@ $file > $dir/save-log.txt 2>&1
+echo -e "$dump\nc\nq" | $nemu $@ --load=$dir/b $file > $dir/load-log.txt 2>&1
+grep -a '^0x' $dir/save-log.txt > $dir/save-dump.txt
+grep -a '^0x' $dir/load-log.txt > $dir/load-dump.txt
+
+printf "[dirty $*]: "
+trap=`grep -a 'nemu: HIT GOOD TRAP' $dir/save-log.txt`
+if (test -n "$trap" && grep -q "Saved .* to '$dir/b'" $dir/save-log.txt && test -s $dir/save-dump.txt &&
+		cmp -s $dir/save-dump.txt $dir/load-dump.txt && grep -aqF "$trap" $dir/load-log.txt) then
+	echo -e "\033[1;32mPASS!\033[0m"
+	rm -rf $dir
+else
+	echo -e "\033[1;31mFAIL!\033[0m see $dir for more information"
+fi
@@ -0,0 +1,25 @@
+/* Run the conformance forms on the host processor and print the hashes
+ * NEMU should reproduce, as testcase/include/conformance-ref.h.
+ */
+
+#include <stdio.h>
+#include <sys/mman.h>
+#include "conformance.h"
+
+int main() {
+	int f;
+	void *p = mmap((void *)CONF_MEM_ADDR, CONF_MEM_WORDS * 4, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+	if(p != (void *)CONF_MEM_ADDR) {
+		fprintf(stderr, "can not map the window at 0x%08x\n", CONF_MEM_ADDR);
+		return 1;
+	}
+
+	printf("/* Generated by testcase/conformance/gen.c, do not edit. */\n\n");
+	printf("static const uint32_t conf_ref[] = {\n");
+	for(f = 0; f < NR_CONF_FORM; f ++) {
+		printf("\t0x%08x,\t/* %s */\n", conf_form_hash(f), conf_form[f].name);
+	}
+	printf("};\n");
+	return 0;
+}
@@ -0,0 +1,507 @@
+/* Generated by testcase/conformance/gen.c, do not edit. */
+
+static const uint32_t conf_ref[] = {
+	0x693e1ade,	/* addb_rr */
+	0x6354179a,	/* addw_rr */
+	0xcfe57384,	/* addl_rr */
+	0x99450c19,	/* addl_rr2 */
+	0x67a0f461,	/* addb_rm */
+	0x61d8c3d3,	/* addw_rm */
+	0xd5c8d044,	/* addl_rm */
+	0x96c7f261,	/* addb_mr */
+	0xcb9c0e12,	/* addl_mr */
+	0xfdb16cc9,	/* addb_ia */
+	0xc81cf1ca,	/* addw_ia */
+	0x30001dde,	/* addl_ia */
+	0x52631930,	/* addb_ir */
+	0xc5a25420,	/* addl_ir */
+	0x477e534a,	/* addw_sr */
+	0x53186207,	/* addl_sr */
+	0x9da01903,	/* addl_sm */
+	0xbd23de89,	/* orb_rr */
+	0xa2219de0,	/* orw_rr */
+	0xd83fa151,	/* orl_rr */
+	0xfd935e88,	/* orl_rr2 */
+	0x130b4a06,	/* orb_rm */
+	0x32375cfb,	/* orw_rm */
+	0x409edff5,	/* orl_rm */
+	0x6d220ac8,	/* orb_mr */
+	0x72f70c9e,	/* orl_mr */
+	0x5b81f8ab,	/* orb_ia */
+	0xa09588bd,	/* orw_ia */
+	0x33b4b290,	/* orl_ia */
+	0x4214b88b,	/* orb_ir */
+	0x3a719dcd,	/* orl_ir */
+	0xd5bd7ed1,	/* orw_sr */
+	0x5d361b72,	/* orl_sr */
+	0xf46938ab,	/* orl_sm */
+	0x4742a00f,	/* adcb_rr */
+	0x00f458df,	/* adcw_rr */
+	0xb478ebb1,	/* adcl_rr */
+	0x2c991522,	/* adcl_rr2 */
+	0x77fa80bf,	/* adcb_rm */
+	0xbf0daa76,	/* adcw_rm */
+	0x04372478,	/* adcl_rm */
+	0xc47bae05,	/* adcb_mr */
+	0x0602c887,	/* adcl_mr */
+	0x6f60c297,	/* adcb_ia */
+	0xe872c273,	/* adcw_ia */
+	0xa60cce4f,	/* adcl_ia */
+	0xc3bd72bc,	/* adcb_ir */
+	0x6afd3a22,	/* adcl_ir */
+	0x6db2036d,	/* adcw_sr */
+	0xf6597819,	/* adcl_sr */
+	0x42f14fb5,	/* adcl_sm */
+	0x5adabb81,	/* sbbb_rr */
+	0xa3459ac7,	/* sbbw_rr */
+	0xdd1c0f73,	/* sbbl_rr */
+	0x91078d52,	/* sbbl_rr2 */
+	0x7614ded7,	/* sbbb_rm */
+	0x45415010,	/* sbbw_rm */
+	0x4a9d91eb,	/* sbbl_rm */
+	0x2df707b6,	/* sbbb_mr */
+	0x21d4b044,	/* sbbl_mr */
+	0xebd7428f,	/* sbbb_ia */
+	0x96e5449a,	/* sbbw_ia */
+	0xc6994796,	/* sbbl_ia */
+	0x9111029a,	/* sbbb_ir */
+	0x05c78013,	/* sbbl_ir */
+	0x86b9480c,	/* sbbw_sr */
+	0xcd4dcdb9,	/* sbbl_sr */
+	0xb12ed5ff,	/* sbbl_sm */
+	0xfc8b267d,	/* andb_rr */
+	0xf20a9d60,	/* andw_rr */
+	0xa1f41439,	/* andl_rr */
+	0x9179fa91,	/* andl_rr2 */
+	0xef0b43a3,	/* andb_rm */
+	0xc40c74f3,	/* andw_rm */
+	0x26a876d9,	/* andl_rm */
+	0xab82e00d,	/* andb_mr */
+	0x67ec4966,	/* andl_mr */
+	0x7dbab67e,	/* andb_ia */
+	0xbe7ae842,	/* andw_ia */
+	0x34d6fadb,	/* andl_ia */
+	0x51353bdd,	/* andb_ir */
+	0x0a237dff,	/* andl_ir */
+	0xd0c11625,	/* andw_sr */
+	0x5fcf54c1,	/* andl_sr */
+	0x66346959,	/* andl_sm */
+	0xd2a15a7a,	/* subb_rr */
+	0xa82968a7,	/* subw_rr */
+	0x9e44319e,	/* subl_rr */
+	0xd900ed81,	/* subl_rr2 */
+	0x51b2bb5b,	/* subb_rm */
+	0x2036761e,	/* subw_rm */
+	0x6a93fa38,	/* subl_rm */
+	0x3fc71216,	/* subb_mr */
+	0x9b6c9482,	/* subl_mr */
+	0x0f36d055,	/* subb_ia */
+	0x8d5703b2,	/* subw_ia */
+	0x13a574a4,	/* subl_ia */
+	0xdaccbc95,	/* subb_ir */
+	0x064ef49b,	/* subl_ir */
+	0x2a02cfef,	/* subw_sr */
+	0xf72e3619,	/* subl_sr */
+	0xc31cfc49,	/* subl_sm */
+	0xf7169a07,	/* xorb_rr */
+	0x1d24608d,	/* xorw_rr */
+	0x92a2dffd,	/* xorl_rr */
+	0xb6b1ac6b,	/* xorl_rr2 */
+	0xc9ea249e,	/* xorb_rm */
+	0xf06779ef,	/* xorw_rm */
+	0xb1e077f1,	/* xorl_rm */
+	0xd10b9a70,	/* xorb_mr */
+	0x8a2faca2,	/* xorl_mr */
+	0x8a1b92b8,	/* xorb_ia */
+	0x098d82a3,	/* xorw_ia */
+	0xb088ea32,	/* xorl_ia */
+	0x6dbb40a0,	/* xorb_ir */
+	0xa785bf22,	/* xorl_ir */
+	0xc9dd6a16,	/* xorw_sr */
+	0x718ac337,	/* xorl_sr */
+	0xd44abc7c,	/* xorl_sm */
+	0xa91de7f6,	/* cmpb_rr */
+	0x303899b9,	/* cmpw_rr */
+	0x4d9d0980,	/* cmpl_rr */
+	0xb0e1ca3c,	/* cmpl_rr2 */
+	0x5566913a,	/* cmpb_rm */
+	0x668187d3,	/* cmpw_rm */
+	0xdd628037,	/* cmpl_rm */
+	0x4052ea6a,	/* cmpb_mr */
+	0xd4a61e30,	/* cmpl_mr */
+	0x85ebc97e,	/* cmpb_ia */
+	0x3bea6ea7,	/* cmpw_ia */
+	0x8c60edd2,	/* cmpl_ia */
+	0xd717cc8e,	/* cmpb_ir */
+	0xa42892a9,	/* cmpl_ir */
+	0xa4f816dc,	/* cmpw_sr */
+	0x3a5c9458,	/* cmpl_sr */
+	0x2419a5ba,	/* cmpl_sm */
+	0xa360fde3,	/* addb_82 */
+	0x25d56082,	/* sbbb_82 */
+	0xb69e11a5,	/* testb_rr */
+	0x88b235c7,	/* testl_rm */
+	0x6ebe544d,	/* testb_ia */
+	0x293fba6f,	/* testl_ia */
+	0xe5cae2ca,	/* testw_ir */
+	0xf6a36255,	/* testb_f6_1 */
+	0x6b9a834b,	/* incb */
+	0xcb24728b,	/* incw */
+	0xe0784bcf,	/* incl */
+	0xc2256491,	/* incl_r */
+	0x894da83a,	/* incl_m */
+	0xef988b8e,	/* decb_m */
+	0xe7d9ebfa,	/* decw */
+	0x9e363e58,	/* decl */
+	0x18980188,	/* decl_r */
+	0x345a88c9,	/* negb */
+	0x1b5de6e4,	/* negw */
+	0x7481c41d,	/* negl */
+	0x6d9b1525,	/* negl_m */
+	0xccde327b,	/* notb */
+	0x49d56511,	/* notl_m */
+	0x86efd112,	/* mulb */
+	0xbf41115d,	/* mulw */
+	0xfcc19e15,	/* mull */
+	0x2919306b,	/* mull_m */
+	0x4f02fd3e,	/* imulb */
+	0xc3305d82,	/* imulw */
+	0xe9f937e6,	/* imull */
+	0x2942a5f0,	/* imulw_rr */
+	0x797f09b9,	/* imull_rr */
+	0x983afbb9,	/* imull_mr */
+	0x510de059,	/* imull_si */
+	0x6e67de0d,	/* imull_i */
+	0xfaa84c58,	/* imulw_si */
+	0xad1f5469,	/* divb */
+	0xa89aa6f2,	/* divw */
+	0x1c551545,	/* divl */
+	0x6746785c,	/* idivb */
+	0x87018478,	/* idivw */
+	0xc559fa96,	/* idivl */
+	0xdc74ec49,	/* shlb_1 */
+	0xe3141a95,	/* shlw_1 */
+	0xc5bcce80,	/* shll_1 */
+	0xaf77e808,	/* shll_1m */
+	0xeee4eed1,	/* shlb_cl */
+	0x8c1d0083,	/* shlw_cl */
+	0x34533ec2,	/* shll_cl */
+	0x4c6037b7,	/* shlb_3 */
+	0xcdb172cd,	/* shlw_7 */
+	0x55dfeb1b,	/* shll_13 */
+	0x130db5ac,	/* shll_0 */
+	0x2730d846,	/* shlb_9 */
+	0xd6c8a40b,	/* shlw_17 */
+	0xddccb8f4,	/* shll_33 */
+	0x0826c0ad,	/* shrb_1 */
+	0x7db1cdc5,	/* shrw_1 */
+	0x2ff621de,	/* shrl_1 */
+	0xd7e3144e,	/* shrl_1m */
+	0x0ed09f8c,	/* shrb_cl */
+	0x3001d8e7,	/* shrw_cl */
+	0xa16dd927,	/* shrl_cl */
+	0xbbdcddbf,	/* shrb_3 */
+	0x89d66df9,	/* shrw_7 */
+	0x37ccf3cf,	/* shrl_13 */
+	0x5b403d16,	/* shrl_0 */
+	0x58a03ccc,	/* shrb_9 */
+	0xe1d25c30,	/* shrw_17 */
+	0x4390cdb3,	/* shrl_33 */
+	0xa39ed17d,	/* sarb_1 */
+	0x3f546ce2,	/* sarw_1 */
+	0x52c1ee19,	/* sarl_1 */
+	0xa57acd67,	/* sarl_1m */
+	0x79f15d58,	/* sarb_cl */
+	0x5c542102,	/* sarw_cl */
+	0xe1db45ea,	/* sarl_cl */
+	0x64aa2c01,	/* sarb_3 */
+	0xddbe9dd1,	/* sarw_7 */
+	0x0aac7aa1,	/* sarl_13 */
+	0x3d647010,	/* sarl_0 */
+	0xd9b1374e,	/* sarb_9 */
+	0xdea5ea15,	/* sarw_17 */
+	0x969a52ce,	/* sarl_33 */
+	0x0b4037ec,	/* rolb_1 */
+	0xe06cdb4e,	/* rolw_1 */
+	0x927f78c3,	/* roll_1 */
+	0x7dc49725,	/* roll_1m */
+	0xc80ae993,	/* rolb_cl */
+	0x0ac37a18,	/* rolw_cl */
+	0x5300b903,	/* roll_cl */
+	0xa6477233,	/* rolb_3 */
+	0x5fc5a879,	/* rolw_7 */
+	0x64801d71,	/* roll_13 */
+	0xf7fe407b,	/* roll_0 */
+	0xb5bb7a5f,	/* rolb_9 */
+	0x048a6582,	/* rolw_17 */
+	0xb64f8106,	/* roll_33 */
+	0xba763776,	/* rorb_1 */
+	0x2e3f56f6,	/* rorw_1 */
+	0x9a4c9426,	/* rorl_1 */
+	0x68817708,	/* rorl_1m */
+	0x83106f2c,	/* rorb_cl */
+	0xb591acf2,	/* rorw_cl */
+	0x0cc195ee,	/* rorl_cl */
+	0xd3dde0de,	/* rorb_3 */
+	0x167d5d36,	/* rorw_7 */
+	0xa06074fb,	/* rorl_13 */
+	0x9ad95ad0,	/* rorl_0 */
+	0x541a411b,	/* rorb_9 */
+	0x5b27d6dd,	/* rorw_17 */
+	0xbd927a5f,	/* rorl_33 */
+	0x5517fd86,	/* rclb_1 */
+	0x000191cc,	/* rclw_1 */
+	0x2e3e3327,	/* rcll_1 */
+	0x4389d431,	/* rcll_1m */
+	0x811979fe,	/* rclb_cl */
+	0x413c55c8,	/* rclw_cl */
+	0x03cf0382,	/* rcll_cl */
+	0x005c3980,	/* rclb_3 */
+	0x7cca0853,	/* rclw_7 */
+	0x051d95d5,	/* rcll_13 */
+	0xefdd2b2f,	/* rcll_0 */
+	0xc9bee8c0,	/* rclb_9 */
+	0x163ca708,	/* rclw_17 */
+	0x39d49bc3,	/* rcll_33 */
+	0xb38c0497,	/* rcrb_1 */
+	0xbc6bc8f4,	/* rcrw_1 */
+	0x391a6e73,	/* rcrl_1 */
+	0xe12d071e,	/* rcrl_1m */
+	0x73c7c266,	/* rcrb_cl */
+	0xc6eef64b,	/* rcrw_cl */
+	0x0b76631a,	/* rcrl_cl */
+	0xf1432625,	/* rcrb_3 */
+	0x7b394e38,	/* rcrw_7 */
+	0x4d09bf36,	/* rcrl_13 */
+	0x411465ef,	/* rcrl_0 */
+	0xfce8416c,	/* rcrb_9 */
+	0xf862c781,	/* rcrw_17 */
+	0xd7e7614e,	/* rcrl_33 */
+	0xdfdfc44c,	/* sall_d1_6 */
+	0x894feb2d,	/* shldl_i */
+	0x9d686622,	/* shldl_1 */
+	0x43f5dd21,	/* shldl_0 */
+	0x2ec170de,	/* shldl_cl */
+	0x1ce63838,	/* shldw_i */
+	0xd5db16e9,	/* shrdl_i */
+	0x8cb0c362,	/* shrdl_1 */
+	0x89177800,	/* shrdl_cl */
+	0xec4eef8a,	/* shrdl_m */
+	0xf5344227,	/* shrdw_i */
+	0x5b9d1118,	/* shldw_cl */
+	0x7e42b398,	/* shrdw_cl */
+	0xb531ffdf,	/* btl_rr */
+	0x3c09885c,	/* btw_rr */
+	0xf8414a52,	/* btl_rm */
+	0x6370ddf3,	/* btsl_rr */
+	0xaf662c4f,	/* btsl_rm */
+	0x5392992a,	/* btrl_rr */
+	0x2e26ae4b,	/* btrw_rm */
+	0x28e1eea6,	/* btcl_rr */
+	0xfd6737c4,	/* btcl_rm */
+	0x1c4e71e0,	/* btl_i */
+	0x70ec64b2,	/* btsl_im */
+	0x0f8ce7d3,	/* btrw_i */
+	0xbbf34aa6,	/* btcl_i */
+	0xf10bc3ce,	/* bsfl */
+	0x8b458657,	/* bsfw */
+	0x9071c69f,	/* bsrl */
+	0x4096e25f,	/* bsrl_m */
+	0x5da98493,	/* bsrw_0 */
+	0xad767999,	/* seto */
+	0xfc9ed59e,	/* cmovo */
+	0xb4b2e0bb,	/* jo */
+	0xb6cd5ace,	/* jo_v */
+	0xa3134a4c,	/* setno */
+	0x888d1f89,	/* cmovno */
+	0x5f75f0be,	/* jno */
+	0x527298b2,	/* jno_v */
+	0x0f4a7690,	/* setb */
+	0x22f6dc57,	/* cmovb */
+	0x4be18915,	/* jb */
+	0x0ab14b13,	/* jb_v */
+	0x97ebd5a0,	/* setae */
+	0x489cadee,	/* cmovae */
+	0x1ad95e9b,	/* jae */
+	0xfb6d1911,	/* jae_v */
+	0x29e26aa7,	/* sete */
+	0x735c94f0,	/* cmove */
+	0xd43d1149,	/* je */
+	0x27173075,	/* je_v */
+	0xc33d14e2,	/* setne */
+	0x867a8e26,	/* cmovne */
+	0x9a9b6963,	/* jne */
+	0x297490ab,	/* jne_v */
+	0xd1436ab3,	/* setbe */
+	0xc89b843b,	/* cmovbe */
+	0x24ed56cf,	/* jbe */
+	0xd9f43d99,	/* jbe_v */
+	0xa0f06e82,	/* seta */
+	0x940f7232,	/* cmova */
+	0x63453622,	/* ja */
+	0x38c407f4,	/* ja_v */
+	0xbc2af1a4,	/* sets */
+	0x4bbd79cb,	/* cmovs */
+	0x0b873407,	/* js */
+	0xfdc26d26,	/* js_v */
+	0x2a6bc6ae,	/* setns */
+	0x79fe0fb9,	/* cmovns */
+	0xa651180a,	/* jns */
+	0xb79cc53c,	/* jns_v */
+	0x3183cb9e,	/* setp */
+	0xc0bfc4a4,	/* cmovp */
+	0xb4800d8d,	/* jp */
+	0x930a841b,	/* jp_v */
+	0xdf0149e9,	/* setnp */
+	0x550421e1,	/* cmovnp */
+	0x701657ad,	/* jnp */
+	0x2dec15e8,	/* jnp_v */
+	0x52bb883e,	/* setl */
+	0xcb8eece1,	/* cmovl */
+	0x26e27d50,	/* jl */
+	0x54f6f94d,	/* jl_v */
+	0x740b9e0e,	/* setge */
+	0xc19a79a9,	/* cmovge */
+	0x1d445c79,	/* jge */
+	0x50920464,	/* jge_v */
+	0xe47b082a,	/* setle */
+	0xa06fea41,	/* cmovle */
+	0x8e8b19fa,	/* jle */
+	0x16d2b7d0,	/* jle_v */
+	0xf44d8e3b,	/* setg */
+	0xfdeb575a,	/* cmovg */
+	0x3be8d5e1,	/* jg */
+	0x1473efa2,	/* jg_v */
+	0x0f83b1b1,	/* setne_m */
+	0xc1c84241,	/* cmovlw */
+	0xda3b91d8,	/* cmovgl_m */
+	0x83b9f005,	/* loop */
+	0xd14286f7,	/* loope */
+	0x26176c10,	/* loopne */
+	0xa2346d1f,	/* jecxz */
+	0x0e7fa3cb,	/* movsbl */
+	0x1a1a9f93,	/* movsbw */
+	0xcd98d8ee,	/* movzbl_m */
+	0x45da27dd,	/* movswl */
+	0x8df1ae34,	/* movzwl */
+	0x1d613824,	/* cbtw */
+	0xd6c56c54,	/* cwtl */
+	0xbd208489,	/* cwtd */
+	0x5d950eca,	/* cltd */
+	0xd8e9e0d9,	/* xchgl_a */
+	0xb4ecc6a7,	/* xchgw_a */
+	0x2996da34,	/* xchgb_rr */
+	0x06052c33,	/* xchgl_rm */
+	0x74d4a394,	/* bswap */
+	0xcb6d14b4,	/* xlat */
+	0xf8a2c641,	/* leal_sib */
+	0xe996e345,	/* leaw */
+	0x09240bbb,	/* cmpxchgl_rr */
+	0x1eeda33c,	/* cmpxchgb_rr */
+	0x361ba3d5,	/* cmpxchgw_rr */
+	0xb0efa6b4,	/* cmpxchgl_rm */
+	0x7be9ff5b,	/* xaddl_rr */
+	0xdee3b32c,	/* xaddb_rr */
+	0x784d59a0,	/* xaddw_rm */
+	0x4f264abb,	/* xaddl_aa */
+	0xd8029e2a,	/* pushl_r */
+	0x96e0350c,	/* pushw_r */
+	0xf6985951,	/* pushl_esp */
+	0xddb94a0f,	/* pushl_si */
+	0x6c80d668,	/* pushl_i */
+	0x312e18cf,	/* pushl_m */
+	0x82dfbc20,	/* popl_r */
+	0x453d4042,	/* popw_r */
+	0xb8d36bf0,	/* popl_m */
+	0x99575b96,	/* popl_esp_m */
+	0x9da1f114,	/* pushal */
+	0xafdcae53,	/* popal */
+	0x17fe889f,	/* pushfl */
+	0xe1f25fc8,	/* popfl */
+	0xbf52ae10,	/* enter_0 */
+	0xd405d45d,	/* enter_2 */
+	0xa6bbca4c,	/* leave */
+	0x966e62d7,	/* lahf */
+	0xf3295407,	/* sahf */
+	0xddd31a89,	/* clc */
+	0x6b6a3160,	/* stc */
+	0x841af0c3,	/* cmc */
+	0x90af8e20,	/* cld */
+	0xd3e2d558,	/* std */
+	0x55940b6a,	/* movsb */
+	0x37a82052,	/* movsl */
+	0x750ab086,	/* cmpsb */
+	0x5e1e43e9,	/* cmpsw */
+	0xe59dcc47,	/* scasl */
+	0x4f7650e8,	/* lodsb */
+	0xb1c087ef,	/* stosl */
+	0x783e9089,	/* rep_movsl */
+	0xc20db4d6,	/* rep_movsb */
+	0xb6ed64d9,	/* rep_stosb */
+	0x625b431d,	/* rep_stosw */
+	0x2cee7abd,	/* repz_cmpsb */
+	0xf8bc5c13,	/* repnz_scasb */
+	0x2ca1ecb5,	/* rep_lodsl */
+	0xb383d2ce,	/* daa */
+	0xccd11b4f,	/* das */
+	0x99aab26d,	/* aaa */
+	0x1fa1c740,	/* aas */
+	0xb1e133f7,	/* aam */
+	0x2da0c237,	/* aam_7 */
+	0xc8d3273e,	/* aad */
+	0xfffce23a,	/* aad_7 */
+	0x8afed73d,	/* ds_movl */
+	0x6bcc2a98,	/* es_addl */
+	0xaacc070a,	/* ss_movl */
+	0x21981740,	/* lock_addl */
+	0x108e13e5,	/* lock_btsl */
+	0xcbf6bafb,	/* faddl_m */
+	0xe3a1b607,	/* fsubl_m */
+	0x45b69c78,	/* fmull_m */
+	0x30d77e03,	/* fdivrl_m */
+	0x3472c3c5,	/* fdivs_m */
+	0x69ae4b3b,	/* fsubrs_m */
+	0x3bbe0c60,	/* fstps_round */
+	0x52c9830e,	/* fldt_fstpt */
+	0x15289b37,	/* fiaddl_m */
+	0xe124fe8f,	/* fidivl_m */
+	0xbd22b32a,	/* fidivrs_m */
+	0x2127c1db,	/* fimull_m */
+	0x19787c95,	/* fildll */
+	0x76184e54,	/* fistpl_big */
+	0x7fde95e0,	/* fisttpl */
+	0xb5838399,	/* fldcw_rc */
+	0xed086b8a,	/* fldcw_pc */
+	0x76dca2dc,	/* fnstcw */
+	0xbc7411a1,	/* fadd_st */
+	0x18d806ef,	/* fsubp_st */
+	0x4ddc06e6,	/* fdivp_st */
+	0x7548e797,	/* fsub_sti */
+	0xeada80b7,	/* fxch */
+	0x79a56442,	/* fst_st */
+	0xe12c291c,	/* fcoml */
+	0xc9396e16,	/* fcompl_same */
+	0x4062927c,	/* ficoms */
+	0xcad0039e,	/* fcompp */
+	0x14bd43a6,	/* fucompp */
+	0x9d918f9c,	/* fucom */
+	0xa22086db,	/* fcomip */
+	0xf8ea43a5,	/* fucomi */
+	0xaee14ec6,	/* fcmovb */
+	0x18f973ce,	/* fcmovnbe */
+	0x39790604,	/* ftst */
+	0x890c66da,	/* fxam */
+	0x9f2f1475,	/* fchs_fabs */
+	0x88b60829,	/* fsqrt */
+	0x49c5c7bc,	/* frndint */
+	0x239c01f8,	/* fprem */
+	0x580e7ddd,	/* fprem1 */
+	0x619aee90,	/* fscale */
+	0xbdd31837,	/* fxtract */
+	0x922b9e38,	/* fld_const */
+	0x1d73ed82,	/* fbstp_fbld */
+	0x03160063,	/* fstack_under */
+	0xa684ff09,	/* fstack_over */
+	0xeed16fff,	/* ffree_fincstp */
+	0x15c27f92,	/* fnclex */
+};
@@ -0,0 +1,577 @@
+#ifndef __CONFORMANCE_H__
+#define __CONFORMANCE_H__
+
+/* The instruction conformance suite. Every form below is one instruction,
+ * or a few, run from a random machine state in which a window of memory
+ * `conf_mem' is addressable through EBX, ESI, EDI, EBP and ESP. The
+ * registers, the defined flags and the window after the run are hashed.
+ * testcase/conformance/gen.c runs the forms on the host processor and
+ * writes the hashes to conformance-ref.h, which testcase/src/conformance.c
+ * checks NEMU against.
+ *
+ * Include this file in one source file of a program only.
+ */
+
+#include <stdint.h>
+
+#define CONF_CAT_TEMP(x, y) x ## y
+#define CONF_CAT(x, y) CONF_CAT_TEMP(x, y)
+
+/* the flags an instruction leaves undefined */
+#define U_CF 0x001
+#define U_PF 0x004
+#define U_AF 0x010
+#define U_ZF 0x040
+#define U_SF 0x080
+#define U_OF 0x800
+#define U_ALL (U_CF | U_PF | U_AF | U_ZF | U_SF | U_OF)
+#define U_LOGIC U_AF
+#define U_MUL (U_SF | U_ZF | U_AF | U_PF)
+#define U_BT (U_OF | U_SF | U_AF | U_PF)
+#define U_BSF (U_CF | U_OF | U_SF | U_AF | U_PF)
+
+/* the flags which are compared: CF, PF, AF, ZF, SF, DF and OF */
+#define CONF_FLAGS 0xcd5
+
+/* fixups of the random state, to keep the forms from faulting */
+#define F_MEM	0x001	/* EBX points to the middle of the window */
+#define F_STR	0x002	/* ESI and EDI point into the window, ECX is below 8 */
+#define F_FRAME	0x004	/* EBP points to a stack frame in the window */
+#define F_DIV	0x008	/* (E)DX:(E)AX, DX:AX or AX divided by (E)CX or CL fits */
+#define F_IDIV	0x010	/* the same for signed division */
+#define F_BT	0x020	/* ECX is a bit offset from -128 to 127 */
+#define F_CNT16	0x040	/* CL is a count below 16 */
+#define F_POPF	0x080	/* the word on the stack is a flag image without TF and IF */
+#define F_XLAT	0x100	/* EBX points to the start of the window */
+#define F_EQ	0x200	/* in every other case, EAX is the destination of cmpxchg */
+#define F_EQM	0x400	/* the same, with the destination 4(%ebx) */
+#define F_SMALL	0x800	/* ECX is below 4 */
+
+/* The size of the operand of div and idiv, or of a shift or rotate. */
+#define W8 1
+#define W16 2
+#define W32 4
+
+/* kinds of shifts and rotates, whose undefined flags depend on the count */
+enum { K_NONE, K_SHIFT, K_ROT };
+
+/* the count of a shift which is taken from CL */
+#define CL 0xff
+
+/* FORM(name, instructions, fixups, undefined flags, operand size)
+ * SHIFT(name, instructions, fixups, kind, count, operand size)
+ */
+
+#define ALU_FORMS(F, op, U) \
+	F(op##b_rr, #op "b %dl,%al", 0, U, 0) \
+	F(op##w_rr, #op "w %dx,%cx", 0, U, 0) \
+	F(op##l_rr, #op "l %edx,%eax", 0, U, 0) \
+	F(op##l_rr2, ".byte 0x" op##_RM2R ",0xc2", 0, U, 0) \
+	F(op##b_rm, #op "b %cl,5(%ebx)", F_MEM, U, 0) \
+	F(op##w_rm, #op "w %cx,-6(%ebx)", F_MEM, U, 0) \
+	F(op##l_rm, #op "l %ecx,4(%ebx)", F_MEM, U, 0) \
+	F(op##b_mr, #op "b 3(%ebx),%ah", F_MEM, U, 0) \
+	F(op##l_mr, #op "l -8(%ebx),%esi", F_MEM, U, 0) \
+	F(op##b_ia, #op "b $0x85,%al", 0, U, 0) \
+	F(op##w_ia, #op "w $0x8001,%ax", 0, U, 0) \
+	F(op##l_ia, #op "l $0x80000001,%eax", 0, U, 0) \
+	F(op##b_ir, #op "b $0x7f,%ch", 0, U, 0) \
+	F(op##l_ir, #op "l $0x12345678,%edx", 0, U, 0) \
+	F(op##w_sr, #op "w $-2,%di", 0, U, 0) \
+	F(op##l_sr, #op "l $0x7f,%esi", 0, U, 0) \
+	F(op##l_sm, #op "l $-128,12(%ebx)", F_MEM, U, 0)
+
+/* the opcodes of the rm2r forms, which gas does not pick for registers */
+#define add_RM2R "03"
+#define or_RM2R "0b"
+#define adc_RM2R "13"
+#define sbb_RM2R "1b"
+#define and_RM2R "23"
+#define sub_RM2R "2b"
+#define xor_RM2R "33"
+#define cmp_RM2R "3b"
+
+#define SHIFT_FORMS(S, op, K) \
+	S(op##b_1, #op "b %al", 0, K, 1, W8) \
+	S(op##w_1, #op "w %dx", 0, K, 1, W16) \
+	S(op##l_1, #op "l %ecx", 0, K, 1, W32) \
+	S(op##l_1m, #op "l 4(%ebx)", F_MEM, K, 1, W32) \
+	S(op##b_cl, #op "b %cl,%dh", 0, K, CL, W8) \
+	S(op##w_cl, #op "w %cl,%ax", 0, K, CL, W16) \
+	S(op##l_cl, #op "l %cl,%edx", 0, K, CL, W32) \
+	S(op##b_3, #op "b $3,%bl", 0, K, 3, W8) \
+	S(op##w_7, #op "w $7,%si", 0, K, 7, W16) \
+	S(op##l_13, #op "l $13,%eax", 0, K, 13, W32) \
+	S(op##l_0, #op "l $0,%eax", 0, K, 0, W32) \
+	S(op##b_9, #op "b $9,%dl", 0, K, 9, W8) \
+	S(op##w_17, #op "w $17,%dx", 0, K, 17, W16) \
+	S(op##l_33, #op "l $33,%edx", 0, K, 33, W32)
+
+#define CC_FORMS(F, cc, n) \
+	F(set##cc, "set" #cc " %al", 0, 0, 0) \
+	F(cmov##cc, "cmov" #cc "l %edx,%eax", 0, 0, 0) \
+	F(j##cc, "movl $0,%esi\n\tj" #cc " 1f\n\tincl %esi\n1:", 0, 0, 0) \
+	F(j##cc##_v, "movl $0,%esi\n\t.byte 0x0f,0x8" #n "\n\t.long 1\n\tincl %esi", 0, 0, 0)
+
+/* The status word after an x87 form, without C1, which tells whether
+ * the result was rounded up, and which NEMU leaves clear.
+ */
+#define FSW "\n\tfnstsw %ax\n\tandw $0xfdff,%ax"
+
+/* The window holds doubles from random bits, and the integers 4(%ebx)
+ * and 8(%ebx). Every form starts from an initialized FPU.
+ */
+#define X87_FORMS(F) \
+	F(faddl_m, "fldl -16(%ebx)\n\tfaddl 8(%ebx)\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fsubl_m, "fldl -16(%ebx)\n\tfsubl 8(%ebx)\n\tfstpt (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fmull_m, "fldl -16(%ebx)\n\tfmull 8(%ebx)\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fdivrl_m, "fldl -16(%ebx)\n\tfdivrl 8(%ebx)\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fdivs_m, "flds -12(%ebx)\n\tfdivs 8(%ebx)\n\tfstps (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fsubrs_m, "flds -12(%ebx)\n\tfsubrs 8(%ebx)\n\tfsts (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fstps_round, "fldl -16(%ebx)\n\tfstps (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fldt_fstpt, "fldt -16(%ebx)\n\tfld %st\n\tfmul %st(1),%st\n\tfstpt (%ebx)\n\tfstpt 16(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fiaddl_m, "fildl 4(%ebx)\n\tfiaddl 8(%ebx)\n\tfistpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fidivl_m, "fildl 4(%ebx)\n\tfidivl 8(%ebx)\n\tfistl (%ebx)\n\tfistps -4(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fidivrs_m, "fildl 4(%ebx)\n\tfidivrs 8(%ebx)\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fimull_m, "fildl 4(%ebx)\n\tfimull 8(%ebx)\n\tfistpll (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fildll, "fildll 4(%ebx)\n\tfld1\n\tfaddp\n\tfistpll -8(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fistpl_big, "fldl -16(%ebx)\n\tfistpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fisttpl, "fildl 4(%ebx)\n\tfidivl 8(%ebx)\n\tfisttpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fldcw_rc, "movw $0x0b7f,(%ebx)\n\tfldcw (%ebx)\n\tfildl 4(%ebx)\n\tfidivl 8(%ebx)\n\tfistpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fldcw_pc, "movw $0x007f,(%ebx)\n\tfldcw (%ebx)\n\tfldl -16(%ebx)\n\tfdivl 8(%ebx)\n\tfstpt (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fnstcw, "movw $0xfe3f,(%ebx)\n\tfldcw (%ebx)\n\tfnstcw 4(%ebx)", F_MEM, 0, 0) \
+	F(fadd_st, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfadd %st(1),%st\n\tfstpl (%ebx)\n\tfstpl 16(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fsubp_st, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfsubrp\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fdivp_st, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfdivp %st,%st(1)\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fsub_sti, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfsub %st,%st(1)\n\tfstpl (%ebx)\n\tfstpl 16(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fxch, "fldl -16(%ebx)\n\tfldz\n\tfxch\n\tfstpl (%ebx)\n\tfstpl 16(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fst_st, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfst %st(1)\n\tfmulp\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fcoml, "fldl -16(%ebx)\n\tfcoml 8(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fcompl_same, "fldl 8(%ebx)\n\tfcompl 8(%ebx)" FSW, F_MEM, 0, 0) \
+	F(ficoms, "fildl 4(%ebx)\n\tficoms 8(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fcompp, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfcompp" FSW, F_MEM, 0, 0) \
+	F(fucompp, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfucompp" FSW, F_MEM, 0, 0) \
+	F(fucom, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfucomp %st(1)" FSW, F_MEM, 0, 0) \
+	F(fcomip, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfcomip %st(1),%st" FSW, F_MEM, 0, 0) \
+	F(fucomi, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfucomi %st(1),%st" FSW, F_MEM, 0, 0) \
+	F(fcmovb, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfcmovb %st(1),%st\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fcmovnbe, "fldl -16(%ebx)\n\tfldl 8(%ebx)\n\tfcmovnbe %st(1),%st\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(ftst, "fldl -16(%ebx)\n\tftst" FSW, F_MEM, 0, 0) \
+	F(fxam, "fldl -16(%ebx)\n\tfxam\n\tfnstsw %ax", F_MEM, 0, 0) \
+	F(fchs_fabs, "fldl -16(%ebx)\n\tfchs\n\tfstpl (%ebx)\n\tfldl 8(%ebx)\n\tfabs\n\tfstpl 16(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fsqrt, "fldl -16(%ebx)\n\tfsqrt\n\tfstpt (%ebx)" FSW, F_MEM, 0, 0) \
+	F(frndint, "fldl -16(%ebx)\n\tfrndint\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fprem, "orl $1,8(%ebx)\n\tfildl 8(%ebx)\n\tfildl 4(%ebx)\n\tfprem\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fprem1, "orl $1,8(%ebx)\n\tfildl 8(%ebx)\n\tfildl 4(%ebx)\n\tfprem1\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fscale, "fildl 4(%ebx)\n\tfldl -16(%ebx)\n\tfscale\n\tfstpt (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fxtract, "fldl -16(%ebx)\n\tfxtract\n\tfstpt (%ebx)\n\tfstpt 16(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fld_const, "fldpi\n\tfstpt (%ebx)\n\tfldl2e\n\tfstpt 16(%ebx)\n\tfldln2\n\tfstpt -16(%ebx)\n\tfldl2t\n\tfldlg2\n\tfstpt 32(%ebx)\n\tfstpt -32(%ebx)" FSW, F_MEM, 0, 0) \
+	F(fbstp_fbld, "fildl 4(%ebx)\n\tfbstp 8(%ebx)\n\tfbld 8(%ebx)\n\tfistpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fstack_under, "fld %st(3)\n\tfstpl (%ebx)\n\tfadd %st(2),%st" FSW, F_MEM, 0, 0) \
+	F(fstack_over, "fld1\n\tfld1\n\tfld1\n\tfld1\n\tfld1\n\tfld1\n\tfld1\n\tfld1\n\tfldz\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(ffree_fincstp, "fldz\n\tfld1\n\tffree %st(1)\n\tfincstp\n\tfldl -16(%ebx)\n\tfstpl (%ebx)" FSW, F_MEM, 0, 0) \
+	F(fnclex, "fldz\n\tfld1\n\tfdivp\n\tfnstsw 4(%ebx)\n\tfnclex" FSW, F_MEM, 0, 0)
+
+#define CONF_FORMS(F, S) \
+	ALU_FORMS(F, add, 0) \
+	ALU_FORMS(F, or, U_LOGIC) \
+	ALU_FORMS(F, adc, 0) \
+	ALU_FORMS(F, sbb, 0) \
+	ALU_FORMS(F, and, U_LOGIC) \
+	ALU_FORMS(F, sub, 0) \
+	ALU_FORMS(F, xor, U_LOGIC) \
+	ALU_FORMS(F, cmp, 0) \
+	F(addb_82, ".byte 0x82,0xc1,0x7f", 0, 0, 0) \
+	F(sbbb_82, ".byte 0x82,0xda,0x80", 0, 0, 0) \
+	F(testb_rr, "testb %dl,%al", 0, U_LOGIC, 0) \
+	F(testl_rm, "testl %ecx,4(%ebx)", F_MEM, U_LOGIC, 0) \
+	F(testb_ia, "testb $0x81,%al", 0, U_LOGIC, 0) \
+	F(testl_ia, "testl $0x80000001,%eax", 0, U_LOGIC, 0) \
+	F(testw_ir, "testw $0x8000,%cx", 0, U_LOGIC, 0) \
+	F(testb_f6_1, ".byte 0xf6,0xca,0x0f", 0, U_LOGIC, 0) \
+	F(incb, "incb %ah", 0, 0, 0) \
+	F(incw, "incw %ax", 0, 0, 0) \
+	F(incl, "incl %ecx", 0, 0, 0) \
+	F(incl_r, "movl %eax,%esp\n\t.byte 0x44", 0, 0, 0) \
+	F(incl_m, "incl 4(%ebx)", F_MEM, 0, 0) \
+	F(decb_m, "decb 5(%ebx)", F_MEM, 0, 0) \
+	F(decw, "decw %si", 0, 0, 0) \
+	F(decl, "decl %edx", 0, 0, 0) \
+	F(decl_r, "movl %eax,%esp\n\t.byte 0x4c", 0, 0, 0) \
+	F(negb, "negb %cl", 0, 0, 0) \
+	F(negw, "negw %ax", 0, 0, 0) \
+	F(negl, "negl %edx", 0, 0, 0) \
+	F(negl_m, "negl 4(%ebx)", F_MEM, 0, 0) \
+	F(notb, "notb %cl", 0, 0, 0) \
+	F(notl_m, "notl 4(%ebx)", F_MEM, 0, 0) \
+	F(mulb, "mulb %cl", 0, U_MUL, 0) \
+	F(mulw, "mulw %cx", 0, U_MUL, 0) \
+	F(mull, "mull %ecx", 0, U_MUL, 0) \
+	F(mull_m, "mull 4(%ebx)", F_MEM, U_MUL, 0) \
+	F(imulb, "imulb %cl", 0, U_MUL, 0) \
+	F(imulw, "imulw %cx", 0, U_MUL, 0) \
+	F(imull, "imull %ecx", 0, U_MUL, 0) \
+	F(imulw_rr, "imulw %dx,%ax", 0, U_MUL, 0) \
+	F(imull_rr, "imull %edx,%eax", 0, U_MUL, 0) \
+	F(imull_mr, "imull 4(%ebx),%eax", F_MEM, U_MUL, 0) \
+	F(imull_si, "imull $-100,%ecx,%eax", 0, U_MUL, 0) \
+	F(imull_i, "imull $0x12345,%ecx,%eax", 0, U_MUL, 0) \
+	F(imulw_si, "imulw $-5,%cx,%ax", 0, U_MUL, 0) \
+	F(divb, "divb %cl", F_DIV, U_ALL, W8) \
+	F(divw, "divw %cx", F_DIV, U_ALL, W16) \
+	F(divl, "divl %ecx", F_DIV, U_ALL, W32) \
+	F(idivb, "idivb %cl", F_IDIV, U_ALL, W8) \
+	F(idivw, "idivw %cx", F_IDIV, U_ALL, W16) \
+	F(idivl, "idivl %ecx", F_IDIV, U_ALL, W32) \
+	SHIFT_FORMS(S, shl, K_SHIFT) \
+	SHIFT_FORMS(S, shr, K_SHIFT) \
+	SHIFT_FORMS(S, sar, K_SHIFT) \
+	SHIFT_FORMS(S, rol, K_ROT) \
+	SHIFT_FORMS(S, ror, K_ROT) \
+	SHIFT_FORMS(S, rcl, K_ROT) \
+	SHIFT_FORMS(S, rcr, K_ROT) \
+	S(sall_d1_6, ".byte 0xd1,0xf0", 0, K_SHIFT, 1, W32) \
+	S(shldl_i, "shldl $5,%edx,%eax", 0, K_SHIFT, 5, W32) \
+	S(shldl_1, "shldl $1,%edx,%eax", 0, K_SHIFT, 1, W32) \
+	S(shldl_0, "shldl $0,%edx,%eax", 0, K_SHIFT, 0, W32) \
+	S(shldl_cl, "shldl %cl,%edx,%eax", 0, K_SHIFT, CL, W32) \
+	S(shldw_i, "shldw $11,%dx,%ax", 0, K_SHIFT, 11, W16) \
+	S(shrdl_i, "shrdl $7,%edx,%eax", 0, K_SHIFT, 7, W32) \
+	S(shrdl_1, "shrdl $1,%edx,%eax", 0, K_SHIFT, 1, W32) \
+	S(shrdl_cl, "shrdl %cl,%edx,%eax", 0, K_SHIFT, CL, W32) \
+	S(shrdl_m, "shrdl %cl,%edx,4(%ebx)", F_MEM, K_SHIFT, CL, W32) \
+	S(shrdw_i, "shrdw $3,%dx,%ax", 0, K_SHIFT, 3, W16) \
+	S(shldw_cl, "shldw %cl,%dx,%ax", F_CNT16, K_SHIFT, CL, W16) \
+	S(shrdw_cl, "shrdw %cl,%dx,%ax", F_CNT16, K_SHIFT, CL, W16) \
+	F(btl_rr, "btl %ecx,%edx", 0, U_BT, 0) \
+	F(btw_rr, "btw %cx,%dx", 0, U_BT, 0) \
+	F(btl_rm, "btl %ecx,(%ebx)", F_MEM | F_BT, U_BT, 0) \
+	F(btsl_rr, "btsl %ecx,%edx", 0, U_BT, 0) \
+	F(btsl_rm, "btsl %ecx,(%ebx)", F_MEM | F_BT, U_BT, 0) \
+	F(btrl_rr, "btrl %ecx,%eax", 0, U_BT, 0) \
+	F(btrw_rm, "btrw %cx,(%ebx)", F_MEM | F_BT, U_BT, 0) \
+	F(btcl_rr, "btcl %ecx,%esi", 0, U_BT, 0) \
+	F(btcl_rm, "btcl %ecx,(%ebx)", F_MEM | F_BT, U_BT, 0) \
+	F(btl_i, "btl $35,%edx", 0, U_BT, 0) \
+	F(btsl_im, "btsl $7,4(%ebx)", F_MEM, U_BT, 0) \
+	F(btrw_i, "btrw $3,%ax", 0, U_BT, 0) \
+	F(btcl_i, "btcl $31,%eax", 0, U_BT, 0) \
+	F(bsfl, "bsfl %edx,%eax", 0, U_BSF, 0) \
+	F(bsfw, "bsfw %dx,%ax", 0, U_BSF, 0) \
+	F(bsrl, "bsrl %edx,%eax", 0, U_BSF, 0) \
+	F(bsrl_m, "bsrl 4(%ebx),%eax", F_MEM, U_BSF, 0) \
+	F(bsrw_0, "xorw %dx,%dx\n\tbsrw %dx,%ax", 0, U_BSF, 0) \
+	CC_FORMS(F, o, 0) \
+	CC_FORMS(F, no, 1) \
+	CC_FORMS(F, b, 2) \
+	CC_FORMS(F, ae, 3) \
+	CC_FORMS(F, e, 4) \
+	CC_FORMS(F, ne, 5) \
+	CC_FORMS(F, be, 6) \
+	CC_FORMS(F, a, 7) \
+	CC_FORMS(F, s, 8) \
+	CC_FORMS(F, ns, 9) \
+	CC_FORMS(F, p, a) \
+	CC_FORMS(F, np, b) \
+	CC_FORMS(F, l, c) \
+	CC_FORMS(F, ge, d) \
+	CC_FORMS(F, le, e) \
+	CC_FORMS(F, g, f) \
+	F(setne_m, "setne 3(%ebx)", F_MEM, 0, 0) \
+	F(cmovlw, "cmovlw %dx,%ax", 0, 0, 0) \
+	F(cmovgl_m, "cmovgl 4(%ebx),%eax", F_MEM, 0, 0) \
+	F(loop, "movl $0,%esi\n\tloop 1f\n\tincl %esi\n1:", F_SMALL, 0, 0) \
+	F(loope, "movl $0,%esi\n\tloope 1f\n\tincl %esi\n1:", F_SMALL, 0, 0) \
+	F(loopne, "movl $0,%esi\n\tloopne 1f\n\tincl %esi\n1:", F_SMALL, 0, 0) \
+	F(jecxz, "movl $0,%esi\n\tjecxz 1f\n\tincl %esi\n1:", F_SMALL, 0, 0) \
+	F(movsbl, "movsbl %dl,%eax", 0, 0, 0) \
+	F(movsbw, "movsbw %ch,%ax", 0, 0, 0) \
+	F(movzbl_m, "movzbl 3(%ebx),%eax", F_MEM, 0, 0) \
+	F(movswl, "movswl %dx,%eax", 0, 0, 0) \
+	F(movzwl, "movzwl %dx,%eax", 0, 0, 0) \
+	F(cbtw, "cbtw", 0, 0, 0) \
+	F(cwtl, "cwtl", 0, 0, 0) \
+	F(cwtd, "cwtd", 0, 0, 0) \
+	F(cltd, "cltd", 0, 0, 0) \
+	F(xchgl_a, "xchgl %eax,%ecx", 0, 0, 0) \
+	F(xchgw_a, "xchgw %ax,%di", 0, 0, 0) \
+	F(xchgb_rr, "xchgb %dl,%ah", 0, 0, 0) \
+	F(xchgl_rm, "xchgl %ecx,4(%ebx)", F_MEM, 0, 0) \
+	F(bswap, "bswap %edx", 0, 0, 0) \
+	F(xlat, "xlat", F_XLAT, 0, 0) \
+	F(leal_sib, "leal 0x10(%eax,%ecx,4),%edx", 0, 0, 0) \
+	F(leaw, "leaw -3(%ebx,%esi),%dx", 0, 0, 0) \
+	F(cmpxchgl_rr, "cmpxchgl %ecx,%edx", F_EQ, 0, 0) \
+	F(cmpxchgb_rr, "cmpxchgb %cl,%dl", F_EQ, 0, 0) \
+	F(cmpxchgw_rr, "cmpxchgw %cx,%dx", F_EQ, 0, 0) \
+	F(cmpxchgl_rm, "cmpxchgl %ecx,4(%ebx)", F_MEM | F_EQM, 0, 0) \
+	F(xaddl_rr, "xaddl %ecx,%edx", 0, 0, 0) \
+	F(xaddb_rr, "xaddb %cl,%dl", 0, 0, 0) \
+	F(xaddw_rm, "xaddw %cx,4(%ebx)", F_MEM, 0, 0) \
+	F(xaddl_aa, "xaddl %eax,%eax", 0, 0, 0) \
+	F(pushl_r, "pushl %eax", 0, 0, 0) \
+	F(pushw_r, "pushw %dx", 0, 0, 0) \
+	F(pushl_esp, "pushl %esp", 0, 0, 0) \
+	F(pushl_si, "pushl $-5", 0, 0, 0) \
+	F(pushl_i, "pushl $0x12345678", 0, 0, 0) \
+	F(pushl_m, "pushl 4(%ebx)", F_MEM, 0, 0) \
+	F(popl_r, "popl %ecx", 0, 0, 0) \
+	F(popw_r, "popw %dx", 0, 0, 0) \
+	F(popl_m, "popl 4(%ebx)", F_MEM, 0, 0) \
+	F(popl_esp_m, "popl 4(%esp)", 0, 0, 0) \
+	F(pushal, "pushal", 0, 0, 0) \
+	F(popal, "popal", 0, 0, 0) \
+	F(pushfl, "pushfl\n\tandl $0xcd5,(%esp)", 0, 0, 0) \
+	F(popfl, "popfl", F_POPF, 0, 0) \
+	F(enter_0, "enter $8,$0", F_FRAME, 0, 0) \
+	F(enter_2, "enter $12,$2", F_FRAME, 0, 0) \
+	F(leave, "leave", F_FRAME, 0, 0) \
+	F(lahf, "lahf", 0, 0, 0) \
+	F(sahf, "sahf", 0, 0, 0) \
+	F(clc, "clc", 0, 0, 0) \
+	F(stc, "stc", 0, 0, 0) \
+	F(cmc, "cmc", 0, 0, 0) \
+	F(cld, "cld", 0, 0, 0) \
+	F(std, "std", 0, 0, 0) \
+	F(movsb, "movsb", F_STR, 0, 0) \
+	F(movsl, "movsl", F_STR, 0, 0) \
+	F(cmpsb, "cmpsb", F_STR, 0, 0) \
+	F(cmpsw, "cmpsw", F_STR, 0, 0) \
+	F(scasl, "scasl", F_STR, 0, 0) \
+	F(lodsb, "lodsb", F_STR, 0, 0) \
+	F(stosl, "stosl", F_STR, 0, 0) \
+	F(rep_movsl, "rep movsl", F_STR, 0, 0) \
+	F(rep_movsb, "rep movsb", F_STR, 0, 0) \
+	F(rep_stosb, "rep stosb", F_STR, 0, 0) \
+	F(rep_stosw, "rep stosw", F_STR, 0, 0) \
+	F(repz_cmpsb, "repz cmpsb", F_STR, 0, 0) \
+	F(repnz_scasb, "repnz scasb", F_STR, 0, 0) \
+	F(rep_lodsl, "rep lodsl", F_STR, 0, 0) \
+	F(daa, "daa", 0, U_OF, 0) \
+	F(das, "das", 0, U_OF, 0) \
+	F(aaa, "aaa", 0, U_OF | U_SF | U_ZF | U_PF, 0) \
+	F(aas, "aas", 0, U_OF | U_SF | U_ZF | U_PF, 0) \
+	F(aam, "aam", 0, U_OF | U_AF | U_CF, 0) \
+	F(aam_7, ".byte 0xd4,0x07", 0, U_OF | U_AF | U_CF, 0) \
+	F(aad, "aad", 0, U_OF | U_AF | U_CF, 0) \
+	F(aad_7, ".byte 0xd5,0x07", 0, U_OF | U_AF | U_CF, 0) \
+	F(ds_movl, "movl %ds:4(%ebx),%eax", F_MEM, 0, 0) \
+	F(es_addl, "addl %eax,%es:4(%ebx)", F_MEM, 0, 0) \
+	F(ss_movl, "movl %ss:-4(%ebx),%edx", F_MEM, 0, 0) \
+	F(lock_addl, "lock addl %eax,4(%ebx)", F_MEM, 0, 0) \
+	F(lock_btsl, "lock btsl %ecx,(%ebx)", F_MEM | F_BT, U_BT, 0) \
+	X87_FORMS(F)
+
+typedef struct {
+	const char *name;
+	void *code;
+	uint32_t fix, undef;
+	uint8_t kind, count, width;
+} Conf_form;
+
+/* the code of a form, which the runner jumps to */
+#define CONF_CODE(name, insn) \
+	asm(".text\n" "conf_" #name ":\n\t" insn "\n\tjmp conf_back\n");
+#define CONF_CODE_F(name, insn, fix, undef, width) CONF_CODE(name, insn)
+#define CONF_CODE_S(name, insn, fix, kind, count, width) CONF_CODE(name, insn)
+CONF_FORMS(CONF_CODE_F, CONF_CODE_S)
+
+#define CONF_DECL(name, ...) extern char CONF_CAT(conf_, name) [];
+CONF_FORMS(CONF_DECL, CONF_DECL)
+
+#define CONF_ENTRY_F(name, insn, fix, undef, width) \
+	{ #name, CONF_CAT(conf_, name), fix, undef, K_NONE, 0, width },
+#define CONF_ENTRY_S(name, insn, fix, kind, count, width) \
+	{ #name, CONF_CAT(conf_, name), fix, 0, kind, count, width },
+static const Conf_form conf_form[] = { CONF_FORMS(CONF_ENTRY_F, CONF_ENTRY_S) };
+
+#define NR_CONF_FORM (sizeof(conf_form) / sizeof(conf_form[0]))
+#define NR_CONF_CASE 16
+
+/* The machine state: EAX, ECX, EDX, EBX, ESP, EBP, ESI, EDI and EFLAGS. */
+enum { C_EAX, C_ECX, C_EDX, C_EBX, C_ESP, C_EBP, C_ESI, C_EDI, C_EFLAGS, NR_C };
+
+/* The window is at the same address in NEMU and on the host, where
+ * gen.c maps it, so that the pointers into it are hashed as they are.
+ */
+#define CONF_MEM_ADDR 0x00f00000
+#define CONF_MEM_WORDS 64
+
+uint32_t conf_in[NR_C], conf_out[NR_C];
+static uint32_t * const conf_mem = (uint32_t *)CONF_MEM_ADDR;
+void *conf_snippet;
+uint32_t conf_host_esp;
+
+/* Run `conf_snippet' from `conf_in' and leave the state in `conf_out'. */
+void conf_run();
+asm(
+".text\n"
+"conf_run:\n\t"
+	"pushal\n\t"
+	"movl %esp,conf_host_esp\n\t"
+	"pushl conf_in+32\n\t"
+	"popfl\n\t"
+	"movl conf_in+0,%eax\n\t"
+	"movl conf_in+4,%ecx\n\t"
+	"movl conf_in+8,%edx\n\t"
+	"movl conf_in+12,%ebx\n\t"
+	"movl conf_in+20,%ebp\n\t"
+	"movl conf_in+24,%esi\n\t"
+	"movl conf_in+28,%edi\n\t"
+	"movl conf_in+16,%esp\n\t"
+	"fninit\n\t"
+	"jmp *conf_snippet\n"
+"conf_back:\n\t"
+	"movl %eax,conf_out+0\n\t"
+	"movl %ecx,conf_out+4\n\t"
+	"movl %edx,conf_out+8\n\t"
+	"movl %ebx,conf_out+12\n\t"
+	"movl %esp,conf_out+16\n\t"
+	"movl %ebp,conf_out+20\n\t"
+	"movl %esi,conf_out+24\n\t"
+	"movl %edi,conf_out+28\n\t"
+	"movl conf_host_esp,%esp\n\t"
+	"pushfl\n\t"
+	"popl conf_out+32\n\t"
+	"cld\n\t"
+	"popal\n\t"
+	"ret\n"
+);
+
+static uint32_t conf_seed;
+
+static uint32_t conf_rand() {
+	conf_seed ^= conf_seed << 13;
+	conf_seed ^= conf_seed >> 17;
+	conf_seed ^= conf_seed << 5;
+	return conf_seed;
+}
+
+static const uint32_t conf_edge[] = {
+	0, 1, 2, 0x7f, 0x80, 0xff, 0x100, 0x7fff,
+	0x8000, 0xffff, 0x10000, 0x7fffffff, 0x80000000, 0x80000001, 0xfffffffe, 0xffffffff
+};
+
+/* a random value, or one at a boundary of the operand sizes */
+static uint32_t conf_value() {
+	uint32_t r = conf_rand();
+	return ((r & 0x3) == 0 ? conf_edge[(r >> 2) & 0xf] : conf_rand());
+}
+
+static inline uint32_t conf_addr(int word) {
+	return (uint32_t)(conf_mem + word);
+}
+
+static uint32_t conf_mask(uint32_t val, int width) {
+	return (width == W8 ? val & 0xff : width == W16 ? val & 0xffff : val);
+}
+
+/* Make the random dividend fit the quotient into the operand size. */
+static void conf_fix_div(int width, int sign) {
+	uint32_t *a = &conf_in[C_EAX], *d = &conf_in[C_EDX], *c = &conf_in[C_ECX];
+	uint32_t divisor = conf_mask(*c, width);
+	if(sign) {
+		int32_t s = (width == W8 ? (int8_t)divisor : width == W16 ? (int16_t)divisor : (int32_t)divisor);
+		if(s == 0 || s == -1) { *c = (*c & ~conf_mask(0xffffffff, width)) | 7; }
+		/* the high half is the sign of the low half */
+		if(width == W8) { *a = (*a & 0xffff00ff) | ((*a & 0x80) ? 0xff00 : 0); }
+		else if(width == W16) { *d = (*d & 0xffff0000) | ((*a & 0x8000) ? 0xffff : 0); }
+		else { *d = ((int32_t)*a < 0 ? 0xffffffff : 0); }
+	}
+	else {
+		if(divisor == 0) { *c |= 1; divisor = conf_mask(*c, width); }
+		if(width == W8) { *a = (*a & 0xffff00ff) | ((((*a >> 8) & 0xff) % divisor) << 8); }
+		else if(width == W16) { *d = (*d & 0xffff0000) | ((*d & 0xffff) % divisor); }
+		else { *d %= divisor; }
+	}
+}
+
+/* Set up the state of case `k' of form `f'. */
+static void conf_setup(int f, int k) {
+	const Conf_form *form = &conf_form[f];
+	int i;
+	conf_seed = f * 1000 + k + 1;
+	for(i = 0; i < NR_C; i ++) { conf_in[i] = conf_value(); }
+	for(i = 0; i < CONF_MEM_WORDS; i ++) { conf_mem[i] = conf_value(); }
+	conf_in[C_EFLAGS] = (conf_rand() & CONF_FLAGS) | 0x2;
+	conf_in[C_ESP] = conf_addr(48);
+
+	uint32_t fix = form->fix;
+	if(fix & F_MEM) { conf_in[C_EBX] = conf_addr(16); }
+	if(fix & F_STR) {
+		conf_in[C_ESI] = conf_addr(8);
+		conf_in[C_EDI] = conf_addr(32);
+		conf_in[C_ECX] &= 0x7;
+		/* repz cmps runs on over equal elements */
+		if(k & 1) { conf_mem[32] = conf_mem[8]; conf_mem[33] = conf_mem[9]; }
+		if(k & 2) { conf_mem[32] = conf_mem[8] = conf_in[C_EAX]; }
+	}
+	if(fix & F_FRAME) {
+		conf_in[C_EBP] = conf_addr(56);
+		conf_mem[56] = conf_addr(60);
+	}
+	if(fix & F_DIV) { conf_fix_div(form->width, 0); }
+	if(fix & F_IDIV) { conf_fix_div(form->width, 1); }
+	if(fix & F_BT) { conf_in[C_ECX] = (conf_in[C_ECX] & 0xff) - 0x80; }
+	if(fix & F_CNT16) { conf_in[C_ECX] &= 0xf; }
+	if(fix & F_POPF) { conf_mem[48] &= CONF_FLAGS; }
+	if(fix & F_XLAT) { conf_in[C_EBX] = conf_addr(0); }
+	if((fix & F_EQ) && (k & 1)) { conf_in[C_EAX] = conf_in[C_EDX]; }
+	if((fix & F_EQM) && (k & 1)) { conf_in[C_EAX] = conf_mem[17]; }
+	if(fix & F_SMALL) { conf_in[C_ECX] &= 0x3; }
+	if(form->kind != K_NONE && (k & 3) == 0) {
+		/* the flags of a count of 0 are those of the input */
+		conf_in[C_ECX] &= ~0x1f;
+	}
+
+	conf_snippet = form->code;
+}
+
+/* the flags which the form leaves undefined in the case just set up */
+static uint32_t conf_undef(const Conf_form *form) {
+	uint32_t undef = form->undef;
+	if(form->kind != K_NONE) {
+		uint32_t count = (form->count == CL ? conf_in[C_ECX] : form->count) & 0x1f;
+		if(count != 0) {
+			if(form->kind == K_SHIFT) {
+				undef |= U_AF;
+				if(count >= form->width * 8) { undef |= U_CF; }
+			}
+			if(count != 1) { undef |= U_OF; }
+		}
+	}
+	return undef;
+}
+
+static uint32_t conf_hash_word(uint32_t h, uint32_t val) {
+	int i;
+	for(i = 0; i < 4; i ++) {
+		h = (h ^ (val & 0xff)) * 16777619;
+		val >>= 8;
+	}
+	return h;
+}
+
+/* Run case `k' of form `f' and hash the state after it. */
+static uint32_t conf_case(int f, int k) {
+	conf_setup(f, k);
+	uint32_t undef = conf_undef(&conf_form[f]);
+	conf_run();
+
+	uint32_t h = 2166136261u;
+	int i;
+	for(i = 0; i < C_EFLAGS; i ++) { h = conf_hash_word(h, conf_out[i]); }
+	h = conf_hash_word(h, conf_out[C_EFLAGS] & CONF_FLAGS & ~undef);
+	for(i = 0; i < CONF_MEM_WORDS; i ++) { h = conf_hash_word(h, conf_mem[i]); }
+	return h;
+}
+
+/* the hash of all cases of form `f' */
+static uint32_t conf_form_hash(int f) {
+	uint32_t h = 0;
+	int k;
+	for(k = 0; k < NR_CONF_CASE; k ++) { h = conf_hash_word(h, conf_case(f, k)); }
+	return h;
+}
+
+#endif
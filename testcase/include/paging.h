@@ -0,0 +1,122 @@
+#ifndef __PAGING_H__
+#define __PAGING_H__
+
+/* Helpers for test cases which run with paging on. pg_enable() enters
+ * protected mode with flat segments and maps the first 128MB to
+ * themselves with 4MB pages, which the TLB keeps apart from the 4KB
+ * ones. The 4KB pages of the 4MB window at PG_WINDOW are mapped by
+ * `pg_table', which the test fills in as it likes. The program must run
+ * at the addresses it was linked at, that is without the kernel, or with
+ * a kernel built without IA32_PAGE.
+ *
+ * Include this file in one source file of a program only.
+ */
+
+#include <stdint.h>
+#include "x86-inc/cpu.h"
+#include "x86-inc/mmu.h"
+
+#define PG_WINDOW 0x40000000
+#define PG_IDENT_SIZE (128 << 20)
+
+/* the bits of an entry used by the tests */
+#define PG_P 0x001
+#define PG_W 0x002
+#define PG_PS 0x080
+#define PG_G 0x100
+
+#define PG_KERNEL_CODE SELECTOR_KERNEL(SEG_KERNEL_CODE)
+#define PG_KERNEL_DATA SELECTOR_KERNEL(SEG_KERNEL_DATA)
+
+static PDE pg_dir[NR_PDE] align_to_page;
+static PTE pg_table[NR_PTE] align_to_page;
+
+/* null, flat code and flat data */
+static uint64_t pg_gdt[NR_SEGMENTS] = { 0, 0x00cf9a000000ffffull, 0x00cf92000000ffffull };
+
+static inline uint32_t read_cr0() {
+	uint32_t val;
+	asm volatile("movl %%cr0, %0" : "=r"(val));
+	return val;
+}
+
+static inline void write_cr0(uint32_t cr0) {
+	asm volatile("movl %0, %%cr0" : : "r"(cr0));
+}
+
+static inline uint32_t read_cr2() {
+	uint32_t val;
+	asm volatile("movl %%cr2, %0" : "=r"(val));
+	return val;
+}
+
+static inline uint32_t read_cr3() {
+	uint32_t val;
+	asm volatile("movl %%cr3, %0" : "=r"(val));
+	return val;
+}
+
+static inline void write_cr3(uint32_t cr3) {
+	asm volatile("movl %0, %%cr3" : : "r"(cr3));
+}
+
+static inline uint32_t read_cr4() {
+	uint32_t val;
+	asm volatile("movl %%cr4, %0" : "=r"(val));
+	return val;
+}
+
+static inline void write_cr4(uint32_t cr4) {
+	asm volatile("movl %0, %%cr4" : : "r"(cr4));
+}
+
+static inline void invlpg(void *addr) {
+	asm volatile("invlpg (%0)" : : "r"(addr) : "memory");
+}
+
+/* the address of the 4KB page `n' of the window */
+static inline volatile uint32_t* pg_page(int n) {
+	return (volatile uint32_t *)(PG_WINDOW + (n << 12));
+}
+
+/* Map page `n' of the window to `frame', which must be 4KB aligned. */
+static inline void pg_map(int n, void *frame, uint32_t flags) {
+	pg_table[n].val = (uint32_t)frame | flags;
+}
+
+/* Turn on protected mode and paging, with the bits `cr4' set in CR4.
+ * The window starts out unmapped.
+ */
+static inline void pg_enable(uint32_t cr4) {
+	static volatile uint16_t gdt_desc[3];
+	gdt_desc[0] = sizeof(pg_gdt) - 1;
+	gdt_desc[1] = (uint32_t)pg_gdt;
+	gdt_desc[2] = (uint32_t)pg_gdt >> 16;
+
+	/* nothing may use a segment between setting PE and reloading it */
+	asm volatile("lgdt (%0);"
+			"movl %%cr0, %%eax; orl $0x1, %%eax; movl %%eax, %%cr0;"
+			"ljmp %1, $1f;"
+			"1: movw %2, %%ax; movw %%ax, %%ds; movw %%ax, %%es; movw %%ax, %%ss"
+			: : "r"(gdt_desc), "i"(PG_KERNEL_CODE), "i"(PG_KERNEL_DATA) : "eax", "memory");
+
+	int i;
+	for(i = 0; i < NR_PDE; i ++) { pg_dir[i].val = 0; }
+	for(i = 0; i < PG_IDENT_SIZE / PT_SIZE; i ++) {
+		pg_dir[i].val = (i * PT_SIZE) | PG_PS | PG_W | PG_P;
+	}
+	for(i = 0; i < NR_PTE; i ++) { pg_table[i].val = 0; }
+	pg_dir[PG_WINDOW / PT_SIZE].val = (uint32_t)pg_table | PG_W | PG_P;
+
+	CR4 c4;
+	c4.val = cr4;
+	c4.page_size_ext = 1;
+	write_cr4(c4.val);
+	write_cr3((uint32_t)pg_dir);
+	CR0 c0;
+	c0.val = read_cr0();
+	c0.paging = 1;
+	write_cr0(c0.val);
+}
+
+#endif
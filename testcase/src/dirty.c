@@ -0,0 +1,67 @@
+#include "trap.h"
+#include "x86-inc/mmu.h"
+
+/* Write pages in two phases and check all of them at the end. On its
+ * own this is an ordinary test. test-ckpt.sh stops NEMU at the end of
+ * each phase to save an incremental checkpoint, then runs the checks
+ * in a new NEMU started from the second checkpoint. A page which the
+ * second phase wrote but the dirty-page tracking missed still holds
+ * what the first checkpoint saved.
+ */
+
+#define NR_PAGE 48
+#define NR_WORD (PAGE_SIZE / 4)
+
+static uint32_t buf[NR_PAGE][NR_WORD] align_to_page;
+
+static uint32_t value(int phase, int page, int k) {
+	return (phase << 28) ^ (page << 12) ^ (k * 0x9e3779b1);
+}
+
+/* The second phase writes every word of pages 0, 3, 6, ..., some with
+ * rep stos, and the last byte only of pages 1, 4, 7, ...
+ */
+static uint32_t expect(int page, int k) {
+	switch(page % 6) {
+		case 0: return value(2, page, k);
+		case 3: return value(2, page, 0);
+		case 1: case 4:
+			return (k == NR_WORD - 1 ? (value(1, page, k) & 0x00ffffff) | 0x5a000000 : value(1, page, k));
+		default: return value(1, page, k);
+	}
+}
+
+/* test-ckpt.sh stops NEMU when these are entered */
+void __attribute__((noinline)) phase1_done(void) { asm volatile(""); }
+void __attribute__((noinline)) phase2_done(void) { asm volatile(""); }
+
+int main() {
+	int i, k;
+	for(i = 0; i < NR_PAGE; i ++) {
+		for(k = 0; k < NR_WORD; k ++) { buf[i][k] = value(1, i, k); }
+	}
+	phase1_done();
+
+	for(i = 0; i < NR_PAGE; i ++) {
+		switch(i % 6) {
+			case 0:
+				for(k = 0; k < NR_WORD; k ++) { buf[i][k] = value(2, i, k); }
+				break;
+			case 3: {
+				uint32_t *dst = buf[i];
+				uint32_t n = NR_WORD;
+				asm volatile("cld; rep stosl" : "+D"(dst), "+c"(n) : "a"(value(2, i, 0)) : "memory");
+				break;
+			}
+			case 1: case 4:
+				((volatile uint8_t *)buf[i])[PAGE_SIZE - 1] = 0x5a;
+				break;
+		}
+	}
+	phase2_done();
+
+	for(i = 0; i < NR_PAGE; i ++) {
+		for(k = 0; k < NR_WORD; k ++) { nemu_assert(buf[i][k] == expect(i, k)); }
+	}
+	return 0;
+}
@@ -0,0 +1,33 @@
+#include "trap.h"
+
+/* integral.c with the x87 instead of FLOAT */
+
+double f(double x) { 
+	/* f(x) = 1/(1+25x^2) */
+	return 1 / (1 + 25 * x * x);
+}
+
+double computeT(int n, double a, double b, double (*fun)(double)) {
+	int k;
+	double s,h;
+	h = (b - a) / n;
+	s = (fun(a) + fun(b)) / 2;
+	for(k = 1; k < n; k ++) {
+		s += fun(a + h * k);
+	}
+	s = s * h;
+	return s;
+}
+
+int main() { 
+	double a = computeT(10, -1.0, 1.0, f);
+	double ans = 0.551222;
+
+	nemu_assert(a - ans < 1e-4 && ans - a < 1e-4);
+
+	/* the trapezoid rule converges on the exact value, 2/5 arctan(5) */
+	a = computeT(10000, -1.0, 1.0, f);
+	nemu_assert((int)(a * 1e6) == 549360);
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#include "trap.h"
+
+/* A locked read-modify-write with an immediate, in a loop which is hot
+ * enough for the block engine and the JIT to pick it up.
+ */
+int a[4];
+
+int main() {
+	int i;
+	for(i = 0; i < 1000; i ++) {
+		asm volatile ("lock subl $3, 0x8(%0)" : : "r"(a) : "memory", "cc");
+		asm volatile ("lock addl $1, 0x4(%0)" : : "r"(a) : "memory", "cc");
+		asm volatile ("lock incl 0xc(%0)" : : "r"(a) : "memory", "cc");
+	}
+
+	nemu_assert(a[2] == -3000);
+	nemu_assert(a[1] == 1000);
+	nemu_assert(a[3] == 1000);
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include "trap.h"
+#include "paging.h"
+
+/* Random 1, 2 and 4-byte reads and writes, biased towards the ends of
+ * cache lines and pages, checked against a shadow copy kept with byte
+ * accesses. The first round addresses `buf' as it is. The second one
+ * goes through the window, whose pages map to the frames of `buf' in a
+ * shuffled order, so an access which crosses a page goes to two frames
+ * which are not next to each other. Run it with `--mem=cache' as well
+ * to check the cache model.
+ */
+
+#define NR_PAGE 16
+#define BUF_SIZE (NR_PAGE * PAGE_SIZE)
+#define NR_ACCESS 20000
+#define LINE_SIZE 64
+
+static uint8_t buf[BUF_SIZE] align_to_page;
+static uint8_t shadow[BUF_SIZE];
+static int frame_of[NR_PAGE];
+
+static uint32_t seed = 0x2545f491;
+
+static uint32_t rand32(void) {
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* an offset at which `len' bytes fit into the buffer */
+static uint32_t rand_offset(int len) {
+	uint32_t r = rand32();
+	uint32_t off;
+	switch(r & 3) {
+		case 0: off = (r >> 8) % NR_PAGE * PAGE_SIZE + PAGE_SIZE - 1 - (r >> 2) % 4; break;
+		case 1: off = (r >> 8) % (BUF_SIZE / LINE_SIZE) * LINE_SIZE + LINE_SIZE - 1 - (r >> 2) % 4; break;
+		default: off = (r >> 8) % BUF_SIZE; break;
+	}
+	return (off > BUF_SIZE - len ? BUF_SIZE - len : off);
+}
+
+static uint32_t shadow_read(uint32_t off, int len) {
+	uint32_t val = 0;
+	int i;
+	for(i = len - 1; i >= 0; i --) {
+		val = (val << 8) | shadow[off + i];
+	}
+	return val;
+}
+
+static void shadow_write(uint32_t off, int len, uint32_t val) {
+	int i;
+	for(i = 0; i < len; i ++) {
+		shadow[off + i] = val >> (i * 8);
+	}
+}
+
+static uint32_t mem_read(uint8_t *p, int len) {
+	switch(len) {
+		case 1: return *(volatile uint8_t *)p;
+		case 2: return *(volatile uint16_t *)p;
+		default: return *(volatile uint32_t *)p;
+	}
+}
+
+static void mem_write(uint8_t *p, int len, uint32_t val) {
+	switch(len) {
+		case 1: *(volatile uint8_t *)p = val; break;
+		case 2: *(volatile uint16_t *)p = val; break;
+		default: *(volatile uint32_t *)p = val; break;
+	}
+}
+
+static void run(uint8_t *base) {
+	int i;
+	for(i = 0; i < NR_ACCESS; i ++) {
+		uint32_t r = rand32();
+		int len = 1 << (r % 3);
+		uint32_t off = rand_offset(len);
+		if(r & 0x100) {
+			uint32_t val = rand32();
+			mem_write(base + off, len, val);
+			shadow_write(off, len, val);
+		}
+		else {
+			nemu_assert(mem_read(base + off, len) == shadow_read(off, len));
+		}
+	}
+
+	for(i = 0; i < BUF_SIZE; i ++) {
+		nemu_assert(base[i] == shadow[i]);
+	}
+}
+
+int main() {
+	int i;
+	for(i = 0; i < BUF_SIZE; i ++) {
+		buf[i] = shadow[i] = i * 7;
+	}
+
+	run(buf);
+
+	pg_enable(0);
+	for(i = 0; i < NR_PAGE; i ++) { frame_of[i] = i; }
+	for(i = NR_PAGE - 1; i > 0; i --) {
+		int j = rand32() % (i + 1);
+		int t = frame_of[i];
+		frame_of[i] = frame_of[j];
+		frame_of[j] = t;
+	}
+
+	/* the frames hold the pages of the window in the shuffled order */
+	for(i = 0; i < NR_PAGE; i ++) {
+		int j;
+		for(j = 0; j < PAGE_SIZE; j ++) {
+			buf[frame_of[i] * PAGE_SIZE + j] = shadow[i * PAGE_SIZE + j];
+		}
+		pg_map(i, buf + frame_of[i] * PAGE_SIZE, PG_W | PG_P);
+	}
+
+	run((uint8_t *)pg_page(0));
+
+	/* and the writes went to the right frames */
+	for(i = 0; i < BUF_SIZE; i ++) {
+		nemu_assert(buf[frame_of[i / PAGE_SIZE] * PAGE_SIZE + i % PAGE_SIZE] == shadow[i]);
+	}
+	return 0;
+}
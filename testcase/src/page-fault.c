@@ -0,0 +1,216 @@
+#include "trap.h"
+#include "paging.h"
+
+/* The #PF handler maps the faulting page of the window, or makes it
+ * writable, and returns to the faulting instruction. That instruction
+ * must then run as if there had been no fault: it may not have moved
+ * ESP or written a register before its store faulted.
+ */
+
+#define NR_DEMAND 32
+/* the pages above 2 * NR_DEMAND are left to the other tests */
+#define NR_FRAME 80
+
+/* error code */
+#define PF_PROTECT 0x1
+#define PF_WRITE 0x2
+
+static uint32_t frames[NR_FRAME][NR_PTE] align_to_page;
+static uint32_t idt[2 * 256];
+
+int nr_fault;
+uint32_t error_of[NR_FRAME];
+
+/* The handler runs on a stack of its own, so that a test can put ESP
+ * just above a page which is not present.
+ */
+uint32_t pf_stack[1024];
+uint32_t pf_esp;
+
+void pf_entry(void);
+asm(".text\n"
+	"pf_entry:\n"
+	"	movl %esp, pf_esp\n"
+	"	movl $pf_stack + 4096, %esp\n"
+	"	pushal\n"
+	"	pushl pf_esp\n"
+	"	call pf_handler\n"
+	"	addl $4, %esp\n"
+	"	popal\n"
+	"	movl pf_esp, %esp\n"
+	"	addl $4, %esp\n"		/* the error code */
+	"	iret\n");
+
+/* `frame' points to the error code, which EIP, CS and EFLAGS follow */
+void pf_handler(uint32_t *frame) {
+	uint32_t addr = read_cr2();
+	int n = (addr - PG_WINDOW) >> 12;
+	nemu_assert(addr >= PG_WINDOW && n < NR_FRAME);
+	nr_fault ++;
+	error_of[n] = frame[0];
+	pg_map(n, frames[n], PG_W | PG_P);
+	invlpg((void *)pg_page(n));
+}
+
+static void set_pf_handler() {
+	uint32_t h = (uint32_t)pf_entry;
+	/* a present 32-bit interrupt gate */
+	idt[14 * 2] = (PG_KERNEL_CODE << 16) | (h & 0xffff);
+	idt[14 * 2 + 1] = (h & 0xffff0000) | 0x8e00;
+
+	static volatile uint16_t idt_desc[3];
+	idt_desc[0] = sizeof(idt) - 1;
+	idt_desc[1] = (uint32_t)idt;
+	idt_desc[2] = (uint32_t)idt >> 16;
+	asm volatile("lidt (%0)" : : "r"(idt_desc));
+}
+
+/* Touch a new page in each iteration, so that the faults come from the
+ * middle of a hot block.
+ */
+static void test_demand() {
+	int i;
+	for(i = 0; i < NR_DEMAND; i ++) {
+		*pg_page(i) = i * 3 + 1;
+	}
+	uint32_t sum = 0;
+	for(i = NR_DEMAND; i < 2 * NR_DEMAND; i ++) {
+		sum += *pg_page(i);
+	}
+
+	nemu_assert(nr_fault == 2 * NR_DEMAND);
+	nemu_assert(sum == 0);
+	/* NEMU reads the memory operand of a store when it decodes it, so
+	 * the stores fault as reads do
+	 */
+	for(i = 0; i < 2 * NR_DEMAND; i ++) {
+		nemu_assert(!(error_of[i] & PF_PROTECT));
+	}
+	for(i = 0; i < NR_DEMAND; i ++) {
+		nemu_assert(frames[i][0] == i * 3 + 1);
+	}
+}
+
+/* Page `n' maps to its frame read-only and holds `val' */
+static volatile uint32_t* read_only(int n, uint32_t val) {
+	frames[n][0] = val;
+	pg_map(n, frames[n], PG_P);
+	invlpg((void *)pg_page(n));
+	return pg_page(n);
+}
+
+/* xchg and xadd write the register after the memory */
+static void test_exchange() {
+	int nr = nr_fault;
+	volatile uint32_t *p = read_only(64, 7);
+	uint32_t r = 5;
+	asm volatile("xchgl %0, %1" : "+r"(r), "+m"(*p));
+	nemu_assert(r == 7 && *p == 5);
+
+	p = read_only(65, 7);
+	r = 5;
+	asm volatile("xaddl %0, %1" : "+r"(r), "+m"(*p));
+	nemu_assert(r == 7 && *p == 12);
+
+	nemu_assert(nr_fault == nr + 2);
+	nemu_assert(error_of[64] == (PF_PROTECT | PF_WRITE));
+	nemu_assert(error_of[65] == (PF_PROTECT | PF_WRITE));
+}
+
+/* pop to memory moves ESP after the store */
+static void test_pop() {
+	int nr = nr_fault;
+	volatile uint32_t *p = read_only(66, 0);
+	uint32_t esp_before, esp_after;
+	asm volatile("movl %%esp, %0; pushl $0x1234; popl %2; movl %%esp, %1"
+			: "=&r"(esp_before), "=&r"(esp_after), "=m"(*p));
+	nemu_assert(esp_after == esp_before && *p == 0x1234);
+	nemu_assert(nr_fault == nr + 1);
+}
+
+/* The stack switches go through memory, as EBP may be in use. */
+uint32_t saved_esp, new_esp, new_ebp, esp_after, ebp_after;
+
+/* Page `n' is not present and page `n + 1' is. Return the address `off'
+ * bytes above the start of page `n + 1'.
+ */
+static uint32_t stack_top(int n, int off) {
+	pg_map(n, frames[n], 0);
+	invlpg((void *)pg_page(n));
+	pg_map(n + 1, frames[n + 1], PG_W | PG_P);
+	invlpg((void *)pg_page(n + 1));
+	return (uint32_t)pg_page(n + 1) + off;
+}
+
+/* pusha and enter store more than the 16 bytes of the exception frame,
+ * which is all that fits above the page which is not present. They must
+ * move ESP only when all of it is stored.
+ */
+static void test_stack() {
+	int nr = nr_fault;
+	uint32_t top = stack_top(68, 16);
+	new_esp = top;
+	asm volatile("movl %%esp, saved_esp; movl new_esp, %%esp;"
+			"pushal;"
+			"movl %%esp, esp_after; movl saved_esp, %%esp"
+			: : "a"(0x12345678) : "memory");
+	nemu_assert(esp_after == top - 32);
+	uint32_t *regs = (uint32_t *)esp_after;
+	nemu_assert(regs[7] == 0x12345678 && regs[3] == top);
+	nemu_assert(error_of[68] == PF_WRITE);
+
+	/* the display of enter $8, $5 copies four outer frame pointers, and
+	 * the EBP of the caller takes 4 more bytes
+	 */
+	static uint32_t outer[4] = { 0x11, 0x22, 0x33, 0x44 };
+	top = stack_top(71, 20);
+	new_esp = top;
+	new_ebp = (uint32_t)(outer + 4);
+	asm volatile("movl %%esp, saved_esp; movl new_esp, %%esp;"
+			"pushl %%ebp; movl new_ebp, %%ebp;"
+			"enter $8, $5;"
+			"movl %%esp, esp_after; movl %%ebp, ebp_after;"
+			"movl 4(%%ebp), %%ebp; movl saved_esp, %%esp"
+			: : : "memory");
+	nemu_assert(ebp_after == top - 8);
+	nemu_assert(esp_after == top - 8 - 20 - 8);
+	uint32_t *frame = (uint32_t *)ebp_after;
+	nemu_assert(frame[0] == (uint32_t)(outer + 4));
+	nemu_assert(frame[-1] == 0x44 && frame[-4] == 0x11);
+	nemu_assert(frame[-5] == ebp_after);
+	nemu_assert(error_of[71] == PF_WRITE);
+
+	nemu_assert(nr_fault == nr + 2);
+}
+
+/* rep movs goes on where its fault stopped it */
+static void test_rep() {
+	int nr = nr_fault;
+	static uint32_t src[3 * NR_PTE];
+	int i;
+	for(i = 0; i < 3 * NR_PTE; i ++) { src[i] = i ^ 0x5a5a; }
+	void *dst = (void *)pg_page(74);
+	uint32_t n = 3 * NR_PTE;
+	const void *s = src;
+	asm volatile("cld; rep movsl" : "+D"(dst), "+S"(s), "+c"(n) : : "memory");
+	nemu_assert(n == 0 && nr_fault == nr + 3);
+	for(i = 0; i < 3 * NR_PTE; i ++) {
+		nemu_assert(frames[74 + i / NR_PTE][i % NR_PTE] == (i ^ 0x5a5a));
+	}
+}
+
+int main() {
+	pg_enable(0);
+	CR0 c0;
+	c0.val = read_cr0();
+	c0.write_protect = 1;
+	write_cr0(c0.val);
+	set_pf_handler();
+
+	test_demand();
+	test_exchange();
+	test_pop();
+	test_stack();
+	test_rep();
+	return 0;
+}
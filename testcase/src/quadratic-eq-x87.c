@@ -0,0 +1,35 @@
+#include "trap.h"
+
+/* quadratic-eq.c with the x87 instead of FLOAT */
+
+static double fsqrt(double x) {
+	double r;
+	asm ("fsqrt" : "=t"(r) : "0"(x));
+	return r;
+}
+
+/* solve 0.5x^2 + 0.5x - 0.5 = 0 */
+
+int main() {
+	double a = 0.5;
+	double b = 0.5;
+	double c = -0.5;
+
+	double dt = b * b - 4 * a * c;
+	double sqrt_dt = fsqrt(dt);
+
+	double x1 = (-b + sqrt_dt) / (2 * a);
+	double x2 = (-b - sqrt_dt) / (2 * a);
+
+	double x1_ans = 0.618;
+	double x2_ans = -1.618;
+
+	nemu_assert(x1 - x1_ans < 1e-3 && x1_ans - x1 < 1e-3);
+	nemu_assert(x2 - x2_ans < 1e-3 && x2_ans - x2 < 1e-3);
+
+	/* the roots are 1/phi and -phi */
+	nemu_assert((long long)(x1 * 1e9) == 618033988LL);
+	nemu_assert((int)(x2 * 1e6) == -1618033);
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "trap.h"
+#include "paging.h"
+
+/* The TLB keeps a translation after its PTE changes, until the entry
+ * is flushed or evicted. Which of two frames a page reads from shows
+ * whether its translation was still cached.
+ */
+
+#define OLD 0x11111111
+#define NEW 0x22222222
+
+static uint32_t old_frame[NR_PTE] align_to_page;
+static uint32_t new_frame[NR_PTE] align_to_page;
+
+/* Map page `n' to the old frame and read it, so that the TLB holds
+ * it, then map it to the new frame behind the TLB's back. The page
+ * must not be in the TLB before.
+ */
+static void load_stale(int n, uint32_t flags) {
+	pg_map(n, old_frame, flags | PG_W | PG_P);
+	nemu_assert(*pg_page(n) == OLD);
+	pg_map(n, new_frame, flags | PG_W | PG_P);
+}
+
+/* with CR4.PGE set, a CR3 write keeps the global pages only */
+static void test_global(void) {
+	load_stale(0, PG_G);
+	load_stale(1, 0);
+	write_cr3(read_cr3());
+	nemu_assert(*pg_page(0) == OLD);
+	nemu_assert(*pg_page(1) == NEW);
+
+	/* invlpg drops a global page */
+	invlpg((void *)pg_page(0));
+	nemu_assert(*pg_page(0) == NEW);
+
+	/* so does clearing CR4.PGE */
+	invlpg((void *)pg_page(0));
+	load_stale(0, PG_G);
+	CR4 c4;
+	c4.val = read_cr4();
+	c4.page_global_enable = 0;
+	write_cr4(c4.val);
+	nemu_assert(*pg_page(0) == NEW);
+
+	/* without CR4.PGE the G bit means nothing */
+	invlpg((void *)pg_page(0));
+	load_stale(0, PG_G);
+	write_cr3(read_cr3());
+	nemu_assert(*pg_page(0) == NEW);
+}
+
+/* Pages 64 apart fall into the same set of the 64-set, 4-way TLB.
+ * Filling a fifth one evicts the first under PLRU, LRU and SRRIP
+ * alike, but not necessarily under `--repl=tlb=random'.
+ */
+static void test_replace(void) {
+	int i;
+	write_cr3(read_cr3());
+	for(i = 0; i < 5; i ++) {
+		load_stale(i * 64, 0);
+	}
+	for(i = 1; i < 5; i ++) {
+		nemu_assert(*pg_page(i * 64) == OLD);
+	}
+	nemu_assert(*pg_page(0) == NEW);
+}
+
+int main() {
+	old_frame[0] = OLD;
+	new_frame[0] = NEW;
+
+	CR4 c4;
+	c4.val = 0;
+	c4.page_global_enable = 1;
+	pg_enable(c4.val);
+
+	test_global();
+	test_replace();
+	return 0;
+}